@@ -11,6 +11,7 @@
 #include "util/sys/threading.hpp"
 #include "util/params.hpp"
 #include "data/job_description.hpp"
+#include "data/formula_progress.hpp"
 #include "data/job_result.hpp"
 #include "data/job_transfer.hpp"
 #include "data/job_state.h"
@@ -144,6 +145,9 @@ private:
 
     std::atomic_bool _has_description = false;
     JobDescription _description;
+    // Non-null while the initial description is still being received:
+    // number of formula literals which are present so far
+    std::shared_ptr<FormulaProgress> _incoming_formula_lits;
     int _desired_revision = 0;
     int _last_solved_revision = -1;
 
@@ -316,6 +320,11 @@ public:
     bool isRevisionSolved(int revision) {return _last_solved_revision >= revision;}
     void setRevisionSolved(int revision) {_last_solved_revision = revision;}
 
+    // The job may be started before its initial description has been received completely.
+    void setIncomingFormula(const std::shared_ptr<FormulaProgress>& numLits) {_incoming_formula_lits = numLits;}
+    const std::shared_ptr<FormulaProgress>& getIncomingFormula() const {return _incoming_formula_lits;}
+    bool isReceivingDescription() const {return (bool)_incoming_formula_lits;}
+
     // toString methods
 
     const char* toStr() const {
@@ -7,6 +7,7 @@
 
 #include "util/assert.hpp"
 #include "util/hashing.hpp"
+#include "clause_kernels.hpp"
 
 namespace Mallob {
     
@@ -39,26 +40,13 @@ namespace Mallob {
         bool operator<(const Clause& other) const {
             if (size != other.size) return size < other.size;
             if (lbd != other.lbd) return lbd < other.lbd;
-            for (int i = 0; i < size; i++) {
-                if (begin[i] != other.begin[i]) return begin[i] < other.begin[i];
-            }
-            return false;
+            return kernels::compare(begin, other.begin, size) < 0;
         }
     };
 
     inline size_t commutativeHash(const int* begin, int size, int which = 3) {
-        static unsigned const int primes [] = 
-            {2038072819, 2038073287, 2038073761, 2038074317,
-            2038072823,	2038073321,	2038073767, 2038074319,
-            2038072847,	2038073341,	2038073789,	2038074329,
-            2038074751,	2038075231,	2038075751,	2038076267};
-        
-        size_t res = 1;
-        for (auto it = begin; it != begin+size; it++) {
-            int lit = *it;
-            res ^= lit * primes[abs((lit^which) & 15)];
-        }
-        return res;
+        // 1 ^ XOR over all literals of lit * primes[(lit^which) & 15]
+        return kernels::commutativeHash(begin, size, which);
     }
 
     /*
@@ -81,6 +69,13 @@ namespace Mallob {
         return res;
     }
 
+    // Order-independent 64-bit fingerprint of a clause's literals
+    inline uint64_t fingerprint(const int* begin, int size) {
+        uint64_t res = robin_hood::hash_int(size);
+        for (int i = 0; i < size; i++) res += robin_hood::hash_int(begin[i]);
+        return res;
+    }
+
     struct NonCommutativeClauseHasher {
         std::size_t inline operator()(const Clause& cls) const {
             return nonCommutativeHash(cls.begin, cls.size);
@@ -116,10 +111,7 @@ namespace Mallob {
         bool operator()(const Clause& a, const Clause& b) const {
             if (a.size != b.size) return false; // only clauses of same size are equal
             // exact content comparison otherwise
-            for (size_t i = 0; i < a.size; i++) {
-                if (a.begin[i] != b.begin[i]) return false;
-            }
-            return true;
+            return kernels::equals(a.begin, b.begin, a.size);
         }
     };
 }
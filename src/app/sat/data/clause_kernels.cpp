@@ -0,0 +1,141 @@
+#include <immintrin.h>
+
+#include "clause_kernels.hpp"
+
+namespace Mallob {
+namespace kernels {
+
+__attribute__((target("avx2")))
+size_t commutativeHashAvx2(const int* begin, int size, int which) {
+    const __m256i primesLow = _mm256_loadu_si256((const __m256i*) HASH_PRIMES);
+    const __m256i primesHigh = _mm256_loadu_si256((const __m256i*) (HASH_PRIMES+8));
+    const __m256i whichVec = _mm256_set1_epi32(which);
+    const __m256i fifteen = _mm256_set1_epi32(15);
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i+8 <= size; i += 8) {
+        __m256i lits = _mm256_loadu_si256((const __m256i*) (begin+i));
+        __m256i idx = _mm256_and_si256(_mm256_xor_si256(lits, whichVec), fifteen);
+        // Select primes via two 8-way permutations, blended by bit 3 of the index
+        __m256i low = _mm256_permutevar8x32_epi32(primesLow, idx);
+        __m256i high = _mm256_permutevar8x32_epi32(primesHigh, idx);
+        __m256i useHigh = _mm256_slli_epi32(idx, 28); // bit 3 -> sign bit
+        __m256i primes = _mm256_blendv_epi8(low, high, _mm256_srai_epi32(useHigh, 31));
+        acc = _mm256_xor_si256(acc, _mm256_mullo_epi32(lits, primes));
+    }
+    __m128i acc4 = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc4 = _mm_xor_si128(acc4, _mm_shuffle_epi32(acc4, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc4 = _mm_xor_si128(acc4, _mm_shuffle_epi32(acc4, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t res = (uint32_t) _mm_cvtsi128_si32(acc4);
+    res ^= (uint32_t) (commutativeHashScalar(begin+i, size-i, which) ^ 1);
+    return 1 ^ (size_t) res;
+}
+
+__attribute__((target("avx2")))
+bool equalsAvx2(const int* left, const int* right, int size) {
+    int i = 0;
+    for (; i+8 <= size; i += 8) {
+        __m256i l = _mm256_loadu_si256((const __m256i*) (left+i));
+        __m256i r = _mm256_loadu_si256((const __m256i*) (right+i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(l, r)) != -1) return false;
+    }
+    return equalsScalar(left+i, right+i, size-i);
+}
+
+__attribute__((target("avx2")))
+int compareAvx2(const int* left, const int* right, int size) {
+    int i = 0;
+    for (; i+8 <= size; i += 8) {
+        __m256i l = _mm256_loadu_si256((const __m256i*) (left+i));
+        __m256i r = _mm256_loadu_si256((const __m256i*) (right+i));
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi32(l, r));
+        if (mask != 0xffffffffu) {
+            // Position of the first differing literal
+            int pos = i + __builtin_ctz(~mask) / 4;
+            return left[pos] < right[pos] ? -1 : 1;
+        }
+    }
+    return compareScalar(left+i, right+i, size-i);
+}
+
+__attribute__((target("sse4.2")))
+size_t commutativeHashSse42(const int* begin, int size, int which) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i+4 <= size; i += 4) {
+        __m128i lits = _mm_loadu_si128((const __m128i*) (begin+i));
+        __m128i primes = _mm_set_epi32(
+            HASH_PRIMES[(begin[i+3]^which) & 15], HASH_PRIMES[(begin[i+2]^which) & 15], 
+            HASH_PRIMES[(begin[i+1]^which) & 15], HASH_PRIMES[(begin[i]^which) & 15]
+        );
+        acc = _mm_xor_si128(acc, _mm_mullo_epi32(lits, primes));
+    }
+    acc = _mm_xor_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_xor_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t res = (uint32_t) _mm_cvtsi128_si32(acc);
+    res ^= (uint32_t) (commutativeHashScalar(begin+i, size-i, which) ^ 1);
+    return 1 ^ (size_t) res;
+}
+
+__attribute__((target("sse4.2")))
+bool equalsSse42(const int* left, const int* right, int size) {
+    int i = 0;
+    for (; i+4 <= size; i += 4) {
+        __m128i l = _mm_loadu_si128((const __m128i*) (left+i));
+        __m128i r = _mm_loadu_si128((const __m128i*) (right+i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(l, r)) != 0xffff) return false;
+    }
+    return equalsScalar(left+i, right+i, size-i);
+}
+
+__attribute__((target("sse4.2")))
+int compareSse42(const int* left, const int* right, int size) {
+    int i = 0;
+    for (; i+4 <= size; i += 4) {
+        __m128i l = _mm_loadu_si128((const __m128i*) (left+i));
+        __m128i r = _mm_loadu_si128((const __m128i*) (right+i));
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi32(l, r));
+        if (mask != 0xffffu) {
+            int pos = i + __builtin_ctz(~mask) / 4;
+            return left[pos] < right[pos] ? -1 : 1;
+        }
+    }
+    return compareScalar(left+i, right+i, size-i);
+}
+
+// Runtime dispatch, resolved once at static initialization
+
+enum InstructionSet {SCALAR, SSE42, AVX2};
+static InstructionSet detectInstructionSet() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SSE42;
+    return SCALAR;
+}
+static const InstructionSet instructionSet = detectInstructionSet();
+
+static size_t (* const hashFunc)(const int*, int, int) = 
+    instructionSet == AVX2 ? commutativeHashAvx2 : 
+    instructionSet == SSE42 ? commutativeHashSse42 : commutativeHashScalar;
+static bool (* const equalsFunc)(const int*, const int*, int) = 
+    instructionSet == AVX2 ? equalsAvx2 : 
+    instructionSet == SSE42 ? equalsSse42 : equalsScalar;
+static int (* const compareFunc)(const int*, const int*, int) = 
+    instructionSet == AVX2 ? compareAvx2 : 
+    instructionSet == SSE42 ? compareSse42 : compareScalar;
+
+size_t commutativeHashVectorized(const int* begin, int size, int which) {
+    return hashFunc(begin, size, which);
+}
+bool equalsVectorized(const int* left, const int* right, int size) {
+    return equalsFunc(left, right, size);
+}
+int compareVectorized(const int* left, const int* right, int size) {
+    return compareFunc(left, right, size);
+}
+const char* getSelectedInstructionSet() {
+    return instructionSet == AVX2 ? "avx2" : (instructionSet == SSE42 ? "sse4.2" : "scalar");
+}
+
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Kernels for hashing, equality checks and lexicographic comparison of
+fixed-length clauses (sequences of int literals). For clauses of at
+least KERNEL_MIN_SIZE literals, an AVX2 or SSE4.2 implementation is
+used if the executing CPU supports it (checked once at runtime);
+shorter clauses and other CPUs use the scalar loops.
+All variants return exactly the same results.
+*/
+namespace Mallob {
+namespace kernels {
+
+    constexpr int KERNEL_MIN_SIZE = 8;
+
+    static const uint32_t HASH_PRIMES[16] = 
+        {2038072819, 2038073287, 2038073761, 2038074317,
+        2038072823,	2038073321,	2038073767, 2038074319,
+        2038072847,	2038073341,	2038073789,	2038074329,
+        2038074751,	2038075231,	2038075751,	2038076267};
+
+    // Order-independent hash: 1 XOR (XOR over all i of lit_i * prime[(lit_i^which) & 15])
+    // (32-bit products)
+    inline size_t commutativeHashScalar(const int* begin, int size, int which) {
+        uint32_t res = 0;
+        for (int i = 0; i < size; i++) {
+            int lit = begin[i];
+            res ^= ((uint32_t) lit) * HASH_PRIMES[(lit^which) & 15];
+        }
+        return 1 ^ (size_t) res;
+    }
+    inline bool equalsScalar(const int* left, const int* right, int size) {
+        for (int i = 0; i < size; i++) {
+            if (left[i] != right[i]) return false;
+        }
+        return true;
+    }
+    // Returns -1, 0, or 1 as the first differing literal of left is smaller than, 
+    // equal to (no difference), or greater than the according literal of right.
+    inline int compareScalar(const int* left, const int* right, int size) {
+        for (int i = 0; i < size; i++) {
+            if (left[i] != right[i]) return left[i] < right[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // Vectorized implementations, selected according to the CPU's capabilities
+    size_t commutativeHashVectorized(const int* begin, int size, int which);
+    bool equalsVectorized(const int* left, const int* right, int size);
+    int compareVectorized(const int* left, const int* right, int size);
+    // "avx2", "sse4.2", or "scalar"
+    const char* getSelectedInstructionSet();
+
+    inline size_t commutativeHash(const int* begin, int size, int which) {
+        if (size < KERNEL_MIN_SIZE) return commutativeHashScalar(begin, size, which);
+        return commutativeHashVectorized(begin, size, which);
+    }
+    inline bool equals(const int* left, const int* right, int size) {
+        if (size < KERNEL_MIN_SIZE) return equalsScalar(left, right, size);
+        return equalsVectorized(left, right, size);
+    }
+    inline int compare(const int* left, const int* right, int size) {
+        if (size < KERNEL_MIN_SIZE) return compareScalar(left, right, size);
+        return compareVectorized(left, right, size);
+    }
+}
+}
@@ -0,0 +1,374 @@
+
+#include "formula_preprocessor.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "app/sat/data/clause_kernels.hpp"
+#include "util/hashing.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+
+bool FormulaPreprocessor::preprocess(JobDescription& desc) {
+
+    float time = Timer::elapsedSeconds();
+    int rev = desc.getRevision();
+    std::vector<int> assumptions(desc.getAssumptionsPayload(rev),
+        desc.getAssumptionsPayload(rev) + desc.getAssumptionsSize(rev));
+    load(desc.getFormulaPayload(rev), desc.getFormulaPayloadSize(rev), assumptions.data(), assumptions.size());
+
+    propagate();
+    if (!_stats.unsat) removeDuplicates();
+    if (!_stats.unsat) subsume();
+    if (!_stats.unsat) eliminate();
+
+    _stats.numOutputClauses = _stats.numInputClauses;
+    bool changed = _stats.unsat || _stats.numFixedVars > 0 || _stats.numEliminatedVars > 0
+        || _stats.numRemovedDuplicates > 0 || _stats.numRemovedTautologies > 0 || _stats.numRemovedSubsumed > 0;
+    if (changed) {
+        auto lits = getSimplifiedFormula();
+        _stats.numOutputClauses = std::count(lits.begin(), lits.end(), 0);
+        desc.setChecksum(Checksum());
+        desc.beginInitialization(rev);
+        desc.reserveSize(sizeof(int) * (lits.size() + assumptions.size()));
+        desc.addLiterals(lits.data(), lits.size());
+        desc.addAssumptions(assumptions.data(), assumptions.size());
+        desc.endInitialization();
+    }
+
+    // Only the reconstruction stack is needed from now on
+    std::vector<int>().swap(_lits);
+    std::vector<Clause>().swap(_clauses);
+    std::vector<std::vector<int>>().swap(_occs);
+    std::vector<int8_t>().swap(_values);
+    std::vector<bool>().swap(_frozen);
+    std::vector<bool>().swap(_eliminated);
+    std::vector<int8_t>().swap(_marks);
+    std::vector<int>().swap(_units);
+    _reconstruction_stack.shrink_to_fit();
+
+    time = Timer::elapsedSeconds() - time;
+    LOG(V3_VERB, "Preprocessed #%i in %.3fs: %lu -> %lu clauses, %i fixed, %i eliminated, %lu duplicates, %lu tautologies, %lu subsumed%s\n",
+        desc.getId(), time, _stats.numInputClauses, _stats.numOutputClauses, _stats.numFixedVars, _stats.numEliminatedVars,
+        _stats.numRemovedDuplicates, _stats.numRemovedTautologies, _stats.numRemovedSubsumed, _stats.unsat ? " (UNSAT)" : "");
+    return changed;
+}
+
+void FormulaPreprocessor::reconstructModel(std::vector<int>& model) const {
+
+    // Unknown variables default to false
+    if (model.size() < (size_t)_num_vars+1) model.resize(_num_vars+1, 0);
+    model[0] = 0;
+    for (size_t x = 1; x < model.size(); x++) if (model[x] == 0) model[x] = -x;
+
+    // Undo eliminations and units in reverse order
+    long pos = _reconstruction_stack.size();
+    while (pos > 0) {
+        int numOthers = _reconstruction_stack[pos-1];
+        int witness = _reconstruction_stack[pos-2];
+        const int* others = _reconstruction_stack.data() + pos-2-numOthers;
+        bool satisfied = false;
+        for (int i = 0; i < numOthers; i++) {
+            if (model[std::abs(others[i])] == others[i]) {
+                satisfied = true;
+                break;
+            }
+        }
+        if (!satisfied) model[std::abs(witness)] = witness;
+        pos -= numOthers+2;
+    }
+}
+
+void FormulaPreprocessor::load(const int* lits, size_t numLits, const int* assumptions, size_t numAssumptions) {
+
+    for (size_t i = 0; i < numLits; i++) _num_vars = std::max(_num_vars, std::abs(lits[i]));
+    for (size_t i = 0; i < numAssumptions; i++) _num_vars = std::max(_num_vars, std::abs(assumptions[i]));
+    _occs.resize(2*(size_t)_num_vars+2);
+    _values.resize(_num_vars+1);
+    _frozen.resize(_num_vars+1);
+    _eliminated.resize(_num_vars+1);
+    _marks.resize(2*(size_t)_num_vars+2);
+    _lits.reserve(numLits);
+    for (size_t i = 0; i < numAssumptions; i++) _frozen[std::abs(assumptions[i])] = true;
+
+    std::vector<int> clause;
+    for (size_t i = 0; i < numLits; i++) {
+        if (lits[i] != 0) {
+            clause.push_back(lits[i]);
+            continue;
+        }
+        _stats.numInputClauses++;
+        // Sort by variable, remove duplicate literals, detect tautologies
+        std::sort(clause.begin(), clause.end(), [](int l, int r) {
+            return std::abs(l) < std::abs(r) || (std::abs(l) == std::abs(r) && l < r);
+        });
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        bool tautology = false;
+        for (size_t j = 1; j < clause.size(); j++) {
+            if (clause[j] == -clause[j-1]) tautology = true;
+        }
+        if (tautology) _stats.numRemovedTautologies++;
+        else addClause(clause.data(), clause.size());
+        clause.clear();
+    }
+}
+
+void FormulaPreprocessor::addClause(const int* lits, int size) {
+    if (size == 0) {
+        _stats.unsat = true;
+        return;
+    }
+    if (size == 1) {
+        assign(lits[0]);
+        return;
+    }
+    int cid = _clauses.size();
+    _clauses.push_back(Clause{_lits.size(), size, false});
+    _lits.insert(_lits.end(), lits, lits+size);
+    for (int i = 0; i < size; i++) _occs[litIdx(lits[i])].push_back(cid);
+}
+
+void FormulaPreprocessor::removeClause(int cid) {
+    _clauses[cid].removed = true;
+}
+
+void FormulaPreprocessor::assign(int lit) {
+    if (value(lit) > 0) return;
+    if (value(lit) < 0) {
+        _stats.unsat = true;
+        return;
+    }
+    _values[std::abs(lit)] = lit > 0 ? 1 : -1;
+    _units.push_back(lit);
+    _stats.numFixedVars++;
+    _reconstruction_stack.push_back(lit);
+    _reconstruction_stack.push_back(0);
+}
+
+void FormulaPreprocessor::propagate() {
+
+    while (_propagated_units < _units.size() && !_stats.unsat) {
+        int lit = _units[_propagated_units++];
+
+        // Clauses containing the literal are satisfied
+        for (int cid : _occs[litIdx(lit)]) removeClause(cid);
+
+        // Clauses containing the negated literal are strengthened
+        for (int cid : _occs[litIdx(-lit)]) {
+            auto& c = _clauses[cid];
+            if (c.removed) continue;
+            int* cLits = _lits.data() + c.offset;
+            for (int i = 0; i < c.size; i++) {
+                if (cLits[i] == -lit) {
+                    cLits[i] = cLits[c.size-1];
+                    c.size--;
+                    break;
+                }
+            }
+            if (c.size == 1) {
+                removeClause(cid);
+                assign(cLits[0]);
+            }
+        }
+        std::vector<int>().swap(_occs[litIdx(lit)]);
+        std::vector<int>().swap(_occs[litIdx(-lit)]);
+    }
+}
+
+void FormulaPreprocessor::removeDuplicates() {
+
+    // Strengthening may have reordered literals: sort each clause by variable again
+    for (auto& c : _clauses) {
+        if (c.removed) continue;
+        int* cLits = _lits.data() + c.offset;
+        std::sort(cLits, cLits+c.size, [](int l, int r) {
+            return std::abs(l) < std::abs(r) || (std::abs(l) == std::abs(r) && l < r);
+        });
+    }
+
+    auto hash = [&](int cid) {
+        const auto& c = _clauses[cid];
+        return Mallob::kernels::commutativeHash(begin(c), c.size, 3);
+    };
+    auto equals = [&](int left, int right) {
+        const auto& l = _clauses[left];
+        const auto& r = _clauses[right];
+        return l.size == r.size && Mallob::kernels::equals(begin(l), begin(r), l.size);
+    };
+    robin_hood::unordered_set<int, decltype(hash), decltype(equals)> seen(0, hash, equals);
+    for (size_t cid = 0; cid < _clauses.size(); cid++) {
+        if (_clauses[cid].removed) continue;
+        if (!seen.insert(cid).second) {
+            removeClause(cid);
+            _stats.numRemovedDuplicates++;
+        }
+    }
+}
+
+void FormulaPreprocessor::subsume() {
+
+    // Try each clause as a subsuming clause, shortest clauses first
+    std::vector<int> order;
+    for (size_t cid = 0; cid < _clauses.size(); cid++) {
+        const auto& c = _clauses[cid];
+        if (!c.removed && c.size <= MAX_SUBSUMING_CLAUSE_SIZE) order.push_back(cid);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int l, int r) {
+        return _clauses[l].size < _clauses[r].size;
+    });
+
+    size_t steps = 0;
+    for (int cid : order) {
+        const auto& c = _clauses[cid];
+        if (c.removed) continue;
+        const int* cLits = begin(c);
+
+        // Candidates must contain the clause's least frequent literal
+        int minLit = cLits[0];
+        for (int i = 1; i < c.size; i++) {
+            if (occs(cLits[i]).size() < occs(minLit).size()) minLit = cLits[i];
+        }
+        for (int i = 0; i < c.size; i++) _marks[litIdx(cLits[i])] = 1;
+        for (int other : occs(minLit)) {
+            const auto& d = _clauses[other];
+            if (other == cid || d.removed || d.size < c.size) continue;
+            const int* dLits = begin(d);
+            int numMarked = 0;
+            for (int i = 0; i < d.size; i++) numMarked += _marks[litIdx(dLits[i])];
+            steps += d.size;
+            if (numMarked == c.size) {
+                removeClause(other);
+                _stats.numRemovedSubsumed++;
+            }
+        }
+        for (int i = 0; i < c.size; i++) _marks[litIdx(cLits[i])] = 0;
+        if (steps > SUBSUMPTION_STEP_LIMIT) break;
+    }
+}
+
+void FormulaPreprocessor::eliminate() {
+
+    // Cheapest candidates first
+    std::vector<std::pair<size_t, int>> candidates;
+    for (int var = 1; var <= _num_vars; var++) {
+        if (_frozen[var] || _values[var] != 0) continue;
+        size_t numPos = occs(var).size(), numNeg = occs(-var).size();
+        if (numPos + numNeg == 0) continue;
+        if (numPos > ELIMINATION_OCCURRENCE_LIMIT || numNeg > ELIMINATION_OCCURRENCE_LIMIT) continue;
+        candidates.emplace_back(numPos * numNeg, var);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto [cost, var] : candidates) {
+        if (_values[var] != 0) continue;
+        if (tryEliminate(var)) {
+            _stats.numEliminatedVars++;
+            propagate();
+            if (_stats.unsat) return;
+        }
+    }
+}
+
+bool FormulaPreprocessor::tryEliminate(int var) {
+
+    std::vector<int> pos = occs(var), neg = occs(-var);
+    if (pos.size() > ELIMINATION_OCCURRENCE_LIMIT || neg.size() > ELIMINATION_OCCURRENCE_LIMIT) return false;
+
+    // Compute all non-tautological resolvents; give up if there are
+    // more resolvents than clauses or if a resolvent is too long
+    std::vector<int> resolventLits, resolventSizes;
+    for (int p : pos) {
+        const auto& pc = _clauses[p];
+        const int* pLits = begin(pc);
+        for (int i = 0; i < pc.size; i++) if (pLits[i] != var) _marks[litIdx(pLits[i])] = 1;
+
+        bool abort = false;
+        for (int n : neg) {
+            const auto& nc = _clauses[n];
+            const int* nLits = begin(nc);
+            size_t resolventBegin = resolventLits.size();
+            for (int i = 0; i < pc.size; i++) if (pLits[i] != var) resolventLits.push_back(pLits[i]);
+            bool tautology = false;
+            for (int i = 0; i < nc.size; i++) {
+                int lit = nLits[i];
+                if (lit == -var || _marks[litIdx(lit)]) continue;
+                if (_marks[litIdx(-lit)]) {
+                    tautology = true;
+                    break;
+                }
+                resolventLits.push_back(lit);
+            }
+            int size = resolventLits.size() - resolventBegin;
+            if (tautology) {
+                resolventLits.resize(resolventBegin);
+                continue;
+            }
+            resolventSizes.push_back(size);
+            if (size > ELIMINATION_RESOLVENT_SIZE_LIMIT || resolventSizes.size() > pos.size()+neg.size()) {
+                abort = true;
+                break;
+            }
+        }
+
+        for (int i = 0; i < pc.size; i++) _marks[litIdx(pLits[i])] = 0;
+        if (abort) return false;
+    }
+
+    // Store the clauses of the smaller side and a default value for the variable
+    bool storePos = pos.size() <= neg.size();
+    for (int cid : storePos ? pos : neg) pushReconstruction(storePos ? var : -var, _clauses[cid]);
+    _reconstruction_stack.push_back(storePos ? -var : var);
+    _reconstruction_stack.push_back(0);
+
+    for (int cid : pos) removeClause(cid);
+    for (int cid : neg) removeClause(cid);
+    std::vector<int>().swap(_occs[litIdx(var)]);
+    std::vector<int>().swap(_occs[litIdx(-var)]);
+    _eliminated[var] = true;
+
+    size_t offset = 0;
+    for (int size : resolventSizes) {
+        addClause(resolventLits.data()+offset, size);
+        offset += size;
+    }
+    return true;
+}
+
+std::vector<int> FormulaPreprocessor::getSimplifiedFormula() const {
+
+    std::vector<int> lits;
+    if (_stats.unsat) {
+        // Trivially unsatisfiable formula
+        lits = {1, 0, -1, 0};
+        return lits;
+    }
+    for (const auto& c : _clauses) {
+        if (c.removed) continue;
+        lits.insert(lits.end(), begin(c), begin(c)+c.size);
+        lits.push_back(0);
+    }
+    // Units on assumption variables must remain visible to the solvers
+    for (int var = 1; var <= _num_vars; var++) {
+        if (_frozen[var] && _values[var] != 0) {
+            lits.push_back(_values[var] * var);
+            lits.push_back(0);
+        }
+    }
+    return lits;
+}
+
+std::vector<int>& FormulaPreprocessor::occs(int lit) {
+    // Clean up occurrences of removed clauses lazily
+    auto& occs = _occs[litIdx(lit)];
+    occs.erase(std::remove_if(occs.begin(), occs.end(), [&](int cid) {
+        return _clauses[cid].removed;
+    }), occs.end());
+    return occs;
+}
+
+void FormulaPreprocessor::pushReconstruction(int witness, const Clause& clause) {
+    const int* cLits = begin(clause);
+    for (int i = 0; i < clause.size; i++) if (cLits[i] != witness) _reconstruction_stack.push_back(cLits[i]);
+    _reconstruction_stack.push_back(witness);
+    _reconstruction_stack.push_back(clause.size-1);
+}
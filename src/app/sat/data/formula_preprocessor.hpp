@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "data/job_description.hpp"
+
+/*
+Simplifies a non-incremental SAT formula before it is distributed to the
+workers: unit propagation, removal of duplicate literals, tautologies, and
+duplicate or subsumed clauses, and bounded variable elimination (BVE).
+Variables keep their original indices, and variables occurring in
+assumptions are neither eliminated nor propagated away. Each clause which
+is removed by elimination or by a unit is pushed onto a reconstruction
+stack, from which a model of the simplified formula is extended to a model
+of the original formula (reconstructModel).
+*/
+class FormulaPreprocessor {
+
+public:
+    static constexpr int MAX_SUBSUMING_CLAUSE_SIZE = 16;
+    static constexpr size_t SUBSUMPTION_STEP_LIMIT = 100'000'000;
+    static constexpr int ELIMINATION_OCCURRENCE_LIMIT = 16; // per polarity
+    static constexpr int ELIMINATION_RESOLVENT_SIZE_LIMIT = 20;
+
+    struct Statistics {
+        size_t numInputClauses = 0;
+        size_t numOutputClauses = 0;
+        int numFixedVars = 0;
+        int numEliminatedVars = 0;
+        size_t numRemovedDuplicates = 0;
+        size_t numRemovedTautologies = 0;
+        size_t numRemovedSubsumed = 0;
+        bool unsat = false;
+    };
+
+private:
+    struct Clause {
+        size_t offset;
+        int size;
+        bool removed;
+    };
+    std::vector<int> _lits; // literals of all clauses, back to back
+    std::vector<Clause> _clauses;
+    std::vector<std::vector<int>> _occs; // clause IDs per literal
+    std::vector<int8_t> _values; // per variable: 1 true, -1 false, 0 unassigned
+    std::vector<bool> _frozen; // per variable
+    std::vector<bool> _eliminated; // per variable
+    std::vector<int8_t> _marks; // per literal
+    std::vector<int> _units;
+    size_t _propagated_units = 0;
+
+    int _num_vars = 0;
+    Statistics _stats;
+
+    // Entries: [other literals...] [witness literal] [#other literals]
+    std::vector<int> _reconstruction_stack;
+
+public:
+    // Simplifies the current revision of the description in place.
+    // Returns false (and leaves the description untouched) if nothing changed.
+    bool preprocess(JobDescription& desc);
+
+    // Turns a model of the simplified formula (model[x] = x or -x)
+    // into a model of the original formula.
+    void reconstructModel(std::vector<int>& model) const;
+
+    const Statistics& getStatistics() const {return _stats;}
+
+private:
+    void load(const int* lits, size_t numLits, const int* assumptions, size_t numAssumptions);
+    void addClause(const int* lits, int size);
+    void removeClause(int cid);
+    void assign(int lit);
+    void propagate();
+    void removeDuplicates();
+    void subsume();
+    void eliminate();
+    bool tryEliminate(int var);
+    std::vector<int> getSimplifiedFormula() const;
+
+    std::vector<int>& occs(int lit);
+    void pushReconstruction(int witness, const Clause& clause);
+
+    inline static size_t litIdx(int lit) {return 2*(size_t)std::abs(lit) + (lit < 0);}
+    inline int value(int lit) const {
+        int8_t val = _values[std::abs(lit)];
+        return lit > 0 ? val : -val;
+    }
+    inline const int* begin(const Clause& c) const {return _lits.data() + c.offset;}
+};
@@ -115,17 +115,11 @@ struct ProducedLargeClause {
 
     bool operator<(const ProducedLargeClause& other) const {
         if (size != other.size) return size < other.size;
-        for (uint8_t i = 0; i < size; i++) {
-            if (data[i] != other.data[i]) return data[i] < other.data[i];
-        }
-        return false;
+        return Mallob::kernels::compare(data, other.data, size) < 0;
     }
     bool operator==(const ProducedLargeClause& other) const {
         if (size != other.size) return false;
-        for (uint8_t i = 0; i < size; i++) {
-            if (data[i] != other.data[i]) return false;
-        }
-        return true;
+        return Mallob::kernels::equals(data, other.data, size);
     }
     bool operator!=(const ProducedLargeClause& other) const {
         return !(*this == other);
@@ -269,12 +263,7 @@ struct ProducedClauseEquals {
     bool inline operator()(const T& a, const T& b) const {
         if (prod_cls::size(a) != prod_cls::size(b)) return false; // only clauses of same size are equal
         // exact content comparison otherwise
-        auto dataA = prod_cls::data(a);
-        auto dataB = prod_cls::data(b);
-        for (size_t i = 0; i < prod_cls::size(a); i++) {
-            if (dataA[i] != dataB[i]) return false;
-        }
-        return true;
+        return Mallob::kernels::equals(prod_cls::data(a), prod_cls::data(b), prod_cls::size(a));
     }
 };
 
@@ -293,6 +282,9 @@ struct ProducedClauseEqualsCommutative {
         auto dataA = prod_cls::data(a);
         auto dataB = prod_cls::data(b);
 
+        // Fast path for identically ordered (e.g., sorted) clauses
+        if (Mallob::kernels::equals(dataA, dataB, size)) return true;
+
         // Invariant: All literals of B to the left of this index are already matched
         size_t idxB = 0; 
 
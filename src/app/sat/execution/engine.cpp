@@ -159,11 +159,12 @@ std::shared_ptr<PortfolioSolverInterface> SatEngine::createSolver(const SolverSe
 	return solver;
 }
 
-void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, size_t aSize, const int* aLits, bool lastRevisionForNow) {
+void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, size_t aSize, const int* aLits, bool lastRevisionForNow, 
+		FormulaProgress* incomingFormula) {
 	
 	LOGGER(_logger, V4_VVER, "Import rev. %i: %i lits, %i assumptions\n", revision, fSize, aSize);
 	assert(_revision+1 == revision);
-	_revision_data.push_back(RevisionData{fSize, fLits, aSize, aLits});
+	_revision_data.push_back(RevisionData{fSize, fLits, aSize, aLits, incomingFormula});
 	_sharing_manager->setRevision(revision);
 	
 	for (size_t i = 0; i < _num_solvers; i++) {
@@ -172,6 +173,9 @@ void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, siz
 			_solver_threads.emplace_back(new SolverThread(
 				_params, _config, _solver_interfaces[i], fSize, fLits, aSize, aLits, i
 			));
+			_solver_threads.back()->setResultCallback(_result_callback);
+			// The formula may still be arriving while the solver reads it
+			_solver_threads.back()->setIncomingFormula(incomingFormula);
 		} else {
 			if (_solver_interfaces[i]->getSolverSetup().doIncrementalSolving) {
 				// True incremental SAT solving
@@ -204,6 +208,8 @@ void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, siz
 					_revision_data[0].aSize, _revision_data[0].aLits, 
 					i
 				));
+				_solver_threads[i]->setIncomingFormula(_revision_data[0].incomingFormula);
+				_solver_threads[i]->setResultCallback(_result_callback);
 				// Load entire formula 
 				for (int importedRevision = 1; importedRevision <= revision; importedRevision++) {
 					auto data = _revision_data[importedRevision];
@@ -262,10 +268,10 @@ int SatEngine::solveLoop() {
     return -1; // no result yet
 }
 
-int SatEngine::prepareSharing(int* begin, int maxSize) {
+int SatEngine::prepareSharing(int* begin, int maxSize, int capacity) {
 	if (isCleanedUp()) return sizeof(size_t) / sizeof(int); // checksum, nothing else
 	LOGGER(_logger, V5_DEBG, "collecting clauses on this node\n");
-	int size = _sharing_manager->prepareSharing(begin, maxSize);
+	int size = _sharing_manager->prepareSharing(begin, maxSize, capacity);
 	return size;
 }
 
@@ -36,6 +36,7 @@ private:
 		const int* fLits;
 		size_t aSize;
 		const int* aLits;
+		FormulaProgress* incomingFormula; // non-null while still arriving
 	};
 	std::vector<RevisionData> _revision_data;
 	
@@ -44,6 +45,7 @@ private:
 	int _revision = -1;
 	JobResult _result;
 	std::atomic_bool _cleaned_up = false;
+	std::function<void()> _result_callback;
 
 public:
 
@@ -52,13 +54,16 @@ public:
 
 	void solve();
     void appendRevision(int revision, size_t fSize, const int* fLits, size_t aSize, const int* aLits, 
-		bool lastRevisionForNow = true);
+		bool lastRevisionForNow = true, FormulaProgress* incomingFormula = nullptr);
 
 	bool isFullyInitialized();
+	// The callback is invoked by a solver thread whenever it found a result,
+	// which solveLoop() can then report
+	void setResultCallback(const std::function<void()>& cb) {_result_callback = cb;}
     int solveLoop();
 	JobResult& getResult() {return _result;}
 
-    int prepareSharing(int* begin, int maxSize);
+    int prepareSharing(int* begin, int maxSize, int capacity);
 	int filterSharing(int* begin, int size, int* filterOut);
 	void digestSharingWithFilter(int* begin, int size, const int* filter);
 	void digestSharingWithoutFilter(int* begin, int size);
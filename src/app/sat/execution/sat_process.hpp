@@ -32,7 +32,7 @@ private:
     std::string _shmem_id;
     SatSharedMemory* _hsm;
     int* _export_buffer;
-    int* _import_buffer;
+    int* _import_buffers[SatSharedMemory::NUM_IMPORT_SLOTS];
     int* _filter_buffer;
     int* _returned_buffer;
 
@@ -40,6 +40,12 @@ private:
     int _desired_revision;
     Checksum* _checksum;
 
+    // Max. time to wait for an instruction before checking the solvers' state
+    // (solver threads which find a result end the wait immediately)
+    static constexpr int IDLE_WAIT_MICROS = 10'000;
+    // Last observed epoch of the parent's wake-up signal
+    uint32_t _wakeup_epoch = 0;
+
 public:
     SatProcess(const Parameters& params, const SatProcessConfig& config, Logger& log) 
         : _params(params), _config(config), _log(log), _engine(_params, _config, _log) {
@@ -50,10 +56,15 @@ public:
         _hsm = (SatSharedMemory*) accessMemory(_shmem_id, sizeof(SatSharedMemory));
         
         _checksum = params.useChecksums() ? new Checksum() : nullptr;
+
+        // Report a found result without waiting for the next instruction
+        SatSharedMemory* hsm = _hsm;
+        _engine.setResultCallback([hsm]() {hsm->childWakeup.notify();});
     }
 
     void run() {
         // Wait until everything is prepared for the solver to begin
+        _wakeup_epoch = _hsm->childWakeup.getEpoch();
         while (!_hsm->doBegin) doSleep();
         
         // Terminate directly?
@@ -65,7 +76,10 @@ public:
             int maxExportBufferSize = _hsm->exportBufferAllocatedSize * sizeof(int);
             _export_buffer = (int*) accessMemory(_shmem_id + ".clauseexport", maxExportBufferSize);
             int maxImportBufferSize = _hsm->importBufferMaxSize * sizeof(int);
-            _import_buffer = (int*) accessMemory(_shmem_id + ".clauseimport", maxImportBufferSize);
+            for (int slot = 0; slot < SatSharedMemory::NUM_IMPORT_SLOTS; slot++) {
+                _import_buffers[slot] = (int*) accessMemory(_shmem_id + ".clauseimport." 
+                    + std::to_string(slot), maxImportBufferSize);
+            }
             int maxFilterSize = _hsm->importBufferMaxSize/8 + 1;
             _filter_buffer = (int*) accessMemory(_shmem_id + ".clausefilter", maxFilterSize);
             _returned_buffer = (int*) accessMemory(_shmem_id + ".returnedclauses", maxImportBufferSize);
@@ -74,10 +88,11 @@ public:
         // Import first revision
         _desired_revision = _config.firstrev;
         {
-            int* fPtr = (int*) accessMemory(_shmem_id + ".formulae.0", sizeof(int) * _hsm->fSize);
+            const int* fPtr = accessFormula(0, _hsm->fSize);
             int* aPtr = (int*) accessMemory(_shmem_id + ".assumptions.0", sizeof(int) * _hsm->aSize);
+            // The parent may still be writing the formula while the solvers read it
             _engine.appendRevision(0, _hsm->fSize, fPtr, _hsm->aSize, aPtr, 
-                /*finalRevisionForNow=*/_desired_revision == 0);
+                /*finalRevisionForNow=*/_desired_revision == 0, &_hsm->fAvailable);
             updateChecksum(fPtr, _hsm->fSize);
         }
         _last_imported_revision = 0;
@@ -144,7 +159,8 @@ public:
                 LOGGER(_log, V5_DEBG, "DO export clauses\n");
                 // Collect local clauses, put into shared memory
                 _hsm->exportChecksum = Checksum();
-                _hsm->exportBufferTrueSize = _engine.prepareSharing(_export_buffer, _hsm->exportBufferMaxSize);
+                _hsm->exportBufferTrueSize = _engine.prepareSharing(_export_buffer, 
+                    _hsm->exportBufferMaxSize, _hsm->exportBufferAllocatedSize);
                 auto [admitted, total] = _engine.getLastAdmittedClauseShare();
                 _hsm->lastNumAdmittedClausesToImport = admitted;
                 _hsm->lastNumClausesToImport = total;
@@ -156,7 +172,8 @@ public:
             // Check if clauses should be filtered
             if (_hsm->doFilterImport && !_hsm->didFilterImport) {
                 LOGGER(_log, V5_DEBG, "DO filter clauses\n");
-                _hsm->filterSize = _engine.filterSharing(_import_buffer, _hsm->importBufferSize, _filter_buffer);
+                _hsm->filterSize = _engine.filterSharing(_import_buffers[_hsm->importBufferSlot], 
+                    _hsm->importBufferSize, _filter_buffer);
                 _hsm->didFilterImport = true;
             }
             if (!_hsm->doFilterImport) _hsm->didFilterImport = false;
@@ -165,12 +182,13 @@ public:
             if ((_hsm->doDigestImportWithFilter || _hsm->doDigestImportWithoutFilter) 
                     && !_hsm->didDigestImport && _hsm->importBufferRevision <= _last_imported_revision) {
                 LOGGER(_log, V5_DEBG, "DO import clauses\n");
-                // Write imported clauses from shared memory into vector
+                // Read imported clauses in place from the designated import slot
                 assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
+                int* importBuffer = _import_buffers[_hsm->importBufferSlot];
                 if (_hsm->doDigestImportWithFilter) {
-                    _engine.digestSharingWithFilter(_import_buffer, _hsm->importBufferSize, _filter_buffer);
+                    _engine.digestSharingWithFilter(importBuffer, _hsm->importBufferSize, _filter_buffer);
                 } else {
-                    _engine.digestSharingWithoutFilter(_import_buffer, _hsm->importBufferSize);
+                    _engine.digestSharingWithoutFilter(importBuffer, _hsm->importBufferSize);
                 }
                 _hsm->didDigestImport = true;
             }
@@ -247,7 +265,15 @@ private:
         return ptr;
     }
 
-    void updateChecksum(int* ptr, size_t size) {
+    const int* accessFormula(int revision, size_t size) {
+        // Formula payloads are usually held in a read-only segment common to the host
+        auto sharedId = _config.getSharedFormulaId(_params.hostSharedMemoryKey(), revision, sizeof(int) * size);
+        const int* ptr = (const int*) SharedMemory::accessShared(sharedId, sizeof(int) * size);
+        if (ptr != nullptr) return ptr;
+        return (const int*) accessMemory(_shmem_id + ".formulae." + std::to_string(revision), sizeof(int) * size);
+    }
+
+    void updateChecksum(const int* ptr, size_t size) {
         if (_checksum == nullptr) return;
         for (size_t i = 0; i < size; i++) _checksum->combine(ptr[i]);
     }
@@ -272,7 +298,7 @@ private:
         size_t* fSizePtr = (size_t*) accessMemory(_shmem_id + ".fsize." + std::to_string(revision), sizeof(size_t));
         size_t* aSizePtr = (size_t*) accessMemory(_shmem_id + ".asize." + std::to_string(revision), sizeof(size_t));
         LOGGER(_log, V4_VVER, "Read rev. %i/%i : %i lits, %i assumptions\n", revision, _desired_revision, *fSizePtr, *aSizePtr);
-        int* fPtr = (int*) accessMemory(_shmem_id + ".formulae." + std::to_string(revision), sizeof(int) * (*fSizePtr));
+        const int* fPtr = accessFormula(revision, *fSizePtr);
         int* aPtr = (int*) accessMemory(_shmem_id + ".assumptions." + std::to_string(revision), sizeof(int) * (*aSizePtr));
         
         if (checksum != nullptr) {
@@ -294,17 +320,11 @@ private:
     }
 
     void doSleep() {
-        // Wait until something happens
-        // (can be interrupted by Fork::wakeUp(hsm->childPid))
-        float time = Timer::elapsedSeconds();
-
-        // busy waiting
-        //while (Timer::elapsedSeconds() - time < 0.001) {}
-
-        // sleeping
-        int sleepStatus = usleep(1000 /*1 millisecond*/);
-        time = Timer::elapsedSeconds() - time;
-        if (sleepStatus != 0) LOGGER(_log, V5_DEBG, "Woken up after %i us\n", (int) (1000*1000*time));
+        // Wait until the parent posts an instruction, a solver finds a result,
+        // or a signal arrives, at most until the solvers' state should be checked again.
+        // Instructions posted after the last observed epoch end the wait immediately.
+        _hsm->childWakeup.wait(_wakeup_epoch, IDLE_WAIT_MICROS);
+        _wakeup_epoch = _hsm->childWakeup.getEpoch();
     }
 
     void doTerminate() {
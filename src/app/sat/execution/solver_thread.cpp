@@ -1,5 +1,6 @@
 
 #include <sys/resource.h>
+#include <unistd.h>
 #include "util/assert.hpp"
 
 #include "solver_thread.hpp"
@@ -96,6 +97,8 @@ bool SolverThread::readFormula() {
                 fSize = _pending_formulae[_active_revision].first;
                 fLits = _pending_formulae[_active_revision].second;
             }
+            // Shuffling requires the complete formula
+            if (!waitForLiterals(fSize)) return false;
             auto [sData, sSize] = _shuffler.doShuffle(fLits, fSize);
             _pending_formulae[_active_revision].first = sSize;
             _pending_formulae[_active_revision].second = sData;
@@ -117,6 +120,7 @@ bool SolverThread::readFormula() {
         for (size_t start = _imported_lits_curr_revision; start < fSize; start += batchSize) {
 
             size_t end = std::min(start+batchSize, fSize);
+            if (!waitForLiterals(end)) return false;
             for (size_t i = start; i < end; i++) {
                 int lit = fLits[i];
                 if (std::abs(lit) > 134217723) {
@@ -203,6 +207,18 @@ bool SolverThread::readFormula() {
     }
 }
 
+bool SolverThread::waitForLiterals(size_t numLits) {
+    // Only the initial revision may still be arriving
+    if (_incoming_formula == nullptr || _active_revision > 0) return true;
+    // Woken up by each arriving fragment and by termination
+    while (_incoming_formula->get() < numLits) {
+        waitWhileSuspended();
+        if (_terminated) return false;
+        _incoming_formula->waitFor(numLits, 100'000);
+    }
+    return true;
+}
+
 void SolverThread::appendRevision(int revision, size_t fSize, const int* fLits, size_t aSize, const int* aLits) {
     {
         auto lock = _state_mutex.getLock();
@@ -361,6 +377,7 @@ void SolverThread::reportResult(int res, int revision) {
     }
 
     _found_result = true;
+    if (_result_callback) _result_callback();
 }
 
 SolverThread::~SolverThread() {
@@ -12,6 +12,7 @@
 #include "util/sys/threading.hpp"
 #include "util/logger.hpp"
 #include "data/job_result.hpp"
+#include "data/formula_progress.hpp"
 #include "../job/sat_process_config.hpp"
 #include "../solvers/portfolio_solver_interface.hpp"
 #include "solving_state.hpp"
@@ -32,6 +33,8 @@ private:
 
     std::vector<std::pair<size_t, const int*>> _pending_formulae;
     std::vector<std::pair<size_t, const int*>> _pending_assumptions;
+    // Non-null while the initial formula is still arriving: number of its literals present
+    FormulaProgress* _incoming_formula = nullptr;
     
     ClauseShuffler _shuffler;
     bool _shuffle;
@@ -61,6 +64,7 @@ private:
 
     bool _found_result = false;
     JobResult _result;
+    std::function<void()> _result_callback;
 
 
 public:
@@ -70,6 +74,9 @@ public:
 
     void start();
     void appendRevision(int revision, size_t fSize, const int* fLits, size_t aSize, const int* aLits);
+    void setIncomingFormula(FormulaProgress* incomingFormula) {
+        _incoming_formula = incomingFormula;
+    }
     void setSuspend(bool suspend) {
         {
             auto lock = _state_mutex.getLock();
@@ -83,8 +90,13 @@ public:
         _solver.setTerminate();
         _terminated = true;
         _state_cond.notify();
+        if (_incoming_formula) _incoming_formula->notify();
     }
     void tryJoin() {if (_thread.joinable()) _thread.join();}
+    // Called from the solver thread as soon as it has found a result
+    void setResultCallback(const std::function<void()>& cb) {
+        _result_callback = cb;
+    }
 
     bool isInitialized() const {
         return _initialized;
@@ -108,6 +120,7 @@ private:
     
     void pin();
     bool readFormula();
+    bool waitForLiterals(size_t numLits);
 
     void diversifyInitially();
     void diversifyAfterReading();
@@ -48,7 +48,8 @@ void AnytimeSatClauseCommunicator::communicate() {
     if (_params.appCommPeriod() <= 0) return;
 
     // update role in distributed filter
-    //_filter.update(_job->getJobTree().getIndex(), _job->getVolume());
+    if (_params.distributedDuplicateDetection())
+        _filter.update(_job->getJobTree().getIndex(), _job->getVolume());
 
     // clean up old sessions
     while (_sessions.size() > 1) {
@@ -98,6 +99,9 @@ void AnytimeSatClauseCommunicator::communicate() {
         session._allreduce_clauses.produce([&]() {
             Checksum checksum;
             auto clauses = _job->getPreparedClauses(checksum);
+            // (in streaming mode, segments are encoded individually)
+            if (_params.compressClauseBuffers() && !session._allreduce_clauses.isStreaming())
+                clauses = _cdb.getBufferCodec().encode(clauses.data(), clauses.size());
             clauses.push_back(1); // # aggregated workers
             return clauses;
         });
@@ -138,15 +142,28 @@ void AnytimeSatClauseCommunicator::communicate() {
 
         // Fetch initial clause buffer (result of all-reduction of clauses)
         session._broadcast_clause_buffer = session._allreduce_clauses.extractResult();
+        if (_params.compressClauseBuffers()) {
+            // Decode clause buffer (except for the trailing number of aggregated workers)
+            auto& buf = session._broadcast_clause_buffer;
+            assert(!buf.empty());
+            int numAggregated = buf.back();
+            buf = _cdb.getBufferCodec().decode(buf.data(), buf.size()-1);
+            buf.push_back(numAggregated);
+        }
 
         // Initiate production of local filter element for 2nd all-reduction 
-        _job->filterSharing(session._broadcast_clause_buffer);
+        _job->filterSharing(session._epoch, session._broadcast_clause_buffer);
     }
 
     // Supply calculated local filter to the 2nd all-reduction
     if (!session._allreduce_filter.hasProducer() && _job->hasFilteredSharing()) {
         LOG(V4_VVER, "%s CS produce filter\n", _job->toStr());
-        session._allreduce_filter.produce([&]() {return _job->getLocalFilter();});
+        session._allreduce_filter.produce([&]() {
+            auto filter = _job->getLocalFilter();
+            if (_params.distributedDuplicateDetection()) 
+                addDistributedDuplicatesToFilter(session._broadcast_clause_buffer, session._epoch, filter);
+            return filter;
+        });
     }
 
     // Advance all-reduction of filter
@@ -159,7 +176,7 @@ void AnytimeSatClauseCommunicator::communicate() {
 
         // Extract and digest result
         auto filter = session._allreduce_filter.extractResult();
-        _job->applyFilter(filter);
+        _job->applyFilter(session._epoch, filter);
         if (_use_cls_history) {
             auto filteredClauses = session.applyGlobalFilter(filter, session._broadcast_clause_buffer);
             addToClauseHistory(filteredClauses, session._epoch);
@@ -205,6 +222,16 @@ void AnytimeSatClauseCommunicator::handle(int source, int mpiTag, JobMessage& ms
             mpiTag = MSG_JOB_TREE_REDUCTION;
             msg.payload.resize(1);
             msg.payload[0] = 1; // num aggregated nodes
+            if (!_sessions.empty() && currentSession()._allreduce_clauses.isStreaming()) {
+                // Pretend that the child sent each (empty) segment
+                auto& allreduce = currentSession()._allreduce_clauses;
+                for (int segment = 1; segment < allreduce.getNumSegments(); segment++) {
+                    JobMessage segmentMsg = msg;
+                    segmentMsg.payload.push_back(segment);
+                    allreduce.receive(source, mpiTag, segmentMsg);
+                }
+                msg.payload.push_back(0);
+            }
         } else if (msg.tag == MSG_ALLREDUCE_CLAUSES && mpiTag == MSG_JOB_TREE_BROADCAST) {
             // Distribution of clauses hit an inactive (?) child:
             // Pretend that it sent an empty filter
@@ -281,6 +308,29 @@ std::vector<int> AnytimeSatClauseCommunicator::Session::applyGlobalFilter(const
     return writer.extractBuffer();
 }
 
+void AnytimeSatClauseCommunicator::addDistributedDuplicatesToFilter(std::vector<int>& clauses, int epoch, std::vector<int>& filter) {
+
+    // Each clause is checked (and registered) at exactly one job node
+    // which is responsible for the clause's fingerprint. The bitwise OR
+    // of all filters then contains the verdicts of all responsible nodes.
+    constexpr auto bitsPerElem = 8*sizeof(int);
+    auto reader = _cdb.getBufferReader(clauses.data(), clauses.size());
+    size_t clsIdx = 0;
+    int nbDuplicates = 0;
+    for (auto clause = reader.getNextIncomingClause(); clause.begin != nullptr; clause = reader.getNextIncomingClause()) {
+        size_t filterIdx = clsIdx / bitsPerElem;
+        if (filter.size() <= filterIdx) filter.resize(filterIdx+1, 0);
+        if (!_filter.passClause(clause, epoch)) {
+            filter[filterIdx] |= 1 << (clsIdx % bitsPerElem);
+            nbDuplicates++;
+        }
+        clsIdx++;
+    }
+    _filter.collectGarbage(epoch);
+    LOG(V4_VVER, "%s : DDD found %i/%i duplicates, %lu fingerprints\n", _job->toStr(), 
+        nbDuplicates, clsIdx, _filter.size());
+}
+
 void AnytimeSatClauseCommunicator::addToClauseHistory(std::vector<int>& clauses, int epoch) {
     LOG(V4_VVER, "%s : learn s=%i\n", _job->toStr(), clauses.size());
     
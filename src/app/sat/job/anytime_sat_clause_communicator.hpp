@@ -10,7 +10,7 @@
 #include "app/job.hpp"
 #include "base_sat_job.hpp"
 #include "clause_history.hpp"
-//#include "distributed_clause_filter.hpp"
+#include "distributed_clause_filter.hpp"
 #include "comm/job_tree_all_reduction.hpp"
 
 class AnytimeSatClauseCommunicator {
@@ -35,7 +35,7 @@ private:
 
     AdaptiveClauseDatabase _cdb;
     ClauseHistory _cls_history;
-    //DistributedClauseFilter _filter;
+    DistributedClauseFilter _filter;
     float _compensation_factor = 1.0f;
     float _compensation_decay = 0.6;
 
@@ -51,12 +51,19 @@ private:
         int _num_broadcast_clauses;
         int _num_admitted_clauses;
 
+        // Pipelined merging of bucket-aligned segments (if enabled)
+        BufferSegmenter _segmenter;
+        int _merged_lits_of_prior_segments = 0;
+        int _excess_lits_of_prior_segments = 0;
+        bool _merge_exceeded_limit = false;
+
         JobTreeAllReduction _allreduce_clauses;
         JobTreeAllReduction _allreduce_filter;
         bool _filtering = false;
 
         Session(const Parameters& params, BaseSatJob* job, AdaptiveClauseDatabase& cdb, int epoch) : 
             _params(params), _job(job), _cdb(cdb), _epoch(epoch),
+            _segmenter(cdb.getBufferSegmenter(params.clauseSharingSegments())),
             _allreduce_clauses(
                 job->getJobTree(),
                 // Base message 
@@ -70,13 +77,45 @@ private:
                         numAggregated += elem.back();
                         elem.pop_back();
                     }
-                    auto merger = _cdb.getBufferMerger(_job->getBufferLimit(numAggregated, MyMpi::ALL));
+                    int limit = _job->getBufferLimit(numAggregated, MyMpi::ALL);
+                    int excessLimit = limit;
+                    bool streaming = _allreduce_clauses.isStreaming();
+                    if (streaming) {
+                        // Segments are merged in order of priority: 
+                        // each segment only gets the remaining budget
+                        limit = _merge_exceeded_limit ? 0 : std::max(0, limit - _merged_lits_of_prior_segments);
+                        excessLimit = std::max(0, excessLimit - _excess_lits_of_prior_segments);
+                    }
+                    auto merger = _cdb.getBufferMerger(limit);
+                    merger.setExcessSizeLimit(excessLimit);
                     for (auto& elem : elems) {
-                        merger.add(_cdb.getBufferReader(elem.data(), elem.size()));
+                        // Encoded contributions are decoded lazily during the merge
+                        merger.add(_params.compressClauseBuffers() ?
+                            _cdb.getEncodedBufferReader(elem.data(), elem.size()) :
+                            _cdb.getBufferReader(elem.data(), elem.size()));
+                    }
+                    std::vector<int> excess;
+                    std::vector<int> merged = merger.merge(streaming ? &excess : &_excess_clauses_from_merge);
+                    if (streaming) {
+                        _merged_lits_of_prior_segments += merger.getNumMergedLiterals();
+                        _excess_lits_of_prior_segments += merger.getNumExcessLiterals();
+                        _merge_exceeded_limit |= merger.hasExceededSizeLimit();
+                        if (_excess_clauses_from_merge.empty()) {
+                            _excess_clauses_from_merge = std::move(excess);
+                        } else if (merger.getNumExcessLiterals() > 0) {
+                            std::vector<std::vector<int>> parts {std::move(_excess_clauses_from_merge), std::move(excess)};
+                            _excess_clauses_from_merge = _segmenter.join(parts);
+                        }
+                    }
+                    if (_params.compressClauseBuffers()) {
+                        size_t rawSize = merged.size();
+                        merged = _cdb.getBufferCodec().encode(merged.data(), merged.size());
+                        LOG(V4_VVER, "%s : merged %i contribs ~> len=%i (encoded: %i)\n", 
+                            _job->toStr(), numAggregated, rawSize, merged.size());
+                    } else {
+                        LOG(V4_VVER, "%s : merged %i contribs ~> len=%i\n", 
+                            _job->toStr(), numAggregated, merged.size());
                     }
-                    std::vector<int> merged = merger.merge(&_excess_clauses_from_merge);
-                    LOG(V4_VVER, "%s : merged %i contribs ~> len=%i\n", 
-                        _job->toStr(), numAggregated, merged.size());
                     merged.push_back(numAggregated);
                     return merged;
                 }
@@ -100,7 +139,37 @@ private:
                     }
                     return filter;
                 }
-            ) { }
+            ) {
+            
+            _allreduce_clauses.setStreaming(_segmenter.getNumSegments(), 
+                // Split local contribution into segments
+                [&](std::vector<int>& elem) {
+                    int numAggregated = elem.back();
+                    elem.pop_back();
+                    auto segments = _segmenter.split(elem);
+                    for (auto& segment : segments) {
+                        if (_params.compressClauseBuffers())
+                            segment = _cdb.getBufferCodec().encode(segment.data(), segment.size());
+                        segment.push_back(numAggregated);
+                    }
+                    return segments;
+                },
+                // Join all aggregated segments at the root
+                [&](std::vector<std::vector<int>>& segments) {
+                    int numAggregated = segments.front().back();
+                    for (auto& segment : segments) {
+                        segment.pop_back();
+                        if (_params.compressClauseBuffers())
+                            segment = _cdb.getBufferCodec().decode(segment.data(), segment.size());
+                    }
+                    auto joined = _segmenter.join(segments);
+                    if (_params.compressClauseBuffers()) 
+                        joined = _cdb.getBufferCodec().encode(joined.data(), joined.size());
+                    joined.push_back(numAggregated);
+                    return joined;
+                }
+            );
+        }
         ~Session() {
             _allreduce_clauses.destroy();
             _allreduce_filter.destroy();
@@ -138,7 +207,8 @@ public:
             setup.numLiterals = 0;
             return setup;
         }()),
-        _cls_history(_params, _job->getBufferLimit(_job->getJobTree().getCommSize(), MyMpi::ALL), *job, _cdb) {
+        _cls_history(_params, _job->getBufferLimit(_job->getJobTree().getCommSize(), MyMpi::ALL), *job, _cdb),
+        _filter(_params.distributedDuplicateDetectionEpochs()) {
 
         _time_of_last_epoch_initiation = Timer::elapsedSeconds();
         _time_of_last_epoch_conclusion = Timer::elapsedSeconds();
@@ -159,4 +229,5 @@ public:
 private:
     inline Session& currentSession() {return _sessions.back();}
     void addToClauseHistory(std::vector<int>& clauses, int epoch);
+    void addDistributedDuplicatesToFilter(std::vector<int>& clauses, int epoch, std::vector<int>& filter);
 };
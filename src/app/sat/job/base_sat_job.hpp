@@ -20,10 +20,10 @@ public:
     virtual std::vector<int> getPreparedClauses(Checksum& checksum) = 0;
     virtual std::pair<int, int> getLastAdmittedClauseShare() = 0;
 
-    virtual void filterSharing(std::vector<int>& clauses) = 0;
+    virtual void filterSharing(int epoch, std::vector<int>& clauses) = 0;
     virtual bool hasFilteredSharing() = 0;
     virtual std::vector<int> getLocalFilter() = 0;
-    virtual void applyFilter(std::vector<int>& filter) = 0;
+    virtual void applyFilter(int epoch, std::vector<int>& filter) = 0;
     
     virtual void digestSharingWithoutFilter(std::vector<int>& clauses) = 0;
     virtual void returnClauses(std::vector<int>& clauses) = 0;
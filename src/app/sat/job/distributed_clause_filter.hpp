@@ -7,10 +7,21 @@
 #include "../sharing/filter/clause_filter.hpp"
 #include "app/job_tree.hpp"
 
+/*
+Distributed duplicate detection for shared clauses. The space of clause
+fingerprints is partitioned among the nodes of a job tree (see getSlotIndex):
+each node remembers the fingerprints of the clauses it is responsible for,
+together with the last epoch in which each clause was shared, and reports
+a clause as a duplicate if it was shared within the last few epochs.
+Since all nodes see the same broadcast clause buffer, OR-ing the nodes'
+answers yields a global verdict for each clause.
+Only 64-bit fingerprints (no literals) are stored.
+*/
 class DistributedClauseFilter {
 
 private:
-    robin_hood::unordered_flat_map<Mallob::Clause, int, NonCommutativeClauseHasher, SortedClauseExactEquals> _filter;
+    // clause fingerprint -> epoch of last occurrence
+    robin_hood::unordered_flat_map<uint64_t, int> _filter;
 
     int _last_index = -1;
     int _last_volume = -1;
@@ -21,6 +32,7 @@ private:
     int _right_slot_index;
 
     int _num_remembered_epochs;
+    int _last_cleanup_epoch = 0;
 
 public:
     DistributedClauseFilter(int numRememberedEpochs) : 
@@ -68,40 +80,38 @@ public:
         }
     }
 
-    bool passClause(Mallob::Clause& clause, int epoch) {
-
-        size_t hash = ClauseHasher::hash(clause, /*which=*/3);
-
-        auto it = _filter.find(clause);
-        bool contained = it != _filter.end();
-
-        if (contained && epoch - it->second > _num_remembered_epochs) {
-            // Obsolete epoch! Remove entry and pretend it was never there
-            contained = false;
-            free(it->first.begin);
-            _filter.erase(it);
-        }
-
-        // Already contained: clause does not pass.
-        if (contained) return false;
+    bool passClause(const Mallob::Clause& clause, int epoch) {
 
+        uint64_t hash = Mallob::fingerprint(clause.begin, clause.size);
         // Am I responsible for this clause?
-        if (isResponsibleFor(hash) && !contained) {
-            Clause copy = clause;
-            copy.begin = (int*) malloc(sizeof(int)*clause.size);
-            memcpy(copy.begin, clause.begin, sizeof(int)*clause.size);
-            _filter[copy] = epoch; // register
+        if (!isResponsibleFor(hash)) return true;
+
+        auto it = _filter.find(hash);
+        if (it != _filter.end() && epoch - it->second <= _num_remembered_epochs) {
+            // Recently shared: clause does not pass.
+            return false;
         }
 
+        // Register (or refresh obsolete entry)
+        _filter[hash] = epoch;
         return true; // no duplicate was found: success
     }
 
-    ~DistributedClauseFilter() {
-        for (auto& [c, val] : _filter) free(c.begin);
+    // Removes all entries which have become obsolete at the given epoch.
+    // Only performs work if the last cleanup is sufficiently long ago.
+    void collectGarbage(int epoch) {
+        if (_num_remembered_epochs == INT32_MAX) return;
+        if (epoch - _last_cleanup_epoch < std::max(1, _num_remembered_epochs/2)) return;
+        _last_cleanup_epoch = epoch;
+        for (auto it = _filter.begin(); it != _filter.end();) {
+            if (epoch - it->second > _num_remembered_epochs) it = _filter.erase(it);
+            else ++it;
+        }
     }
 
-    bool isResponsibleFor(size_t hash) {
-        double hashPivot = (((double) hash) / SIZE_MAX) * (_max_slot_index);
+    bool isResponsibleFor(uint64_t hash) {
+        if (_last_index < 0) return false;
+        double hashPivot = (((double) hash) / UINT64_MAX) * (_max_slot_index);
         double myPivot = _my_slot_index - 0.5;
         //LOG(V2_INFO, "%.5f %.5f\n", hashPivot, myPivot);
         if (_left_slot_index == -1 && hashPivot <= myPivot) return true;
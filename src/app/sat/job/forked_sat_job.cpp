@@ -46,6 +46,7 @@ void ForkedSatJob::doStartSolver() {
         desc.getAssumptionsPayload(0),
         (AnytimeSatClauseCommunicator*)_clause_comm
     ));
+    _solver->setIncomingFormula(getIncomingFormula());
     loadIncrements();
 
     //log(V5_DEBG, "%s : beginning to solve\n", toStr());
@@ -210,9 +211,9 @@ std::pair<int, int> ForkedSatJob::getLastAdmittedClauseShare() {
     return _solver->getLastAdmittedClauseShare();
 }
 
-void ForkedSatJob::filterSharing(std::vector<int>& clauses) {
+void ForkedSatJob::filterSharing(int epoch, std::vector<int>& clauses) {
     if (!_initialized) return;
-    _solver->filterClauses(clauses);
+    _solver->filterClauses(epoch, clauses);
 }
 bool ForkedSatJob::hasFilteredSharing() {
     if (!_initialized) return false;
@@ -222,9 +223,9 @@ std::vector<int> ForkedSatJob::getLocalFilter() {
     if (!_initialized) return std::vector<int>();
     return _solver->getLocalFilter();
 }
-void ForkedSatJob::applyFilter(std::vector<int>& filter) {
+void ForkedSatJob::applyFilter(int epoch, std::vector<int>& filter) {
     if (!_initialized) return;
-    _solver->applyFilter(filter);
+    _solver->applyFilter(epoch, filter);
 }
 
 void ForkedSatJob::digestSharingWithoutFilter(std::vector<int>& clauses) {
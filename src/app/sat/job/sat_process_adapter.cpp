@@ -2,6 +2,7 @@
 #include "util/assert.hpp"
 #include <sys/types.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <fstream>
 #include <cstdio>
 
@@ -18,6 +19,7 @@
 #include "anytime_sat_clause_communicator.hpp"
 #include "util/sys/thread_pool.hpp"
 #include "util/sys/fileutils.hpp"
+#include "sat_process_pool.hpp"
 
 #ifndef MALLOB_SUBPROC_DISPATCH_PATH
 #define MALLOB_SUBPROC_DISPATCH_PATH ""
@@ -30,6 +32,9 @@ SatProcessAdapter::SatProcessAdapter(Parameters&& params, SatProcessConfig&& con
 
     _desired_revision = _config.firstrev;
     _shmem_id = _config.getSharedMemId(Proc::getPid());
+    // Without a host-wide key, formula segments are specific to this process
+    if (!_params.hostSharedMemoryKey.isSet())
+        _params.hostSharedMemoryKey.set(std::to_string(Proc::getPid()));
 }
 
 void SatProcessAdapter::doWriteRevisions() {
@@ -48,7 +53,7 @@ void SatProcessAdapter::doWriteRevisions() {
             auto revStr = std::to_string(revData.revision);
             createSharedMemoryBlock("fsize."       + revStr, sizeof(size_t),              (void*)&revData.fSize);
             createSharedMemoryBlock("asize."       + revStr, sizeof(size_t),              (void*)&revData.aSize);
-            createSharedMemoryBlock("formulae."    + revStr, sizeof(int) * revData.fSize, (void*)revData.fLits);
+            provideFormula(revData.revision, revData.fSize, revData.fLits);
             createSharedMemoryBlock("assumptions." + revStr, sizeof(int) * revData.aSize, (void*)revData.aLits);
             createSharedMemoryBlock("checksum."    + revStr, sizeof(Checksum),            (void*)&(revData.checksum));
             _written_revision = revData.revision;
@@ -120,54 +125,71 @@ void SatProcessAdapter::doInitialize() {
     ) + 1024;
     _export_buffer = (int*) createSharedMemoryBlock("clauseexport", 
             sizeof(int)*_hsm->exportBufferAllocatedSize, nullptr);
-    _import_buffer = (int*) createSharedMemoryBlock("clauseimport", 
+    _import_slots.resize(SatSharedMemory::NUM_IMPORT_SLOTS);
+    for (size_t i = 0; i < _import_slots.size(); i++) {
+        _import_slots[i].data = (int*) createSharedMemoryBlock("clauseimport." + std::to_string(i), 
             sizeof(int)*_hsm->importBufferMaxSize, nullptr);
+    }
     _filter_buffer = (int*) createSharedMemoryBlock("clausefilter", 
             _hsm->importBufferMaxSize/8 + 1, nullptr);
     _returned_buffer = (int*) createSharedMemoryBlock("returnedclauses",
             sizeof(int)*_hsm->importBufferMaxSize, nullptr);
 
     // Allocate shared memory for formula, assumptions of initial revision
-    createSharedMemoryBlock("formulae.0", sizeof(int) * _f_size, (void*)_f_lits);
+    int* incomingFormula = nullptr;
+    size_t numCopiedLits = 0;
+    if (_incoming_formula_lits) {
+        // The formula is still being received: the child starts reading
+        // the part present so far and the rest is forwarded as it arrives
+        incomingFormula = (int*) createSharedMemoryBlock("formulae.0", sizeof(int) * _f_size, nullptr);
+        _hsm->fAvailable.set(0);
+        forwardIncomingFormula(incomingFormula, numCopiedLits);
+    } else {
+        provideFormula(0, _f_size, _f_lits);
+        _hsm->fAvailable.set(_f_size);
+    }
     createSharedMemoryBlock("assumptions.0", sizeof(int) * _a_size, (void*)_a_lits);
 
     if (_terminate) return;
 
-    // FORK: Create a child process
-    pid_t res = Process::createChild();
-    if (res == 0) {
-        // [child process]
-        execl(MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
-              MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
-              (char*) 0);
-        
-        // If this is reached, something went wrong with execvp
-        LOG(V0_CRIT, "[ERROR] execl returned errno %i\n", (int)errno);
-        abort();
+    // Hand the job to a pre-started process if possible
+    pid_t res = SatProcessPool::take(_params.getParamsAsString());
+    if (res == -1) {
+        // FORK: Create a child process
+        res = SatProcessPool::forkDispatcher();
+        // Assemble SAT subprocess command and have the child execute it
+        std::string executable = MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process";
+        SatProcessPool::dispatch(res, _params.getSubprocCommandAsString(executable.c_str()));
     }
 
-    // Assemble SAT subprocess command
-    std::string executable = MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process";
-    //char* const* argv = _params.asCArgs(executable.c_str());
-    std::string command = _params.getSubprocCommandAsString(executable.c_str());
-    
-    // Write command to tmp file
-    std::string commandOutfile = "/tmp/mallob_subproc_cmd_" + std::to_string(res) + "~";
-    std::ofstream ofs(commandOutfile);
-    ofs << command << " " << std::endl;
-    ofs.close();
-    std::rename(commandOutfile.c_str(), commandOutfile.substr(0, commandOutfile.size()-1).c_str()); // remove tilde
-
-    //int i = 0;
-    //delete[] ((const char**) argv);
-
     {
         auto lock = _state_mutex.getLock();
         _initialized = true;
         _hsm->doBegin = true;
+        _hsm->childWakeup.notify();
         _child_pid = res;
         applySolvingState();
     }
+
+    // Refill the pool outside of the job's critical path
+    SatProcessPool::replenish();
+
+    if (incomingFormula != nullptr) {
+        // Woken up by each fragment appended to the incoming description
+        while (!_terminate && !forwardIncomingFormula(incomingFormula, numCopiedLits)) 
+            _incoming_formula_lits->waitFor(numCopiedLits+1, 100'000);
+        LOG(V4_VVER, "%s : forwarded incoming formula (%lu lits)\n", _job->toStr(), numCopiedLits);
+    }
+}
+
+bool SatProcessAdapter::forwardIncomingFormula(int* dest, size_t& numCopied) {
+    size_t numAvailable = std::min(_f_size, _incoming_formula_lits->get());
+    if (numAvailable > numCopied) {
+        memcpy(dest+numCopied, _f_lits+numCopied, sizeof(int) * (numAvailable-numCopied));
+        numCopied = numAvailable;
+        _hsm->fAvailable.set(numCopied);
+    }
+    return numCopied == _f_size;
 }
 
 bool SatProcessAdapter::hasClauseComm() {
@@ -201,6 +223,7 @@ void SatProcessAdapter::applySolvingState() {
         //Fork::terminate(_child_pid); // Terminate child process by signal.
         _hsm->doTerminate = true; // Kindly ask child process to terminate.
         _hsm->doBegin = true; // Let child process know termination even if it waits for first revision
+        _hsm->childWakeup.notify();
         Process::resume(_child_pid); // Continue (resume) process.
     }
     if (_state == SolvingStates::SUSPENDED || _state == SolvingStates::STANDBY) {
@@ -216,7 +239,7 @@ void SatProcessAdapter::collectClauses(int maxSize) {
     if (_hsm->doExport || _hsm->didExport) return;
     _hsm->exportBufferMaxSize = maxSize;
     _hsm->doExport = true;
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
+    _hsm->childWakeup.notify();
 }
 bool SatProcessAdapter::hasCollectedClauses() {
     return !_initialized || (_hsm->doExport && _hsm->didExport);
@@ -234,45 +257,99 @@ std::pair<int, int> SatProcessAdapter::getLastAdmittedClauseShare() {
     return _last_admitted_clause_share;
 }
 
-bool SatProcessAdapter::process(const std::vector<int>& buffer, BufferTask task) {
+void SatProcessAdapter::enqueue(const std::vector<int>& buffer, BufferTask task, int epoch) {
+
+    // Hand the buffer to the child directly if possible
+    if (_pending_tasks.empty() && dispatch(buffer, task, -1, epoch)) return;
+
+    PendingTask pending {task, -1, epoch, std::vector<int>()};
+    if (task != APPLY_FILTER && _initialized) {
+        // Write clauses to a free import slot already
+        pending.slot = acquireImportSlot(buffer);
+    }
+    if (pending.slot < 0) pending.buffer = buffer;
+    _pending_tasks.push_back(std::move(pending));
+}
+
+bool SatProcessAdapter::dispatch(const std::vector<int>& buffer, BufferTask task, int slot, int epoch) {
 
-    if (!_initialized || _hsm->doFilterImport || _hsm->doDigestImportWithFilter || _hsm->doDigestImportWithoutFilter) {
+    // The child must be idle w.r.t. clause imports and must have acknowledged the last task
+    if (!_initialized || _hsm->doFilterImport || _hsm->doDigestImportWithFilter || _hsm->doDigestImportWithoutFilter
+            || _hsm->didFilterImport || _hsm->didDigestImport) {
         return false;
     }
 
-    if (task == FILTER_CLAUSES) {
-        _hsm->importBufferSize = buffer.size();
+    if (task == FILTER_CLAUSES || task == DIGEST_WITHOUT_FILTER) {
+        if (slot < 0) slot = acquireImportSlot(buffer);
+        if (slot < 0 && !_filtered_slots.empty()) {
+            // All slots are held by filtered buffers which never received their
+            // global filter (e.g., due to a cancelled sharing): reclaim the oldest one.
+            // Should its filter still arrive, it will be discarded due to its epoch.
+            auto [oldEpoch, oldSlot] = _filtered_slots.front();
+            LOG(V3_VERB, "Reclaim import slot %i awaiting the filter of epoch %i\n", oldSlot, oldEpoch);
+            _import_slots[oldSlot].inUse = false;
+            _filtered_slots.pop_front();
+            slot = acquireImportSlot(buffer);
+        }
+        if (slot < 0) return false;
+        _hsm->importBufferSlot = slot;
+        _hsm->importBufferSize = _import_slots[slot].size;
         _hsm->importBufferRevision = _desired_revision;
-        assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
-        memcpy(_import_buffer, buffer.data(), buffer.size()*sizeof(int));
-        _hsm->doFilterImport = true;
+        if (task == FILTER_CLAUSES) {
+            _filtered_slots.emplace_back(epoch, slot);
+            _hsm->doFilterImport = true;
+        } else {
+            _digested_slot = slot;
+            _hsm->doDigestImportWithoutFilter = true;
+        }
 
     } else if (task == APPLY_FILTER) {
+        // Global filters arrive in the order of their epochs: Buffers of earlier
+        // epochs will never receive their filter, so their slots can be released
+        while (!_filtered_slots.empty() && _filtered_slots.front().first < epoch) {
+            _import_slots[_filtered_slots.front().second].inUse = false;
+            _filtered_slots.pop_front();
+        }
+        if (_filtered_slots.empty() || _filtered_slots.front().first != epoch) {
+            LOG(V1_WARN, "[WARN] Discard global filter of epoch %i without a filtered import buffer\n", epoch);
+            return true;
+        }
+        slot = _filtered_slots.front().second;
+        _filtered_slots.pop_front();
         memcpy(_filter_buffer, buffer.data(), buffer.size()*sizeof(int));
+        _hsm->importBufferSlot = slot;
+        _hsm->importBufferSize = _import_slots[slot].size;
+        _digested_slot = slot;
         _hsm->doDigestImportWithFilter = true;
-
-    } else if (task == DIGEST_WITHOUT_FILTER) {
-        _hsm->importBufferSize = buffer.size();
-        _hsm->importBufferRevision = _desired_revision;
-        assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
-        memcpy(_import_buffer, buffer.data(), buffer.size()*sizeof(int));
-        _hsm->doDigestImportWithoutFilter = true;
     }
 
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
+    _hsm->childWakeup.notify();
     return true;
 }
 
-void SatProcessAdapter::filterClauses(const std::vector<int>& clauses) {
-    if (!process(clauses, FILTER_CLAUSES)) _pending_tasks.emplace_back(clauses, FILTER_CLAUSES);
+int SatProcessAdapter::acquireImportSlot(const std::vector<int>& clauses) {
+    for (size_t i = 0; i < _import_slots.size(); i++) {
+        auto& slot = _import_slots[i];
+        if (slot.inUse) continue;
+        assert(clauses.size() <= _hsm->importBufferMaxSize);
+        memcpy(slot.data, clauses.data(), clauses.size()*sizeof(int));
+        slot.size = clauses.size();
+        slot.inUse = true;
+        return i;
+    }
+    return -1;
 }
 
-void SatProcessAdapter::applyFilter(const std::vector<int>& filter) {
-    if (!process(filter, APPLY_FILTER)) _pending_tasks.emplace_back(filter, APPLY_FILTER);
+void SatProcessAdapter::filterClauses(int epoch, const std::vector<int>& clauses) {
+    enqueue(clauses, FILTER_CLAUSES, epoch);
+}
+
+void SatProcessAdapter::applyFilter(int epoch, const std::vector<int>& filter) {
+    enqueue(filter, APPLY_FILTER, epoch);
 }
 
 void SatProcessAdapter::digestClausesWithoutFilter(const std::vector<int>& clauses) {
-    if (!process(clauses, DIGEST_WITHOUT_FILTER)) _pending_tasks.emplace_back(clauses, DIGEST_WITHOUT_FILTER);
+    enqueue(clauses, DIGEST_WITHOUT_FILTER);
 }
 
 bool SatProcessAdapter::hasFilteredClauses() {
@@ -304,7 +381,7 @@ void SatProcessAdapter::doReturnClauses(const std::vector<int>& clauses) {
     memcpy(_returned_buffer, clauses.data(),
         std::min((size_t)_hsm->importBufferMaxSize, clauses.size()) * sizeof(int));
     _hsm->doReturnClauses = true;
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
+    _hsm->childWakeup.notify();
 }
 
 void SatProcessAdapter::dumpStats() {
@@ -336,6 +413,11 @@ SatProcessAdapter::SubprocessStatus SatProcessAdapter::check() {
     if (_hsm->didDigestImport) {
         _hsm->doDigestImportWithFilter = false;
         _hsm->doDigestImportWithoutFilter = false;
+        // The child is done with the digested slot: release it
+        if (_digested_slot >= 0) {
+            _import_slots[_digested_slot].inUse = false;
+            _digested_slot = -1;
+        }
     }
 
     if (!_hsm->doStartNextRevision 
@@ -344,10 +426,12 @@ SatProcessAdapter::SubprocessStatus SatProcessAdapter::check() {
         _published_revision++;
         _hsm->desiredRevision = _desired_revision;
         _hsm->doStartNextRevision = true;
+        _hsm->childWakeup.notify();
     }
 
-    if (!_pending_tasks.empty() && process(_pending_tasks.front().first, _pending_tasks.front().second)) {
-        _pending_tasks.pop_front();
+    if (!_pending_tasks.empty()) {
+        auto& pending = _pending_tasks.front();
+        if (dispatch(pending.buffer, pending.task, pending.slot, pending.epoch)) _pending_tasks.pop_front();
     }
 
     if (!_hsm->doReturnClauses && !_hsm->didReturnClauses && !_temp_returned_clauses.empty()) {
@@ -428,8 +512,25 @@ void* SatProcessAdapter::createSharedMemoryBlock(std::string shmemSubId, size_t
     return shmem;
 }
 
+void SatProcessAdapter::provideFormula(int revision, size_t size, const int* lits) {
+    size_t numBytes = sizeof(int) * size;
+    // Job ID, revision and size identify the formula within this run, so the
+    // payload is neither compared nor hashed here; with -checksums, the child
+    // verifies the formula it reads against the description's checksum
+    std::string id = _config.getSharedFormulaId(_params.hostSharedMemoryKey(), revision, numBytes);
+    void* shmem = SharedMemory::acquireShared(id, numBytes, lits);
+    if (shmem != nullptr) {
+        _shared_shmem.insert(ShmemObject{id, shmem, numBytes});
+        return;
+    }
+    // Fall back to a block specific to this process
+    LOG(V1_WARN, "[WARN] Could not acquire shmem %s\n", id.c_str());
+    createSharedMemoryBlock("formulae." + std::to_string(revision), numBytes, (void*)lits);
+}
+
 void SatProcessAdapter::crash() {
     _hsm->doCrash = true;
+    _hsm->childWakeup.notify();
 }
 
 SatProcessAdapter::~SatProcessAdapter() {
@@ -441,6 +542,8 @@ void SatProcessAdapter::freeSharedMemory() {
     
     if (!_terminate) {
         _terminate = true;
+        // Wake up the initializer if it waits for the incoming description
+        if (_incoming_formula_lits) _incoming_formula_lits->notify();
 
         // wait for termination of background threads
         if (_bg_initializer.valid()) _bg_initializer.get();
@@ -467,4 +570,10 @@ void SatProcessAdapter::freeSharedMemory() {
         SharedMemory::free(shmemObj.id, (char*)shmemObj.data, shmemObj.size);
     }
     _shmem.clear();
+
+    // Release host-wide segments (removed if no other process uses them)
+    for (auto& shmemObj : _shared_shmem) {
+        SharedMemory::releaseShared(shmemObj.id, shmemObj.data, shmemObj.size);
+    }
+    _shared_shmem.clear();
 }
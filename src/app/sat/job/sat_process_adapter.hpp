@@ -40,6 +40,8 @@ private:
     const int* _f_lits;
     size_t _a_size;
     const int* _a_lits;
+    // Number of literals of _f_lits present so far if the formula is still arriving
+    std::shared_ptr<FormulaProgress> _incoming_formula_lits;
     
     struct ShmemObject {
         std::string id; 
@@ -58,6 +60,8 @@ private:
         }
     };
     robin_hood::unordered_flat_set<ShmemObject, ShmemObjectHasher> _shmem;
+    // Host-wide formula segments referenced by this process
+    robin_hood::unordered_flat_set<ShmemObject, ShmemObjectHasher> _shared_shmem;
     std::string _shmem_id;
     SatSharedMemory* _hsm = nullptr;
 
@@ -70,11 +74,30 @@ private:
     std::future<void> _bg_writer;
 
     int* _export_buffer;
-    int* _import_buffer;
     int* _filter_buffer;
     int* _returned_buffer;
+
+    // Ring of import buffers in shared memory. An incoming buffer is written 
+    // to a free slot right away, even if the child is still busy. The slot is 
+    // handed to the child once it is idle and released after its digestion.
+    struct ImportSlot {
+        int* data = nullptr;
+        int size = 0;
+        bool inUse = false;
+    };
+    std::vector<ImportSlot> _import_slots;
+    // Slots filtered by the child which await the global filter of their sharing epoch
+    std::list<std::pair<int, int>> _filtered_slots; // (epoch, slot)
+    int _digested_slot = -1; // being digested by the child
+
     enum BufferTask {FILTER_CLAUSES, APPLY_FILTER, DIGEST_WITHOUT_FILTER};
-    std::list<std::pair<std::vector<int>, BufferTask>> _pending_tasks;
+    struct PendingTask {
+        BufferTask task;
+        int slot; // import slot holding the clauses, or -1
+        int epoch; // sharing epoch of the clauses to filter or of the filter
+        std::vector<int> buffer; // the clauses (if no slot was free) or the filter
+    };
+    std::list<PendingTask> _pending_tasks;
     std::list<std::vector<int>> _temp_returned_clauses;
     std::pair<int, int> _last_admitted_clause_share;
 
@@ -101,6 +124,9 @@ public:
         AnytimeSatClauseCommunicator* comm = nullptr);
     ~SatProcessAdapter();
 
+    void setIncomingFormula(const std::shared_ptr<FormulaProgress>& numLits) {
+        _incoming_formula_lits = numLits;
+    }
     void run();
     bool isFullyInitialized();
     void appendRevisions(const std::vector<RevisionData>& revisions, int desiredRevision);
@@ -118,11 +144,11 @@ public:
     std::vector<int> getCollectedClauses();
     std::pair<int, int> getLastAdmittedClauseShare();
 
-    void filterClauses(const std::vector<int>& clauses);
+    void filterClauses(int epoch, const std::vector<int>& clauses);
     bool hasFilteredClauses();
     std::vector<int> getLocalFilter();
 
-    void applyFilter(const std::vector<int>& filter);
+    void applyFilter(int epoch, const std::vector<int>& filter);
     void digestClausesWithoutFilter(const std::vector<int>& clauses);
     void returnClauses(const std::vector<int>& clauses);
 
@@ -140,11 +166,15 @@ private:
     void doWriteRevisions();
     void doPrepareSolution();
 
-    bool process(const std::vector<int>& clauses, BufferTask task);
+    void enqueue(const std::vector<int>& buffer, BufferTask task, int epoch = -1);
+    bool dispatch(const std::vector<int>& buffer, BufferTask task, int slot, int epoch);
+    int acquireImportSlot(const std::vector<int>& clauses);
     
     void applySolvingState();
     void doReturnClauses(const std::vector<int>& clauses);
     void initSharedMemory(SatProcessConfig&& config);
     void* createSharedMemoryBlock(std::string shmemSubId, size_t size, void* data);
+    void provideFormula(int revision, size_t size, const int* lits);
+    bool forwardIncomingFormula(int* dest, size_t& numCopied);
 
 };
@@ -25,3 +25,8 @@ std::string SatProcessConfig::getSharedMemId(pid_t pid) const {
         + std::to_string(mpirank) + ".#" + std::to_string(jobid) 
         + (recoveryIndex == 0 ? std::string() : "~" + std::to_string(recoveryIndex));
 }
+
+std::string SatProcessConfig::getSharedFormulaId(const std::string& hostKey, int revision, size_t size) const {
+    return "/edu.kit.iti.mallob.host." + hostKey + ".#" + std::to_string(jobid)
+        + ".formulae." + std::to_string(revision) + "." + std::to_string(size);
+}
@@ -42,6 +42,7 @@ struct SatProcessConfig {
     }
 
     std::string getSharedMemId(pid_t pid) const;
+    std::string getSharedFormulaId(const std::string& hostKey, int revision, size_t size) const;
 
     std::string toString() const {
         std::string out = "";
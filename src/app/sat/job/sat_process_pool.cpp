@@ -0,0 +1,159 @@
+#include "sat_process_pool.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "util/sys/shared_memory.hpp"
+#include "util/sys/process.hpp"
+#include "util/sys/proc.hpp"
+#include "util/logger.hpp"
+
+#ifndef MALLOB_SUBPROC_DISPATCH_PATH
+#define MALLOB_SUBPROC_DISPATCH_PATH ""
+#endif
+
+Mutex SatProcessPool::_mtx;
+std::list<SatProcessPool::WarmProcess> SatProcessPool::_processes;
+int SatProcessPool::_target_size = 0;
+std::string SatProcessPool::_warm_command;
+
+void SatProcessPool::init(const Parameters& params) {
+    {
+        auto lock = _mtx.getLock();
+        _target_size = params.warmProcessPoolSize();
+        if (_target_size > 0 && params.subprocessPrefix.isSet()) {
+            // A prefix (e.g., valgrind) may fork the SAT process itself, which then
+            // would not be a direct child of this process and miss its slot
+            LOG(V2_INFO, "Disable pool of warm SAT processes due to subprocess prefix\n");
+            _target_size = 0;
+        }
+        // Warm processes are launched without options, 
+        // which they receive upon being taken.
+        _warm_command = MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process -warm";
+    }
+    replenish();
+}
+
+pid_t SatProcessPool::take(const std::string& args) {
+    if (args.size() > WarmProcessSlot::MAX_ARGS_LENGTH) return -1;
+
+    auto lock = _mtx.getLock();
+    for (auto it = _processes.begin(); it != _processes.end();) {
+        auto& proc = *it;
+        if (Process::didChildExit(proc.pid)) {
+            // Process vanished: drop it
+            LOG(V1_WARN, "[WARN] Warm SAT process %ld exited unexpectedly\n", proc.pid);
+            release(proc);
+            it = _processes.erase(it);
+            continue;
+        }
+        if (!proc.slot->isReady) {
+            // Process is still starting up
+            ++it;
+            continue;
+        }
+
+        // Hand over the job's options
+        memcpy(proc.slot->args, args.data(), args.size());
+        proc.slot->argsLength = args.size();
+        proc.slot->doStart = true;
+        proc.slot->wakeup.notify();
+        pid_t pid = proc.pid;
+        // The child already mapped the slot, so its name can be removed
+        release(proc);
+        _processes.erase(it);
+        LOG(V4_VVER, "Took warm SAT process %ld\n", pid);
+        return pid;
+    }
+    return -1;
+}
+
+void SatProcessPool::replenish() {
+    auto lock = _mtx.getLock();
+    while ((int)_processes.size() < _target_size) {
+        pid_t pid = forkDispatcher();
+        addProcess(pid);
+        // The child accesses the slot only after receiving this command
+        dispatch(pid, _warm_command);
+    }
+}
+
+void SatProcessPool::adopt(pid_t childPid) {
+    auto lock = _mtx.getLock();
+    addProcess(childPid);
+}
+
+void SatProcessPool::shutdown() {
+    auto lock = _mtx.getLock();
+    _target_size = 0;
+    for (auto& proc : _processes) {
+        proc.slot->doTerminate = true;
+        proc.slot->wakeup.notify();
+        release(proc);
+    }
+    _processes.clear();
+}
+
+pid_t SatProcessPool::forkDispatcher() {
+    pid_t res = Process::createChild();
+    if (res == 0) {
+        // [child process]
+        execl(MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
+              MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
+              (char*) 0);
+        
+        // If this is reached, something went wrong with execvp
+        LOG(V0_CRIT, "[ERROR] execl returned errno %i\n", (int)errno);
+        abort();
+    }
+    return res;
+}
+
+void SatProcessPool::dispatch(pid_t childPid, const std::string& command) {
+    // Write command to tmp file
+    std::string commandOutfile = "/tmp/mallob_subproc_cmd_" + std::to_string(childPid) + "~";
+    std::ofstream ofs(commandOutfile);
+    ofs << command << " " << std::endl;
+    ofs.close();
+    std::rename(commandOutfile.c_str(), commandOutfile.substr(0, commandOutfile.size()-1).c_str()); // remove tilde
+}
+
+bool SatProcessPool::awaitStart(std::string& args) {
+    pid_t parentPid = Proc::getParentPid();
+    std::string shmemId = getSlotShmemId(parentPid, Proc::getPid());
+    auto slot = (WarmProcessSlot*) SharedMemory::access(shmemId, sizeof(WarmProcessSlot));
+    if (slot == nullptr) return false;
+
+    uint32_t epoch = slot->wakeup.getEpoch();
+    slot->isReady = true;
+    while (!slot->doStart && !slot->doTerminate) {
+        // Time out regularly to notice if the parent is gone
+        slot->wakeup.wait(epoch, 100'000);
+        epoch = slot->wakeup.getEpoch();
+        if (Proc::getParentPid() != parentPid) break;
+    }
+
+    bool start = slot->doStart && !slot->doTerminate;
+    if (start) args = std::string(slot->args, slot->argsLength);
+    munmap(slot, sizeof(WarmProcessSlot));
+    return start;
+}
+
+std::string SatProcessPool::getSlotShmemId(pid_t parentPid, pid_t childPid) {
+    return "/edu.kit.iti.mallob." + std::to_string(parentPid) + ".warm." + std::to_string(childPid);
+}
+
+void SatProcessPool::addProcess(pid_t childPid) {
+    std::string shmemId = getSlotShmemId(Proc::getPid(), childPid);
+    void* mem = SharedMemory::create(shmemId, sizeof(WarmProcessSlot));
+    WarmProcessSlot* slot = new (mem) WarmProcessSlot();
+    _processes.push_back(WarmProcess{childPid, shmemId, slot});
+}
+
+void SatProcessPool::release(WarmProcess& proc) {
+    SharedMemory::free(proc.shmemId, (char*) proc.slot, sizeof(WarmProcessSlot));
+    proc.slot = nullptr;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <sys/types.h>
+
+#include "util/params.hpp"
+#include "util/sys/futex.hpp"
+#include "util/sys/threading.hpp"
+
+// Shared memory block through which a pre-started ("warm") SAT process
+// receives the program options of the job it is supposed to solve.
+struct WarmProcessSlot {
+
+    static constexpr size_t MAX_ARGS_LENGTH = 1<<16;
+
+    Futex wakeup;
+    std::atomic_bool isReady {false}; // set by the child as soon as it listens
+    std::atomic_bool doStart {false};
+    std::atomic_bool doTerminate {false};
+    size_t argsLength {0};
+    char args[MAX_ARGS_LENGTH];
+};
+
+// Keeps a number of mallob_sat_process instances per MPI process which are
+// already forked, exec'd and loaded, waiting to be handed a job. Taking a
+// process from the pool replaces the spawn of a new process in the critical
+// path of a job's initialization; the pool is refilled afterwards.
+// Warm processes find their slot via their parent's PID, so the pool is
+// disabled if SAT processes are launched via a subprocess prefix.
+class SatProcessPool {
+
+private:
+    struct WarmProcess {
+        pid_t pid;
+        std::string shmemId;
+        WarmProcessSlot* slot;
+    };
+
+    static Mutex _mtx;
+    static std::list<WarmProcess> _processes;
+    static int _target_size;
+    static std::string _warm_command;
+
+public:
+    // Parent side
+    static void init(const Parameters& params);
+    static pid_t take(const std::string& args);
+    static void replenish();
+    static void shutdown();
+    // Registers a forked child which will call awaitStart() as a warm process.
+    static void adopt(pid_t childPid);
+
+    // Forks a process which becomes a mallob_process_dispatcher and then
+    // launches the command handed to it via dispatch(...).
+    static pid_t forkDispatcher();
+    static void dispatch(pid_t childPid, const std::string& command);
+
+    // Child side: blocks until options are handed over (true)
+    // or until the process should exit (false)
+    static bool awaitStart(std::string& args);
+
+    static std::string getSlotShmemId(pid_t parentPid, pid_t childPid);
+
+private:
+    static void addProcess(pid_t childPid);
+    static void release(WarmProcess& proc);
+};
@@ -2,44 +2,64 @@
 #pragma once
 
 #include <sys/types.h>
+#include <atomic>
 
 #include "../solvers/portfolio_solver_interface.hpp"
 #include "data/checksum.hpp"
+#include "data/formula_progress.hpp"
 #include "sat_process_config.hpp"
+#include "util/sys/futex.hpp"
 
+// Communication block between a SAT process adapter (parent) and its SAT process (child).
+// Flags are atomic since they are accessed by both processes: a party writes the
+// payload of a request or response first and then sets the according flag, and the
+// other party reads the payload only after observing the flag.
 struct SatSharedMemory {
 
+    // Number of import buffers ("slots") which the parent can fill in advance
+    // while the child is still busy. Further slots would allow to stage a buffer
+    // while the child digests a previous one, but the parent still receives each
+    // buffer as a vector, so a single slot avoids the extra shared memory.
+    static constexpr int NUM_IMPORT_SLOTS = 1;
+
     SatProcessConfig config;
 
+    // Notified by the parent after posting any instruction, which lets the child
+    // wake up immediately instead of waiting for its next periodic check
+    Futex childWakeup;
+
     // Meta data parent->child
     int fSize;
     int aSize;
     int desiredRevision;
+    // Number of literals of the initial formula present so far,
+    // less than fSize while the job description is still being received
+    FormulaProgress fAvailable;
 
     // Instructions parent->child
-    bool doBegin;
-    bool doExport;
-    bool doFilterImport;
-    bool doDigestImportWithFilter;
-    bool doDigestImportWithoutFilter;
-    bool doReturnClauses;
-    bool doDumpStats;
-    bool doStartNextRevision;
-    bool doTerminate;
-    bool doCrash;
+    std::atomic_bool doBegin;
+    std::atomic_bool doExport;
+    std::atomic_bool doFilterImport;
+    std::atomic_bool doDigestImportWithFilter;
+    std::atomic_bool doDigestImportWithoutFilter;
+    std::atomic_bool doReturnClauses;
+    std::atomic_bool doDumpStats;
+    std::atomic_bool doStartNextRevision;
+    std::atomic_bool doTerminate;
+    std::atomic_bool doCrash;
 
     // Responses child->parent
-    bool didExport;
-    bool didFilterImport;
-    bool didDigestImport;
-    bool didReturnClauses;
-    bool didDumpStats;
-    bool didStartNextRevision;
-    bool didTerminate;
+    std::atomic_bool didExport;
+    std::atomic_bool didFilterImport;
+    std::atomic_bool didDigestImport;
+    std::atomic_bool didReturnClauses;
+    std::atomic_bool didDumpStats;
+    std::atomic_bool didStartNextRevision;
+    std::atomic_bool didTerminate;
 
     // State alerts child->parent
-    bool isInitialized;
-    bool hasSolution;
+    std::atomic_bool isInitialized;
+    std::atomic_bool hasSolution;
     SatResult result;
     int solutionRevision;
     
@@ -49,6 +69,7 @@ struct SatSharedMemory {
     int importBufferMaxSize;
     int importBufferSize;
     int importBufferRevision;
+    int importBufferSlot;
     int returnedBufferSize;
     Checksum importChecksum;
     
@@ -168,7 +168,7 @@ void ThreadedSatJob::prepareSharing(int maxSize) {
     
     _clause_buffer.resize(2*maxSize+100);
     _clause_checksum = Checksum();
-    int actualSize = _solver->prepareSharing(_clause_buffer.data(), maxSize);
+    int actualSize = _solver->prepareSharing(_clause_buffer.data(), maxSize, _clause_buffer.size());
     _clause_buffer.resize(actualSize);
 }
 bool ThreadedSatJob::hasPreparedSharing() {
@@ -184,12 +184,13 @@ std::pair<int, int> ThreadedSatJob::getLastAdmittedClauseShare() {
     return _solver->getLastAdmittedClauseShare();
 }
 
-void ThreadedSatJob::filterSharing(std::vector<int>& clauses) {
+void ThreadedSatJob::filterSharing(int epoch, std::vector<int>& clauses) {
     auto maxFilterSize = clauses.size()/(8*sizeof(int))+1;
     if (_filter.size() < maxFilterSize) _filter.resize(maxFilterSize);
     int filterSize = _solver->filterSharing(clauses.data(), clauses.size(), _filter.data());
     _filter.resize(filterSize);
     _clauses_to_filter = clauses;
+    _filtered_epoch = epoch;
     _did_filter = true;
 }
 bool ThreadedSatJob::hasFilteredSharing() {
@@ -201,7 +202,12 @@ std::vector<int> ThreadedSatJob::getLocalFilter() {
     _did_filter = false;
     return filter;
 }
-void ThreadedSatJob::applyFilter(std::vector<int>& filter) {
+void ThreadedSatJob::applyFilter(int epoch, std::vector<int>& filter) {
+    if (epoch != _filtered_epoch) {
+        LOG(V1_WARN, "[WARN] %s : discard global filter of epoch %i, filtered epoch %i\n", 
+            toStr(), epoch, _filtered_epoch);
+        return;
+    }
     _solver->digestSharingWithFilter(_clauses_to_filter.data(), _clauses_to_filter.size(), filter.data());
 }
 
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <sstream>
+#include <iterator>
 #include "util/assert.hpp"
 
 #include "util/sys/timer.hpp"
@@ -17,12 +19,28 @@
 #include "data/checksum.hpp"
 #include "execution/sat_process.hpp"
 #include "util/sys/fileutils.hpp"
+#include "job/sat_process_pool.hpp"
 
 #ifndef MALLOB_VERSION
 #define MALLOB_VERSION "(dbg)"
 #endif
 
 int main(int argc, char *argv[]) {
+
+    // Pre-started process of a SatProcessPool: wait for the options of a job
+    std::vector<std::string> warmArgs;
+    std::vector<char*> warmArgv;
+    if (argc == 2 && std::string(argv[1]) == "-warm") {
+        std::string args;
+        if (!SatProcessPool::awaitStart(args)) return 0;
+        std::istringstream buffer(args);
+        warmArgs.push_back(argv[0]);
+        warmArgs.insert(warmArgs.end(), std::istream_iterator<std::string>(buffer), {});
+        for (auto& arg : warmArgs) warmArgv.push_back(arg.data());
+        warmArgv.push_back(nullptr);
+        argc = warmArgs.size();
+        argv = warmArgv.data();
+    }
     
     Parameters params;
     params.init(argc, argv);
@@ -37,7 +55,9 @@ int main(int argc, char *argv[]) {
 
     Random::init(config.mpisize, rankOfParent);
 
-    ProcessWideThreadPool::init(1);
+    // The pool helps to filter and import shared clauses concurrently,
+    // so it should be able to occupy as many cores as the solvers do
+    ProcessWideThreadPool::init(std::max(1, config.threads));
 
     // Initialize signal handlers
     Process::init(rankOfParent, params.traceDirectory(), /*leafProcess=*/true);
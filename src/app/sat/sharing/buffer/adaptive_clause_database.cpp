@@ -3,6 +3,7 @@
 
 AdaptiveClauseDatabase::AdaptiveClauseDatabase(Setup setup):
     _total_literal_limit(setup.numLiterals),
+    _arena(std::max(512, 8*(setup.maxClauseLength+1))),
     _max_lbd_partitioned_size(setup.maxLbdPartitionedSize),
     _max_clause_length(setup.maxClauseLength),
     _slots_for_sum_of_length_and_lbd(setup.slotsForSumOfLengthAndLbd),
@@ -54,8 +55,14 @@ AdaptiveClauseDatabase::AdaptiveClauseDatabase(Setup setup):
                 } else {
                     slotIdx = _large_slots.size();
                     _large_slots.emplace_back();
-                    _large_slots.back().implicitLbdOrZero = (opMode == SAME_SIZE_AND_LBD ? lbd : 0);
-                    _large_slots.back().mtx.reset(new Mutex());
+                    auto& slot = _large_slots.back();
+                    slot.implicitLbdOrZero = (opMode == SAME_SIZE_AND_LBD ? lbd : 0);
+                    if (opMode == SAME_SUM_OF_SIZE_AND_LBD) {
+                        slot.sumOfLengthAndLbd = sumOfLengthAndLbd;
+                    } else {
+                        slot.clauseLength = clauseLength;
+                    }
+                    slot.mtx.reset(new Mutex());
                 }
                 _size_lbd_to_slot_idx_mode[representantKey] = std::pair<int, ClauseSlotMode>(slotIdx, opMode);
             }
@@ -117,12 +124,10 @@ bool AdaptiveClauseDatabase::addClause(int* cBegin, int cSize, int cLbd, bool so
         // Insert clause
         auto& slot = _large_slots.at(slotIdx);
         bool explicitLbd = slot.implicitLbdOrZero == 0;
-        std::vector<int> vec(len + (explicitLbd ? 1 : 0));
-        size_t i = 0;
-        if (explicitLbd) vec[i++] = cLbd;
-        for (size_t j = 0; j < len; j++) vec[i++] = cBegin[j];
         slot.mtx->lock();
-        slot.list.push_front(std::move(vec));
+        int* record = appendRecord(slot, len + (explicitLbd ? 1 : 0));
+        memcpy(record, cBegin, len*sizeof(int));
+        if (explicitLbd) record[len] = cLbd;
         atomics::addRelaxed(slot.nbLiterals, cSize);
         assert_heavy(checkNbLiterals(slot));
         slot.mtx->unlock();
@@ -191,6 +196,39 @@ bool AdaptiveClauseDatabase::popMallobClause(Slot<T>& slot, bool giveUpOnLock, M
     return true;
 }
 
+bool AdaptiveClauseDatabase::popMallobClause(LargeSlot& slot, bool giveUpOnLock, Mallob::Clause& out) {
+    if (slot.nbLiterals.load(std::memory_order_relaxed) == 0) return false;
+    if (giveUpOnLock) {
+        if (!slot.mtx->tryLock()) return false;
+    } else {
+        slot.mtx->lock();
+    }
+    if (slot.nbLiterals.load(std::memory_order_relaxed) == 0) {
+        slot.mtx->unlock();
+        return false;
+    }
+    assert(!slot.chunks.empty());
+    int nbLiteralsBefore = slot.nbLiterals.load(std::memory_order_relaxed);
+    auto chunk = slot.chunks.back();
+    int* recordEnd = chunk->data + chunk->end;
+    auto mc = slot.getClause(recordEnd);
+    assert(mc.size <= _max_clause_length);
+    out = mc.copy(); // copy before the chunk's memory can be reused
+    chunk->end -= slot.getRecordLength(recordEnd);
+    if (chunk->empty()) {
+        slot.chunks.pop_back();
+        _arena.release(chunk);
+    }
+
+    storeGlobalBudget(mc.size);
+    _nb_used_literals.fetch_sub(mc.size, std::memory_order_relaxed);
+    atomics::subRelaxed(slot.nbLiterals, mc.size);
+
+    assert_heavy(checkNbLiterals(slot, "popMallobClause(): " + out.toStr() + "; " + std::to_string(nbLiteralsBefore) + " lits before"));
+    slot.mtx->unlock();
+    return true;
+}
+
 template <typename T>
 Mallob::Clause AdaptiveClauseDatabase::getMallobClause(T& elem, int implicitLbdOrZero) {
     if constexpr (std::is_same<int, T>::value) {
@@ -199,13 +237,6 @@ Mallob::Clause AdaptiveClauseDatabase::getMallobClause(T& elem, int implicitLbdO
     if constexpr (std::is_same<std::pair<int, int>, T>::value) {
         return Mallob::Clause(&elem.first, 2, 2);
     }
-    if constexpr (std::is_same<std::vector<int>, T>::value) {
-        bool lbdInVector = implicitLbdOrZero == 0;
-        int len = elem.size() - (lbdInVector ? 1 : 0);
-        assert(len <= _max_clause_length);
-        return Mallob::Clause(elem.data() + (lbdInVector ? 1 : 0), len, 
-            lbdInVector ? elem[0] : implicitLbdOrZero);
-    }
     abort();
 }
 
@@ -290,11 +321,131 @@ void AdaptiveClauseDatabase::flushClauses(Slot<T>& slot, bool sortClauses, Buffe
     }
 }
 
+void AdaptiveClauseDatabase::flushClauses(LargeSlot& slot, bool sortClauses, BufferBuilder& builder) {
+    
+    if (slot.nbLiterals.load(std::memory_order_relaxed) == 0
+        && slot.freeLocalBudget.load(std::memory_order_relaxed) == 0) 
+        return;
+    
+    // Detach the slot's chunks
+    std::deque<ClauseChunk*> swappedChunks;
+    int nbSwappedLits;
+    int litsToStore = 0;
+    {
+        auto lock = slot.mtx->getLock();
+
+        // Transfer local free budget to global budget, if necessary
+        int freeBudget = slot.freeLocalBudget;
+        if (freeBudget > 0) {
+            slot.freeLocalBudget.store(0, std::memory_order_relaxed);
+            litsToStore += freeBudget;
+        }
+
+        // Nothing to extract?
+        if (slot.nbLiterals.load(std::memory_order_relaxed) == 0) {
+            if (litsToStore > 0) storeGlobalBudget(litsToStore);
+            return;
+        }
+        
+        // Extract clauses
+        swappedChunks.swap(slot.chunks);
+        nbSwappedLits = slot.nbLiterals.load(std::memory_order_relaxed);
+        slot.nbLiterals.store(0, std::memory_order_relaxed);
+    }
+
+    // Uniform clauses which need no sorting can be copied chunk-wise
+    bool differentLbdValues = slot.implicitLbdOrZero == 0;
+    bool bulkCopy = !differentLbdValues && !sortClauses;
+
+    // Collect clauses from the detached chunks, newest first (back to front)
+    std::vector<Mallob::Clause> flushedClauses;
+    int remainingLits = builder.getMaxRemainingLits();
+    int collectedLits = 0;
+    size_t nbConsumedChunks = 0;
+    for (; nbConsumedChunks < swappedChunks.size(); nbConsumedChunks++) {
+        auto chunk = swappedChunks[swappedChunks.size()-1-nbConsumedChunks];
+        if (bulkCopy) {
+            int nbClauses = std::min(chunk->size(), remainingLits) / slot.clauseLength;
+            int nbLits = nbClauses * slot.clauseLength;
+            chunk->end -= nbLits;
+            bool success = builder.appendUniform(chunk->data + chunk->end, 
+                nbClauses, slot.clauseLength, slot.implicitLbdOrZero);
+            assert(success);
+            remainingLits -= nbLits;
+            collectedLits += nbLits;
+        } else {
+            while (!chunk->empty()) {
+                int* recordEnd = chunk->data + chunk->end;
+                Mallob::Clause clause = slot.getClause(recordEnd);
+                if (clause.size > remainingLits) break;
+                remainingLits -= clause.size;
+                collectedLits += clause.size;
+                flushedClauses.push_back(clause);
+                chunk->end -= slot.getRecordLength(recordEnd);
+            }
+        }
+        if (!chunk->empty()) break;
+    }
+
+    // Return budget of extracted literals
+    litsToStore += collectedLits;
+    storeGlobalBudget(litsToStore);
+    _nb_used_literals.fetch_sub(collectedLits, std::memory_order_relaxed);
+
+    if (differentLbdValues || sortClauses) {
+        // Sort
+        std::sort(flushedClauses.begin(), flushedClauses.end());
+    }
+
+    // Append clauses to buffer builder. This must happen before any partially
+    // consumed chunk is handed back to the slot: the collected clauses point
+    // into these chunks, which concurrent pops or drops may recycle.
+    for (auto& c : flushedClauses) {
+        bool success = builder.append(c);
+        assert(success);
+    }
+
+    if (collectedLits < nbSwappedLits) {
+        // Re-insert the older chunks which remained (partially) unused in front
+        // of any chunks which have been added to the slot in the meantime
+        auto lock = slot.mtx->getLock();
+        slot.chunks.insert(slot.chunks.begin(), swappedChunks.begin(), swappedChunks.end()-nbConsumedChunks);
+        atomics::addRelaxed(slot.nbLiterals, nbSwappedLits - collectedLits);
+        assert_heavy(checkNbLiterals(slot));
+    } else {
+        assert(nbSwappedLits == collectedLits || 
+            log_return_false("[ERROR] slot advertised %i lits, collected %i lits\n", 
+            nbSwappedLits, collectedLits));
+    }
+
+    // Fully consumed chunks can be recycled now that they have been read
+    _arena.release(swappedChunks.end()-nbConsumedChunks, swappedChunks.end());
+}
+
 std::vector<int> AdaptiveClauseDatabase::exportBuffer(int totalLiteralLimit, int& numExportedClauses, 
         ExportMode mode, bool sortClauses) {
 
     BufferBuilder builder(totalLiteralLimit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
+    flushAllClauses(mode, sortClauses, builder);
+    numExportedClauses = builder.getNumAddedClauses();
+    return builder.extractBuffer();
+}
+
+size_t AdaptiveClauseDatabase::exportBuffer(int* out, size_t capacity, int totalLiteralLimit, 
+        int& numExportedClauses, ExportMode mode, bool sortClauses) {
 
+    size_t overhead = BufferBuilder::getMaxOverhead(_max_clause_length, _slots_for_sum_of_length_and_lbd);
+    assert(capacity > sizeof(size_t)/sizeof(int));
+    int maxLiterals = capacity > overhead ? std::min((size_t) INT32_MAX, capacity - overhead) : 0;
+    if (totalLiteralLimit < 0 || totalLiteralLimit > maxLiterals) totalLiteralLimit = maxLiterals;
+
+    BufferBuilder builder(totalLiteralLimit, _max_clause_length, _slots_for_sum_of_length_and_lbd, out, capacity);
+    flushAllClauses(mode, sortClauses, builder);
+    numExportedClauses = builder.getNumAddedClauses();
+    return builder.size();
+}
+
+void AdaptiveClauseDatabase::flushAllClauses(ExportMode mode, bool sortClauses, BufferBuilder& builder) {
     /*
     std::string out = "lim=" + std::to_string(totalLiteralLimit) + " FREE LOCAL BUDGETS: ";
     out += std::to_string(_unit_slot.freeLocalBudget.load()) + " ";
@@ -320,9 +471,6 @@ std::vector<int> AdaptiveClauseDatabase::exportBuffer(int totalLiteralLimit, int
             flushClauses(slot, sortClauses, builder);
         }
     }
-
-    numExportedClauses = builder.getNumAddedClauses();
-    return builder.extractBuffer();
 }
 
 int AdaptiveClauseDatabase::tryAcquireBudget(int callingSlot, int numDesired, float freeingFactor) {
@@ -391,11 +539,6 @@ int AdaptiveClauseDatabase::stealBudgetFromSlot(Slot<T>& slot, int desiredLitera
                 nbCollectedLits += 2;
                 _hist_deleted_in_slots.increment(2);
             }
-            if constexpr (std::is_same<std::vector<int>, T>::value) {
-                int clslen = it->size() - (slot.implicitLbdOrZero==0 ? 1 : 0);
-                nbCollectedLits += clslen;
-                _hist_deleted_in_slots.increment(clslen);
-            }
             nbCollectedClauses++;
             ++it;
         }
@@ -422,10 +565,86 @@ int AdaptiveClauseDatabase::stealBudgetFromSlot(Slot<T>& slot, int desiredLitera
     return freeBudget + nbCollectedLits;
 }
 
+int AdaptiveClauseDatabase::stealBudgetFromSlot(LargeSlot& slot, int desiredLiterals, bool dropClauses) {
+    
+    if (slot.nbLiterals.load(std::memory_order_relaxed) == 0
+        && slot.freeLocalBudget.load(std::memory_order_relaxed) == 0) 
+        return 0;
+
+    auto lock = slot.mtx->getLock();
+    assert_heavy(checkNbLiterals(slot, "before dropClauses()"));
+    int nbLiteralsBefore = slot.nbLiterals.load(std::memory_order_relaxed);
+
+    int freeBudget = std::min(slot.freeLocalBudget.load(std::memory_order_relaxed), desiredLiterals);
+    int nbCollectedLits = 0;
+    int nbCollectedClauses = 0;
+
+    if (dropClauses) {
+        // Drop the newest clauses, recycling chunks which become empty
+        while (freeBudget + nbCollectedLits < desiredLiterals && !slot.chunks.empty()) {
+            auto chunk = slot.chunks.back();
+            int recordLength = slot.getRecordLength(chunk->data + chunk->end);
+            int clslen = recordLength - (slot.implicitLbdOrZero==0 ? 1 : 0);
+            nbCollectedLits += clslen;
+            _hist_deleted_in_slots.increment(clslen);
+            nbCollectedClauses++;
+            chunk->end -= recordLength;
+            if (chunk->empty()) {
+                slot.chunks.pop_back();
+                _arena.release(chunk);
+            }
+        }
+    }
+
+    if (freeBudget+nbCollectedLits == 0) {
+        return 0;
+    }
+    
+    atomics::subRelaxed(slot.nbLiterals, nbCollectedLits);
+    atomics::subRelaxed(slot.freeLocalBudget, freeBudget);
+    atomics::subRelaxed(_nb_used_literals, nbCollectedLits);
+
+    assert_heavy(checkNbLiterals(slot, "dropClauses(): collected " 
+        + std::to_string(nbCollectedLits) + " literals from " 
+        + std::to_string(nbCollectedClauses) + " clauses; " 
+        + std::to_string(nbLiteralsBefore) + " lits before"));
+    
+    return freeBudget + nbCollectedLits;
+}
+
+bool AdaptiveClauseDatabase::checkNbLiterals(LargeSlot& slot, std::string additionalInfo) {
+
+    int nbAdvertised = slot.nbLiterals.load(std::memory_order_relaxed);
+    int nbActual = 0;
+    for (auto chunk : slot.chunks) {
+        for (int pos = chunk->end; pos > 0;) {
+            int recordLength = slot.getRecordLength(chunk->data + pos);
+            nbActual += recordLength - (slot.implicitLbdOrZero==0 ? 1 : 0);
+            pos -= recordLength;
+        }
+    }
+    if (nbAdvertised != nbActual) 
+        LOG(V0_CRIT, "[ERROR] Slot advertised %i literals - found %i literals (%s)\n", 
+            nbAdvertised, nbActual, additionalInfo.c_str());
+    return nbAdvertised == nbActual;
+}
+
 BufferReader AdaptiveClauseDatabase::getBufferReader(int* begin, size_t size, bool useChecksums) {
     return BufferReader(begin, size, _max_clause_length, _slots_for_sum_of_length_and_lbd, useChecksums);
 }
 
+BufferReader AdaptiveClauseDatabase::getEncodedBufferReader(int* begin, size_t size, bool useChecksums) {
+    return BufferReader(begin, size, _max_clause_length, _slots_for_sum_of_length_and_lbd, useChecksums, /*encoded=*/true);
+}
+
+ClauseBufferCodec AdaptiveClauseDatabase::getBufferCodec() {
+    return ClauseBufferCodec(_max_clause_length, _slots_for_sum_of_length_and_lbd);
+}
+
+BufferSegmenter AdaptiveClauseDatabase::getBufferSegmenter(int nbSegments) {
+    return BufferSegmenter(_max_clause_length, _slots_for_sum_of_length_and_lbd, nbSegments);
+}
+
 BufferMerger AdaptiveClauseDatabase::getBufferMerger(int sizeLimit) {
     return BufferMerger(sizeLimit, _max_clause_length, _slots_for_sum_of_length_and_lbd, _use_checksum);
 }
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <deque>
 #include <forward_list>
 #include <memory>
 #include <numeric>
@@ -10,6 +11,8 @@
 #include "bucket_label.hpp"
 #include "buffer_reader.hpp"
 #include "buffer_merger.hpp"
+#include "buffer_segmenter.hpp"
+#include "clause_arena.hpp"
 #include "util/periodic_event.hpp"
 #include "../../data/solver_statistics.hpp"
 
@@ -18,6 +21,8 @@ Buffering structure for clauses which sorts and prioritizes clauses
 by length (primary) and LBD score (secondary). The structure is adaptive
 because memory chunks of fixed size are allocated on demand and
 can be moved freely from one length-LBD slot to another as necessary.
+Clauses of length > 2 are stored back-to-back in literal chunks drawn 
+from a per-database ClauseArena.
 */
 class AdaptiveClauseDatabase {
 
@@ -33,10 +38,7 @@ private:
             : clauseSizeIncludingLbd(clauseSizeIncludingLbd) {}
         bool operator()(const int* left, const int* right) const {
             if (left == right) return false;
-            for (size_t i = 0; i < clauseSizeIncludingLbd; i++) {
-                if (left[i] != right[i]) return left[i] < right[i];
-            }
-            return false;
+            return Mallob::kernels::compare(left, right, clauseSizeIncludingLbd) < 0;
         }
     };
 
@@ -49,10 +51,7 @@ private:
             int sizeLeft = sumOfLengthAndLbd - left[0] + 1;
             int sizeRight = sumOfLengthAndLbd - right[0] + 1;
             if (sizeLeft != sizeRight) return sizeLeft < sizeRight;
-            for (size_t i = 0; i < sizeLeft; i++) {
-                if (left[i] != right[i]) return left[i] < right[i];
-            }
-            return false;
+            return Mallob::kernels::compare(left, right, sizeLeft) < 0;
         }
     };
 
@@ -75,9 +74,46 @@ private:
             list(other.list) {}
     };
 
+    // Slot for clauses of length > 2. Each clause is stored as a record
+    // lit_1 ... lit_k [LBD (if not implicit)] in a sequence of arena chunks.
+    // Like units and binaries, the records are kept in LIFO order: they are
+    // appended at the back and popped, exported and dropped from the back.
+    // The LBD trails the literals so that records can be read backwards.
+    struct LargeSlot {
+        int implicitLbdOrZero;
+        int clauseLength {0}; // 0 if clauses in this slot differ in length
+        int sumOfLengthAndLbd {0}; // relevant if clauseLength == 0
+        std::atomic_int nbLiterals {0};
+        std::atomic_int freeLocalBudget {0};
+        std::shared_ptr<Mutex> mtx;
+        std::deque<ClauseChunk*> chunks;
+        LargeSlot() = default;
+        LargeSlot(LargeSlot&& other) :
+            implicitLbdOrZero(other.implicitLbdOrZero),
+            clauseLength(other.clauseLength),
+            sumOfLengthAndLbd(other.sumOfLengthAndLbd),
+            nbLiterals(other.nbLiterals.load(std::memory_order_relaxed)), 
+            freeLocalBudget(other.freeLocalBudget.load(std::memory_order_relaxed)), 
+            mtx(std::move(other.mtx)),
+            chunks(std::move(other.chunks)) {}
+
+        // Length of the record which ends right before recordEnd
+        inline int getRecordLength(const int* recordEnd) const {
+            if (implicitLbdOrZero != 0) return clauseLength;
+            return 1 + (clauseLength > 0 ? clauseLength : sumOfLengthAndLbd - recordEnd[-1]);
+        }
+        // Clause of the record which ends right before recordEnd
+        inline Mallob::Clause getClause(int* recordEnd) const {
+            int recordLength = getRecordLength(recordEnd);
+            if (implicitLbdOrZero != 0) return Mallob::Clause(recordEnd-recordLength, clauseLength, implicitLbdOrZero);
+            return Mallob::Clause(recordEnd-recordLength, recordLength-1, recordEnd[-1]);
+        }
+    };
+
     Slot<int> _unit_slot;
     Slot<std::pair<int, int>> _binary_slot;
-    std::vector<Slot<std::vector<int>>> _large_slots;
+    ClauseArena _arena;
+    std::vector<LargeSlot> _large_slots;
     
     enum ClauseSlotMode {SAME_SUM_OF_SIZE_AND_LBD, SAME_SIZE, SAME_SIZE_AND_LBD};
     robin_hood::unordered_flat_map<std::pair<int, int>, std::pair<int, ClauseSlotMode>, IntPairHasher> _size_lbd_to_slot_idx_mode;
@@ -153,7 +189,6 @@ public:
 
         atomics::addRelaxed(_nb_used_literals, nbLiterals);
         float timeInsert = Timer::elapsedSeconds();
-        T& clause = clauses.front();
 
         if constexpr (std::is_same<T, int>::value) {
             auto lock = _unit_slot.mtx->getLock();
@@ -167,16 +202,38 @@ public:
             assert_heavy(checkNbLiterals(_binary_slot));
         } else if constexpr (std::is_same<T, std::vector<int>>::value) {
             auto& slot = _large_slots[slotIdx];
-            if (slot.implicitLbdOrZero == 0) {
-                // Explicit LBD
-                assert(clause.size() == cSize+1);
-                assert(clause[0] == cLbd);
-            } else {
-                // Implicit LBD
-                assert(clause.size() == cSize);
+            auto lock = slot.mtx->getLock();
+            for (auto& vec : clauses) {
+                if (slot.implicitLbdOrZero == 0) {
+                    // Explicit LBD
+                    assert(vec.size() == cSize+1);
+                    assert(vec[0] == cLbd);
+                } else {
+                    // Implicit LBD
+                    assert(vec.size() == cSize);
+                }
+                int* record = appendRecord(slot, vec.size());
+                if (slot.implicitLbdOrZero == 0) {
+                    memcpy(record, vec.data()+1, cSize*sizeof(int));
+                    record[cSize] = vec[0];
+                } else memcpy(record, vec.data(), vec.size()*sizeof(int));
             }
+            clauses.clear();
+            atomics::addRelaxed(slot.nbLiterals, nbLiterals);
+            assert_heavy(checkNbLiterals(slot));
+        } else if constexpr (std::is_same<T, Mallob::Clause>::value) {
+            // Clauses reference external memory (e.g., a received buffer)
+            // and are copied directly into the slot
+            auto& slot = _large_slots[slotIdx];
             auto lock = slot.mtx->getLock();
-            slot.list.splice_after(slot.list.before_begin(), clauses);
+            bool explicitLbd = slot.implicitLbdOrZero == 0;
+            for (auto& c : clauses) {
+                assert(c.size == cSize);
+                int* record = appendRecord(slot, c.size + (explicitLbd ? 1 : 0));
+                memcpy(record, c.begin, c.size*sizeof(int));
+                if (explicitLbd) record[c.size] = c.lbd;
+            }
+            clauses.clear();
             atomics::addRelaxed(slot.nbLiterals, nbLiterals);
             assert_heavy(checkNbLiterals(slot));
         }
@@ -202,6 +259,11 @@ public:
     */
     std::vector<int> exportBuffer(int sizeLimit, int& numExportedClauses, 
             ExportMode mode = ANY, bool sortClauses = true);
+    // Same as above, but writes the buffer directly to the given memory region
+    // which can hold the given number of integers; the size limit is reduced
+    // as necessary for the buffer to fit. Returns the size of the written buffer.
+    size_t exportBuffer(int* out, size_t capacity, int sizeLimit, int& numExportedClauses, 
+            ExportMode mode = ANY, bool sortClauses = true);
 
     bool popFrontWeak(ExportMode mode, Mallob::Clause& out);
 
@@ -212,6 +274,10 @@ public:
     Throughout the life time of the BufferReader, the underlying vector must be valid.
     */
     BufferReader getBufferReader(int* begin, size_t size, bool useChecksums = false);
+    // Same as getBufferReader for a buffer encoded via getBufferCodec().
+    BufferReader getEncodedBufferReader(int* begin, size_t size, bool useChecksums = false);
+    ClauseBufferCodec getBufferCodec();
+    BufferSegmenter getBufferSegmenter(int nbSegments);
     BufferMerger getBufferMerger(int sizeLimit);
     BufferBuilder getBufferBuilder(std::vector<int>* out = nullptr);
 
@@ -264,27 +330,41 @@ private:
             if constexpr (std::is_same<std::pair<int, int>, T>::value) {
                 nbActual += 2;
             }
-            if constexpr (std::is_same<std::vector<int>, T>::value) {
-                nbActual += elem.size() - (slot.implicitLbdOrZero==0 ? 1:0);
-            }
         }
         if (nbAdvertised != nbActual) 
             LOG(V0_CRIT, "[ERROR] Slot advertised %i literals - found %i literals (%s)\n", 
                 nbAdvertised, nbActual, additionalInfo.c_str());
         return nbAdvertised == nbActual;
     }
+    bool checkNbLiterals(LargeSlot& slot, std::string additionalInfo = "");
+
+    // Reserves space for a record of the given length at the back of the slot.
+    // The slot's lock must be held.
+    int* appendRecord(LargeSlot& slot, int recordLength) {
+        if (slot.chunks.empty() || slot.chunks.back()->remainingCapacity() < recordLength) {
+            slot.chunks.push_back(_arena.acquire());
+        }
+        auto chunk = slot.chunks.back();
+        int* record = chunk->data + chunk->end;
+        chunk->end += recordLength;
+        return record;
+    }
 
     template <typename T>
     bool popMallobClause(Slot<T>& slot, bool giveUpOnLock, Mallob::Clause& out);
+    bool popMallobClause(LargeSlot& slot, bool giveUpOnLock, Mallob::Clause& out);
 
     template <typename T>
     Mallob::Clause getMallobClause(T& elem, int implicitLbdOrZero);
 
     template <typename T>
     int stealBudgetFromSlot(Slot<T>& slot, int desiredLiterals, bool dropClauses);
+    int stealBudgetFromSlot(LargeSlot& slot, int desiredLiterals, bool dropClauses);
 
+    void flushAllClauses(ExportMode mode, bool sortClauses, BufferBuilder& builder);
     template <typename T>
     void flushClauses(Slot<T>& slot, bool sortClauses, BufferBuilder& builder);
+    void flushClauses(LargeSlot& slot, bool sortClauses, BufferBuilder& builder);
     
     std::pair<int, ClauseSlotMode> getSlotIdxAndMode(int clauseSize, int lbd);
     BucketLabel getBucketIterator();
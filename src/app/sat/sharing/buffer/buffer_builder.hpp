@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstring>
 #include <vector>
 
 #include "buffer_iterator.hpp"
@@ -13,6 +14,11 @@ private:
     std::vector<int>* _out;
     bool _owning_vector = false;
 
+    // Alternatively, the buffer is written to a raw memory region
+    int* _raw_out = nullptr;
+    size_t _raw_size = 0;
+    size_t _raw_capacity = 0;
+
     int _total_literal_limit;
     int _counter_position;
     BufferIterator _it;
@@ -29,12 +35,17 @@ public:
             _out = new std::vector<int>();
             _owning_vector = true;
         }
-
-        for (int i = 0; i < sizeof(size_t)/sizeof(int); i++) _out->push_back(0);
-        *((size_t*) _out->data()) = 1;
-        _counter_position = _out->size();
-        _out->push_back(0); // counter for the first group
         if (totalLiteralLimit > 0) _out->reserve(totalLiteralLimit);
+        writeHeader();
+    }
+    // Writes the buffer directly to the provided memory region, which must be able
+    // to hold totalLiteralLimit literals plus getMaxOverhead() integers.
+    BufferBuilder(int totalLiteralLimit, int maxClauseLength, bool slotsForSumOfLengthAndLbd, int* out, size_t capacity) :
+        _out(nullptr), _raw_out(out), _raw_capacity(capacity), _total_literal_limit(totalLiteralLimit), 
+        _it(maxClauseLength, slotsForSumOfLengthAndLbd) {
+
+        if (_total_literal_limit < 0) _total_literal_limit = INT32_MAX;
+        writeHeader();
     }
     ~BufferBuilder() {
         if (_owning_vector && _out != nullptr) delete _out;
@@ -50,20 +61,44 @@ public:
         int numSwitches = 0;
         while (c.size != _it.clauseLength || c.lbd != _it.lbd) {
             numSwitches++;
-            _counter_position = _out->size();
-            _out->push_back(0); // counter
+            _counter_position = size();
+            pushBack(0); // counter
             _it.nextLengthLbdGroup();
             assert(_it.clauseLength <= 255);
         }
 
-        (*_out)[_counter_position]++;
+        at(_counter_position)++;
         assert(c.begin != nullptr);
-        _out->insert(_out->end(), c.begin, c.begin+c.size);
+        pushBack(c.begin, c.begin+c.size);
         _num_added_lits += c.size;
         _num_added_clauses++;
         return true;
     }
 
+    // Appends a number of clauses of uniform length and LBD which are 
+    // given as a contiguous sequence of literals. Returns false (and appends
+    // nothing) if the clauses do not fit into the buffer.
+    bool appendUniform(const int* lits, int nbClauses, int clauseLength, int lbd) {
+
+        int nbLits = nbClauses * clauseLength;
+        if (_total_literal_limit >= 0 && _num_added_lits + nbLits > _total_literal_limit) 
+            return false;
+        if (nbClauses == 0) return true;
+
+        while (clauseLength != _it.clauseLength || lbd != _it.lbd) {
+            _counter_position = size();
+            pushBack(0); // counter
+            _it.nextLengthLbdGroup();
+            assert(_it.clauseLength <= 255);
+        }
+
+        at(_counter_position) += nbClauses;
+        pushBack(lits, lits+nbLits);
+        _num_added_lits += nbLits;
+        _num_added_clauses += nbClauses;
+        return true;
+    }
+
     int getNumAddedClauses() const {
         return _num_added_clauses;
     }
@@ -76,7 +111,50 @@ public:
         return _total_literal_limit - _num_added_lits;
     }
 
+    // Current size of the buffer in integers
+    size_t size() const {
+        return _raw_out != nullptr ? _raw_size : _out->size();
+    }
+
     std::vector<int>&& extractBuffer() {
+        assert(_raw_out == nullptr);
         return std::move(*_out);
     }
+
+    // Max. number of integers in a buffer beyond its literals (header and bucket counters)
+    static size_t getMaxOverhead(int maxClauseLength, bool slotsForSumOfLengthAndLbd) {
+        size_t nbBuckets = 0;
+        BufferIterator it(maxClauseLength, slotsForSumOfLengthAndLbd);
+        while (it.clauseLength <= maxClauseLength) {
+            nbBuckets++;
+            it.nextLengthLbdGroup();
+        }
+        return sizeof(size_t)/sizeof(int) + nbBuckets;
+    }
+
+private:
+    void writeHeader() {
+        for (int i = 0; i < sizeof(size_t)/sizeof(int); i++) pushBack(0);
+        size_t one = 1;
+        memcpy(&at(0), &one, sizeof(size_t));
+        _counter_position = size();
+        pushBack(0); // counter for the first group
+    }
+
+    inline int& at(size_t pos) {
+        return _raw_out != nullptr ? _raw_out[pos] : (*_out)[pos];
+    }
+    inline void pushBack(int x) {
+        if (_raw_out != nullptr) {
+            assert(_raw_size < _raw_capacity);
+            _raw_out[_raw_size++] = x;
+        } else _out->push_back(x);
+    }
+    inline void pushBack(const int* begin, const int* end) {
+        if (_raw_out != nullptr) {
+            assert(_raw_size + (end-begin) <= _raw_capacity);
+            memcpy(_raw_out+_raw_size, begin, (end-begin)*sizeof(int));
+            _raw_size += end-begin;
+        } else _out->insert(_out->end(), begin, end);
+    }
 };
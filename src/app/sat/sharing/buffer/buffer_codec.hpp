@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "buffer_iterator.hpp"
+#include "util/assert.hpp"
+
+/*
+Compact wire format for flat clause buffers (as produced by exportBuffer
+or a BufferMerger). The checksum header is kept as is, followed by the number
+of encoded bytes and the byte stream itself (padded to full integers).
+For each bucket, the byte stream contains the number of clauses and then each
+clause as zigzag varints: the first literal relative to the first literal of
+the preceding clause in the bucket, each further literal relative to its
+predecessor. Since clauses are sorted within buckets and literals are sorted
+within clauses, most differences fit into one or two bytes.
+Encoded buffers can be decoded in full (decode) or read lazily via a BufferReader
+constructed with encoded=true.
+*/
+class ClauseBufferCodec {
+
+private:
+    int _max_clause_length;
+    bool _slots_for_sum_of_length_and_lbd;
+
+public:
+    static constexpr int HEADER_INTS = sizeof(size_t)/sizeof(int);
+
+    ClauseBufferCodec(int maxClauseLength, bool slotsForSumOfLengthAndLbd) :
+        _max_clause_length(maxClauseLength), _slots_for_sum_of_length_and_lbd(slotsForSumOfLengthAndLbd) {}
+
+    std::vector<int> encode(const int* buffer, size_t size) const {
+
+        std::vector<int> out(HEADER_INTS+1, 0);
+        if (size <= HEADER_INTS) {
+            out.resize(size);
+            for (size_t i = 0; i < size; i++) out[i] = buffer[i];
+            return out;
+        }
+        for (size_t i = 0; i < HEADER_INTS; i++) out[i] = buffer[i];
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(2*sizeof(int)*size);
+        BufferIterator it(_max_clause_length, _slots_for_sum_of_length_and_lbd);
+        size_t pos = HEADER_INTS;
+        bool firstBucket = true;
+        while (pos < size) {
+            if (!firstBucket) it.nextLengthLbdGroup();
+            firstBucket = false;
+            int nbClauses = buffer[pos++];
+            // Only write as many clauses as are fully contained in the buffer
+            nbClauses = std::min((size_t)nbClauses, (size - pos) / it.clauseLength);
+            writeVarint(bytes, nbClauses);
+            int64_t prevFirst = 0;
+            for (int c = 0; c < nbClauses; c++) {
+                const int* lits = buffer+pos;
+                writeVarint(bytes, zigzag((int64_t)lits[0] - prevFirst));
+                for (int i = 1; i < it.clauseLength; i++)
+                    writeVarint(bytes, zigzag((int64_t)lits[i] - lits[i-1]));
+                prevFirst = lits[0];
+                pos += it.clauseLength;
+            }
+        }
+
+        out[HEADER_INTS] = bytes.size();
+        out.resize(HEADER_INTS + 1 + (bytes.size()+sizeof(int)-1)/sizeof(int), 0);
+        memcpy(out.data()+HEADER_INTS+1, bytes.data(), bytes.size());
+        return out;
+    }
+
+    std::vector<int> decode(const int* buffer, size_t size) const {
+
+        std::vector<int> out(buffer, buffer + std::min(size, (size_t)HEADER_INTS));
+        if (size <= HEADER_INTS) return out;
+
+        const uint8_t* bytes = (const uint8_t*) (buffer+HEADER_INTS+1);
+        size_t nbBytes = buffer[HEADER_INTS];
+        assert(HEADER_INTS+1 + (nbBytes+sizeof(int)-1)/sizeof(int) <= size);
+        out.reserve(2*nbBytes);
+        BufferIterator it(_max_clause_length, _slots_for_sum_of_length_and_lbd);
+        size_t pos = 0;
+        bool firstBucket = true;
+        while (pos < nbBytes) {
+            if (!firstBucket) it.nextLengthLbdGroup();
+            firstBucket = false;
+            int nbClauses = readVarint(bytes, pos);
+            out.push_back(nbClauses);
+            int64_t prevFirst = 0;
+            for (int c = 0; c < nbClauses; c++) {
+                int lit = prevFirst + unzigzag(readVarint(bytes, pos));
+                prevFirst = lit;
+                out.push_back(lit);
+                for (int i = 1; i < it.clauseLength; i++) {
+                    lit += unzigzag(readVarint(bytes, pos));
+                    out.push_back(lit);
+                }
+            }
+        }
+        return out;
+    }
+
+    static inline uint64_t zigzag(int64_t x) {
+        return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63);
+    }
+    static inline int64_t unzigzag(uint64_t x) {
+        return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);
+    }
+    static inline void writeVarint(std::vector<uint8_t>& out, uint64_t x) {
+        while (x >= 0x80) {
+            out.push_back((uint8_t) (x | 0x80));
+            x >>= 7;
+        }
+        out.push_back((uint8_t) x);
+    }
+    static inline uint64_t readVarint(const uint8_t* bytes, size_t& pos) {
+        uint64_t x = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = bytes[pos++];
+            x |= (uint64_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return x;
+    }
+};
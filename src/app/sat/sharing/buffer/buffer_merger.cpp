@@ -4,46 +4,54 @@
 #include "buffer_merger.hpp"
 
 BufferMerger::BufferMerger(int sizeLimit, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum) : 
-    _size_limit(sizeLimit), _max_clause_length(maxClauseLength), 
+    _size_limit(sizeLimit), _excess_size_limit(sizeLimit), _max_clause_length(maxClauseLength), 
     _slots_for_sum_of_length_and_lbd(slotsForSumOfLengthAndLbd), _use_checksum(useChecksum) {}
 
 void BufferMerger::add(BufferReader&& reader) {_readers.push_back(std::move(reader));}
 
 std::vector<int> BufferMerger::merge(std::vector<int>* excessClauses) {
-    
-    AbstractClauseThreewayComparator* threewayCompare = _slots_for_sum_of_length_and_lbd ?
-        (AbstractClauseThreewayComparator*) new LengthLbdSumClauseThreewayComparator(_max_clause_length+2) :
-        (AbstractClauseThreewayComparator*) new LexicographicClauseThreewayComparator();
-    ClauseComparator compare(threewayCompare);
-    InputClauseComparator inputCompare(threewayCompare);
-
-    // Setup readers
-    for (size_t i = 0; i < _readers.size(); i++) {
+    if (_slots_for_sum_of_length_and_lbd) {
+        return merge(LengthLbdSumClauseThreewayComparator(_max_clause_length+2), excessClauses);
+    } else {
+        return merge(LexicographicClauseThreewayComparator(), excessClauses);
+    }
+}
+
+template <typename Comparator>
+int BufferMerger::buildTree(const Comparator& compare, int node) {
+    if (node >= _num_leaves) return node - _num_leaves;
+    int left = buildTree(compare, 2*node);
+    int right = buildTree(compare, 2*node+1);
+    if (precedes(compare, left, right)) {
+        _losers[node] = right;
+        return left;
+    } else {
+        _losers[node] = left;
+        return right;
+    }
+}
+
+template <typename Comparator>
+std::vector<int> BufferMerger::merge(const Comparator& compare, std::vector<int>* excessClauses) {
 
-        // Fetch first clause of this reader
-        Clause* c = _readers[i].getCurrentClausePointer();
+    // Setup readers: fetch first clause of each reader
+    _num_leaves = 1;
+    while (_num_leaves < (int) _readers.size()) _num_leaves *= 2;
+    _heads.assign(_num_leaves, &_exhausted_clause);
+    for (size_t i = 0; i < _readers.size(); i++) {
+        _heads[i] = _readers[i].getCurrentClausePointer();
         _readers[i].getNextIncomingClause();
-        if (c->begin == nullptr) continue;
-        InputClause inputClause(c, i);
-
-        // Insert clause into merger
-        if (_merger.empty()) _merger.insert_after(_merger.before_begin(), inputClause);
-        else {
-            auto it = _merger.before_begin(); 
-            auto nextIt = it; ++nextIt;
-            while (nextIt != _merger.end() && inputCompare(inputClause, *nextIt)) {
-                ++it;
-                ++nextIt;
-            }
-            _merger.insert_after(it, inputClause);
-        }
     }
 
+    // Play initial tournament
+    _losers.assign(_num_leaves, -1);
+    _winner = buildTree(compare, 1);
+
     // Setup builders for main buffer and excess clauses buffer
     BufferBuilder mainBuilder(_size_limit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
-    BufferBuilder* excessBuilder;
+    BufferBuilder* excessBuilder = nullptr;
     if (excessClauses != nullptr) {
-        excessBuilder = new BufferBuilder(_size_limit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
+        excessBuilder = new BufferBuilder(_excess_size_limit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
     }
     BufferBuilder* currentBuilder = &mainBuilder;
 
@@ -51,58 +59,55 @@ std::vector<int> BufferMerger::merge(std::vector<int>* excessClauses) {
     Clause lastSeenClause;
 
     // Merge rounds
-    while (!_merger.empty()) {
+    while (_heads[_winner]->begin != nullptr) {
 
         // Fetch next best clause
-        auto& [clause, readerId] = _merger.front();
+        int readerId = _winner;
+        Clause* clause = _heads[readerId];
         
         // Duplicate?
-        if (lastSeenClause.begin == nullptr || compare(lastSeenClause, *clause)) {
+        if (lastSeenClause.begin == nullptr || compare.compare(lastSeenClause, *clause) < 0) {
             // -- not a duplicate
             lastSeenClause = *clause;
 
             // Try to append to current builder
             bool success = currentBuilder->append(lastSeenClause);
-            if (!success && currentBuilder == &mainBuilder) {
+            if (!success && currentBuilder == &mainBuilder) _exceeded_size_limit = true;
+            if (!success && currentBuilder == &mainBuilder && excessBuilder != nullptr) {
                 // Switch from normal output to excess clauses output
                 currentBuilder = excessBuilder;
                 success = currentBuilder->append(lastSeenClause);
             }
         } else {
             // Duplicate!
-            assert(!compare(*clause, lastSeenClause) || 
+            assert(compare.compare(*clause, lastSeenClause) >= 0 || 
                 log_return_false("ERROR: Clauses unordered - %s <-> %s\n", 
                 clause->toStr().c_str(), lastSeenClause.toStr().c_str()));
+            // Refer to the most recent (equal) clause: Readers which decode
+            // clauses on the fly only keep their previous clause valid.
+            lastSeenClause = *clause;
         }
 
-        // Refill merger
+        // Refill merger (the reader updates its clause in place)
+        // and replay the tournament along the path of this reader's leaf
         _readers[readerId].getNextIncomingClause();
-        if (clause->begin == nullptr) {
-            // No clauses left for this reader
-            _merger.erase_after(_merger.before_begin());
-        } else {
-            // Insert clause at the correct position in the merger
-            auto it = _merger.begin(); 
-            auto nextIt = it; ++nextIt;
-            while (nextIt != _merger.end() && inputCompare(_merger.front(), *nextIt)) {
-                ++it;
-                ++nextIt;
+        int winner = readerId;
+        for (int node = (readerId + _num_leaves) / 2; node >= 1; node /= 2) {
+            if (precedes(compare, _losers[node], winner)) {
+                std::swap(_losers[node], winner);
             }
-            if (it != _merger.begin()) {
-                // Move element
-                auto elem = _merger.front();
-                _merger.erase_after(_merger.before_begin());
-                _merger.insert_after(it, elem);
-            } // Else: element is already at the right place
         }
+        _winner = winner;
     }
 
+    _num_merged_lits = mainBuilder.getNumAddedLits();
+
     // Fill provided excess clauses buffer with result from according builder
     if (excessClauses != nullptr) {
+        _num_excess_lits = excessBuilder->getNumAddedLits();
         *excessClauses = excessBuilder->extractBuffer();
         delete excessBuilder;
     }
 
-    delete threewayCompare;
     return mainBuilder.extractBuffer();
 }
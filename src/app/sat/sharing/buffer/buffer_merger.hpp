@@ -2,8 +2,6 @@
 #pragma once
 
 #include <vector>
-#include <set>
-#include <forward_list>
 
 #include "buffer_builder.hpp"
 #include "buffer_reader.hpp"
@@ -13,33 +11,53 @@ class BufferMerger {
     
 private:
     int _size_limit;
+    int _excess_size_limit;
     int _max_clause_length;
     int _slots_for_sum_of_length_and_lbd;
 
     bool _use_checksum;
     std::vector<BufferReader> _readers;
 
-    std::vector<Clause> _next_clauses;
-    std::vector<bool> _selected;
-
-    typedef std::pair<Clause*, int> InputClause;
-    struct InputClauseComparator {
-        AbstractClauseThreewayComparator* compare;
-        InputClauseComparator(AbstractClauseThreewayComparator* compare) : compare(compare) {}
-        bool operator()(const InputClause& left, const InputClause& right) const {
-            int res = compare->compare(*left.first, *right.first);
-            if (res != 0) return res > 0;
-            if (left.second != right.second) return left.second < right.second;
-            return false;
-        }
-    };
-    std::forward_list<InputClause> _merger;
+    // Tournament tree of losers over the readers' current clauses:
+    // _losers[1.._num_leaves-1] hold reader indices, _winner the reader
+    // with the overall best current clause. Leaves >= #readers are empty.
+    int _num_leaves;
+    std::vector<int> _losers;
+    int _winner;
+    std::vector<Clause*> _heads;
+    Clause _exhausted_clause;
+
+    int _num_merged_lits = 0;
+    int _num_excess_lits = 0;
+    bool _exceeded_size_limit = false;
 
 public:
     BufferMerger(int sizeLimit, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum = false);
     void add(BufferReader&& reader);
+    // Limit for the excess clauses buffer (default: same as main buffer)
+    void setExcessSizeLimit(int excessSizeLimit) {_excess_size_limit = excessSizeLimit;}
     std::vector<int> merge(std::vector<int>* excessClauses = nullptr);
+    int getNumMergedLiterals() const {return _num_merged_lits;}
+    int getNumExcessLiterals() const {return _num_excess_lits;}
+    bool hasExceededSizeLimit() const {return _exceeded_size_limit;}
     
 private:
-    std::vector<int> fastMerge(int sizeLimit, std::vector<int>* excessClauses = nullptr);
+    // The comparator is a template parameter such that the comparisons
+    // in the hot loop are resolved (and inlined) at compile time.
+    template <typename Comparator>
+    std::vector<int> merge(const Comparator& compare, std::vector<int>* excessClauses);
+
+    template <typename Comparator>
+    inline bool precedes(const Comparator& compare, int left, int right) const {
+        const Clause& l = *_heads[left];
+        const Clause& r = *_heads[right];
+        if (l.begin == nullptr) return false;
+        if (r.begin == nullptr) return true;
+        int res = compare.compare(l, r);
+        if (res != 0) return res < 0;
+        return left < right;
+    }
+
+    template <typename Comparator>
+    int buildTree(const Comparator& compare, int node);
 };
@@ -2,8 +2,10 @@
 #include "buffer_reader.hpp"
 #include "util/logger.hpp"
 
-BufferReader::BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum) : 
-        _buffer(buffer), _size(size), _it(maxClauseLength, slotsForSumOfLengthAndLbd), _use_checksum(useChecksum) {
+BufferReader::BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, 
+        bool useChecksum, bool encoded) : 
+        _buffer(buffer), _size(size), _it(maxClauseLength, slotsForSumOfLengthAndLbd), _use_checksum(useChecksum),
+        _encoded(encoded) {
     
     int numInts = sizeof(size_t)/sizeof(int);
     if (_use_checksum && _size > 0) {
@@ -12,14 +14,76 @@ BufferReader::BufferReader(int* buffer, int size, int maxClauseLength, bool slot
         memcpy(&_true_hash, _buffer, sizeof(size_t));
     }
 
+    if (_encoded) {
+        _hash = 1;
+        _current_clause.size = _it.clauseLength;
+        _current_clause.lbd = _it.lbd;
+        _slot_size = std::max(1, maxClauseLength);
+        _decoded_slots.resize(2*_slot_size);
+        if (_size <= numInts) {
+            _remaining_cls_of_bucket = 0;
+            return;
+        }
+        _nb_bytes = _buffer[numInts];
+        assert(numInts+1 + (_nb_bytes+sizeof(int)-1)/sizeof(int) <= _size);
+        _bytes = (const uint8_t*) (_buffer+numInts+1);
+        _remaining_cls_of_bucket = _nb_bytes == 0 ? 0 : ClauseBufferCodec::readVarint(_bytes, _byte_pos);
+        return;
+    }
+
+    assert(_size <= numInts || _buffer[numInts] >= 0);
     _remaining_cls_of_bucket = _size <= numInts ? 0 : _buffer[numInts];
-    assert(_remaining_cls_of_bucket >= 0);
     _current_pos = numInts+1;
     _hash = 1;
     _current_clause.size = _it.clauseLength;
     _current_clause.lbd = _it.lbd;
 }
 
+const Mallob::Clause& BufferReader::getNextEncodedClause() {
+
+    // Find first bucket with some clauses left
+    if (_remaining_cls_of_bucket == 0) {
+        do {
+            if (_byte_pos >= _nb_bytes) return endReading();
+            _it.nextLengthLbdGroup();
+            _remaining_cls_of_bucket = ClauseBufferCodec::readVarint(_bytes, _byte_pos);
+        } while (_remaining_cls_of_bucket == 0);
+        _current_clause.size = _it.clauseLength;
+        _current_clause.lbd = _it.lbd;
+        _prev_first_lit = 0;
+    }
+
+    if (_current_clause.size > _slot_size) {
+        LOG(V0_CRIT, "ERROR: Encoded clause of length %i exceeds max. length %i!\n", 
+            _current_clause.size, _slot_size);
+        abort();
+    }
+
+    // Decode clause into the next slot
+    int* lits = _decoded_slots.data() + _decoded_slot_idx * _slot_size;
+    _decoded_slot_idx ^= 1;
+    int lit = _prev_first_lit + ClauseBufferCodec::unzigzag(ClauseBufferCodec::readVarint(_bytes, _byte_pos));
+    _prev_first_lit = lit;
+    lits[0] = lit;
+    for (int i = 1; i < _current_clause.size; i++) {
+        lit += ClauseBufferCodec::unzigzag(ClauseBufferCodec::readVarint(_bytes, _byte_pos));
+        lits[i] = lit;
+    }
+    if (_byte_pos > _nb_bytes) {
+        LOG(V0_CRIT, "ERROR: Encoded clause buffer ends unexpectedly (%lu/%lu bytes)!\n", 
+            _byte_pos, _nb_bytes);
+        abort();
+    }
+
+    if (_use_checksum) {
+        hash_combine(_hash, Mallob::ClauseHasher::hash(lits, _current_clause.size, 3));
+    }
+
+    _current_clause.begin = lits;
+    _remaining_cls_of_bucket--;
+    return _current_clause;
+}
+
 const Mallob::Clause& BufferReader::endReading() {
     // Verify checksum
     if (_use_checksum && _hash != _true_hash) {
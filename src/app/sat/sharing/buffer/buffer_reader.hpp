@@ -5,6 +5,7 @@
 
 #include "util/assert.hpp"
 #include "buffer_iterator.hpp"
+#include "buffer_codec.hpp"
 #include "../../data/clause.hpp"
 #include "util/hashing.hpp"
 #include "util/logger.hpp"
@@ -23,9 +24,22 @@ private:
     size_t _hash;
     size_t _true_hash = 1;
 
+    // Lazy decoding of a buffer in the format of ClauseBufferCodec:
+    // Clauses are decoded alternately into two slots such that the
+    // previously returned clause stays valid until the next call.
+    bool _encoded = false;
+    const uint8_t* _bytes = nullptr;
+    size_t _nb_bytes = 0;
+    size_t _byte_pos = 0;
+    int _prev_first_lit = 0;
+    int _slot_size = 0;
+    std::vector<int> _decoded_slots;
+    int _decoded_slot_idx = 0;
+
 public:
     BufferReader() = default;
-    BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum = false);
+    BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, 
+        bool useChecksum = false, bool encoded = false);
 
     void releaseBuffer() {_buffer = nullptr;}
     
@@ -38,6 +52,7 @@ public:
     inline const Mallob::Clause& getNextIncomingClause() {
         // No buffer?
         if (_buffer == nullptr) return _current_clause;
+        if (_encoded) return getNextEncodedClause();
 
         // Find first bucket with some clauses left
         if (_remaining_cls_of_bucket == 0) {
@@ -49,8 +64,8 @@ public:
 
                 // Go to next bucket
                 _it.nextLengthLbdGroup();
+                assert(_buffer[_current_pos] >= 0);
                 _remaining_cls_of_bucket = _buffer[_current_pos++];
-                assert(_remaining_cls_of_bucket >= 0);
             
             } while (_remaining_cls_of_bucket == 0);
 
@@ -82,11 +97,13 @@ public:
         _current_pos += _it.clauseLength;
 
         // Decrement remaining clauses
+        assert(_remaining_cls_of_bucket > 0);
         _remaining_cls_of_bucket--;
 
         return _current_clause;
     }
 
 private:
+    const Mallob::Clause& getNextEncodedClause();
     const Mallob::Clause& endReading();
 };
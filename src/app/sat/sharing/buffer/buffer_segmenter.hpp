@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+#include "buffer_iterator.hpp"
+#include "buffer_builder.hpp"
+#include "buffer_reader.hpp"
+
+/*
+Splits flat clause buffers into a fixed number of segments along the order
+of their buckets: the first segment contains the unit clauses, the second
+segment the binary clauses, and the remaining buckets are distributed evenly
+over the remaining segments. Each segment is a valid clause buffer on its own.
+Since all clauses of a segment precede all clauses of the next segment in the
+buffer order, segments can be merged independently and in order of priority.
+*/
+class BufferSegmenter {
+
+private:
+    int _max_clause_length;
+    bool _slots_for_sum_of_length_and_lbd;
+    int _nb_segments;
+
+    // (clause length, lbd) -> segment index
+    std::vector<int> _segment_of_bucket;
+
+public:
+    BufferSegmenter(int maxClauseLength, bool slotsForSumOfLengthAndLbd, int nbSegments) :
+        _max_clause_length(maxClauseLength), _slots_for_sum_of_length_and_lbd(slotsForSumOfLengthAndLbd),
+        _nb_segments(std::max(1, nbSegments)) {
+
+        // Enumerate buckets in buffer order
+        std::vector<std::pair<int, int>> buckets;
+        BufferIterator it(_max_clause_length, _slots_for_sum_of_length_and_lbd);
+        while (it.clauseLength <= _max_clause_length) {
+            buckets.emplace_back(it.clauseLength, it.lbd);
+            it.nextLengthLbdGroup();
+        }
+
+        // Assign segments: units, binaries, then even split of the rest
+        _segment_of_bucket.assign((_max_clause_length+1)*(_max_clause_length+1), _nb_segments-1);
+        int nbLargeBuckets = std::max(0, (int)buckets.size()-2);
+        int nbLargeSegments = std::max(1, _nb_segments-2);
+        for (size_t i = 0; i < buckets.size(); i++) {
+            int segment;
+            if (i < 2) segment = i;
+            else segment = 2 + ((i-2) * nbLargeSegments) / std::max(1, nbLargeBuckets);
+            segment = std::min(segment, _nb_segments-1);
+            auto [len, lbd] = buckets[i];
+            _segment_of_bucket[len*(_max_clause_length+1)+lbd] = segment;
+        }
+    }
+
+    int getNumSegments() const {return _nb_segments;}
+
+    int getSegmentIndex(int clauseLength, int lbd) const {
+        if (clauseLength > _max_clause_length || lbd > _max_clause_length) return _nb_segments-1;
+        return _segment_of_bucket[clauseLength*(_max_clause_length+1)+lbd];
+    }
+
+    std::vector<std::vector<int>> split(std::vector<int>& buffer) const {
+        std::vector<std::vector<int>> segments(_nb_segments);
+        std::vector<BufferBuilder*> builders;
+        for (auto& segment : segments)
+            builders.push_back(new BufferBuilder(-1, _max_clause_length, _slots_for_sum_of_length_and_lbd, &segment));
+        BufferReader reader(buffer.data(), buffer.size(), _max_clause_length, _slots_for_sum_of_length_and_lbd);
+        for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+            builders[getSegmentIndex(c.size, c.lbd)]->append(c);
+        }
+        for (auto builder : builders) delete builder;
+        return segments;
+    }
+
+    // Concatenates segments (given in order) into a single buffer.
+    std::vector<int> join(std::vector<std::vector<int>>& segments) const {
+        std::vector<int> out;
+        BufferBuilder builder(-1, _max_clause_length, _slots_for_sum_of_length_and_lbd, &out);
+        for (auto& segment : segments) {
+            BufferReader reader(segment.data(), segment.size(), _max_clause_length, _slots_for_sum_of_length_and_lbd);
+            for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+                builder.append(c);
+            }
+        }
+        return out;
+    }
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "util/assert.hpp"
+#include "util/sys/threading.hpp"
+
+/*
+Contiguous piece of literal memory handed out by a ClauseArena.
+The valid content of a chunk is data[0, end): clauses are appended
+at the end and consumed from the end as well.
+*/
+struct ClauseChunk {
+    int* data = nullptr;
+    int capacity = 0;
+    int end = 0;
+
+    bool empty() const {return end == 0;}
+    int size() const {return end;}
+    int remainingCapacity() const {return capacity - end;}
+};
+
+/*
+Per-database pool of fixed-size literal chunks. Chunks are allocated in
+blocks on demand and recycled via a free list, so clause insertions and
+removals do not hit the allocator in the steady state. Memory is only
+returned to the system upon destruction of the arena.
+*/
+class ClauseArena {
+
+private:
+    const int _chunk_capacity;
+    const int _chunks_per_block;
+
+    Mutex _mtx;
+    std::vector<std::unique_ptr<int[]>> _literal_blocks;
+    std::vector<std::unique_ptr<ClauseChunk[]>> _chunk_blocks;
+    std::vector<ClauseChunk*> _free_chunks;
+    int _nb_allocated_chunks = 0;
+
+public:
+    ClauseArena(int chunkCapacity, int chunksPerBlock = 8) :
+        _chunk_capacity(chunkCapacity), _chunks_per_block(chunksPerBlock) {}
+
+    int getChunkCapacity() const {return _chunk_capacity;}
+
+    ClauseChunk* acquire() {
+        auto lock = _mtx.getLock();
+        if (_free_chunks.empty()) allocateBlock();
+        ClauseChunk* chunk = _free_chunks.back();
+        _free_chunks.pop_back();
+        chunk->end = 0;
+        return chunk;
+    }
+
+    void release(ClauseChunk* chunk) {
+        auto lock = _mtx.getLock();
+        _free_chunks.push_back(chunk);
+    }
+
+    template <typename Iterator>
+    void release(Iterator begin, Iterator end) {
+        if (begin == end) return;
+        auto lock = _mtx.getLock();
+        _free_chunks.insert(_free_chunks.end(), begin, end);
+    }
+
+    int getNumAllocatedChunks() {
+        auto lock = _mtx.getLock();
+        return _nb_allocated_chunks;
+    }
+
+private:
+    void allocateBlock() {
+        _literal_blocks.emplace_back(new int[(size_t)_chunk_capacity * _chunks_per_block]);
+        _chunk_blocks.emplace_back(new ClauseChunk[_chunks_per_block]);
+        int* lits = _literal_blocks.back().get();
+        ClauseChunk* chunks = _chunk_blocks.back().get();
+        for (int i = 0; i < _chunks_per_block; i++) {
+            chunks[i].data = lits + (size_t)i * _chunk_capacity;
+            chunks[i].capacity = _chunk_capacity;
+            _free_chunks.push_back(chunks+i);
+        }
+        _nb_allocated_chunks += _chunks_per_block;
+    }
+};
@@ -1,18 +1,31 @@
 
 #pragma once
 
-#include <list>
+#include <memory>
+#include <vector>
 
 #include "util/sys/threading.hpp"
 #include "filter/produced_clause_filter.hpp"
+#include "produced_clause_ring.hpp"
 #include "buffer/adaptive_clause_database.hpp"
 #include "../data/solver_statistics.hpp"
 
 class ExportBuffer {
 
 private:
-    Mutex _backlog_mutex;
-    std::list<ProducedClauseCandidate> _export_backlog;
+    // One lock-free ring per producing solver
+    struct Producer {
+        ProducedClauseRing ring;
+        // Clauses dropped without holding the drain lock,
+        // not yet reported to the solver's statistics
+        std::atomic_ulong nbUnreportedDrops {0};
+        Producer(int ringCapacity) : ring(ringCapacity) {}
+    };
+    std::vector<std::unique_ptr<Producer>> _producers;
+
+    // Ensures a single consumer for the rings; the filter itself is 
+    // internally synchronized and may be queried concurrently
+    Mutex _drain_mutex;
 
     ProducedClauseFilter& _filter;
     AdaptiveClauseDatabase& _cdb;
@@ -24,56 +37,79 @@ private:
 
 public:
     ExportBuffer(ProducedClauseFilter& filter, AdaptiveClauseDatabase& cdb, 
-            std::vector<SolverStatistics*>& solverStats, int maxClauseLength) : 
+            std::vector<SolverStatistics*>& solverStats, int maxClauseLength,
+            int numProducers, int ringCapacity) : 
         _filter(filter), _cdb(cdb), _solver_stats(solverStats),
         _hist_failed_filter(maxClauseLength), 
         _hist_admitted_to_db(maxClauseLength), 
-        _hist_dropped_before_db(maxClauseLength) {}
+        _hist_dropped_before_db(maxClauseLength) {
+        
+        // Each ring must be able to hold at least a few clauses of max. length
+        ringCapacity = std::max(ringCapacity, 8*(maxClauseLength+4));
+        for (int i = 0; i < numProducers; i++) {
+            _producers.emplace_back(new Producer(ringCapacity));
+        }
+    }
 
+    // Called by a solver thread for each clause it produces. Never blocks.
     void produce(int* begin, int size, int lbd, int producerId, int epoch) {
 
-        if (_filter.tryAcquireLock()) {
+        auto& producer = *_producers.at(producerId);
+        auto& ring = producer.ring;
+        if (ring.tryPush(begin, size, lbd, epoch)) {
+            // Help draining the rings once this ring becomes crowded
+            if (2*ring.getFillLevel() >= ring.getCapacity() && _drain_mutex.tryLock()) {
+                drainRings();
+                _drain_mutex.unlock();
+            }
+            return;
+        }
 
-            // Insert clause directly
+        // Ring full: Drain the rings and insert the clause directly,
+        // or drop the clause if some other thread is busy draining
+        if (_drain_mutex.tryLock()) {
+            drainRings();
             auto result = _filter.tryRegisterAndInsert(
                 ProducedClauseCandidate(begin, size, lbd, producerId, epoch), 
                 _cdb
             );
             handleResult(producerId, result, size);
-
-            // Also decrease backlog size by some amount
-            std::list<ProducedClauseCandidate> backlogSplice;
-            {
-                auto lock = _backlog_mutex.getLock();
-                if (!_export_backlog.empty()) {
-                    backlogSplice.splice(backlogSplice.begin(), _export_backlog, 
-                        _export_backlog.begin(),
-                        std::next(_export_backlog.begin(), std::min(16ul, _export_backlog.size()))
-                    );
-                }
-            }
-            for (auto& pcc : backlogSplice) {
-                int clauseLength = pcc.size;
-                int producerId = pcc.producerId;
-                result = _filter.tryRegisterAndInsert(std::move(pcc), _cdb);
-                handleResult(producerId, result, clauseLength);
-            }
-
-            _filter.releaseLock();
-
+            _drain_mutex.unlock();
         } else {
-
-            // Filter busy: Append clause to backlog
-            auto lock = _backlog_mutex.getLock();
-            _export_backlog.emplace_back(begin, size, lbd, producerId, epoch);        
+            _hist_dropped_before_db.increment(size);
+            producer.nbUnreportedDrops.fetch_add(1, std::memory_order_relaxed);
         }
     }
 
+    // Moves all clauses from the producer rings into the filter and the
+    // clause database. Blocks until no other thread is draining.
+    void collect() {
+        auto lock = _drain_mutex.getLock();
+        drainRings();
+    }
+
     ClauseHistogram& getFailedFilterHistogram() {return _hist_failed_filter;}
 	ClauseHistogram& getAdmittedHistogram() {return _hist_admitted_to_db;}
 	ClauseHistogram& getDroppedHistogram() {return _hist_dropped_before_db;}
 
 private:
+    // The drain lock must be held.
+    void drainRings() {
+        for (size_t producerId = 0; producerId < _producers.size(); producerId++) {
+            auto& producer = *_producers[producerId];
+            auto nbDrops = producer.nbUnreportedDrops.exchange(0, std::memory_order_relaxed);
+            auto solverStats = _solver_stats.at(producerId);
+            if (nbDrops > 0 && solverStats) solverStats->producedClausesDropped += nbDrops;
+            producer.ring.drain([&](int* lits, int size, int lbd, int epoch) {
+                auto result = _filter.tryRegisterAndInsert(
+                    ProducedClauseCandidate(lits, size, lbd, producerId, epoch), 
+                    _cdb
+                );
+                handleResult(producerId, result, size);
+            });
+        }
+    }
+
     void handleResult(int producerId, ProducedClauseFilter::ExportResult result, int clauseLength) {
         auto solverStats = _solver_stats.at(producerId);
         if (result == ProducedClauseFilter::ADMITTED) {
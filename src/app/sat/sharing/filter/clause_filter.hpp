@@ -30,6 +30,7 @@ public:
 
 struct AbstractClauseThreewayComparator {
 	virtual int compare(const Clause& left, const Clause& right) const = 0;
+	virtual ~AbstractClauseThreewayComparator() {}
 };
 struct LexicographicClauseThreewayComparator : public AbstractClauseThreewayComparator {
 	int compare(const Clause& left, const Clause& right) const {
@@ -38,11 +39,7 @@ struct LexicographicClauseThreewayComparator : public AbstractClauseThreewayComp
 		// Shortest LBD first
 		if (left.lbd != right.lbd) return left.lbd < right.lbd ? -1 : 1;
 		// Lexicographic comparison of literals
-		for (size_t i = 0; i < left.size; i++) {
-			if (left.begin[i] != right.begin[i]) 
-				return left.begin[i] < right.begin[i] ? -1 : 1;
-		}
-		return 0;
+		return Mallob::kernels::compare(left.begin, right.begin, left.size);
 	}
 };
 struct LengthLbdSumClauseThreewayComparator : public AbstractClauseThreewayComparator {
@@ -59,11 +56,7 @@ struct LengthLbdSumClauseThreewayComparator : public AbstractClauseThreewayCompa
 		// Shortest LBD first
 		if (left.lbd != right.lbd) return left.lbd < right.lbd ? -1 : 1;
 		// Lexicographic comparison of literals
-		for (size_t i = 0; i < left.size; i++) {
-			if (left.begin[i] != right.begin[i]) 
-				return left.begin[i] < right.begin[i] ? -1 : 1;
-		}
-		return 0;
+		return Mallob::kernels::compare(left.begin, right.begin, left.size);
 	}
 };
 struct ClauseComparator {
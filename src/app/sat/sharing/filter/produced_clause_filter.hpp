@@ -2,10 +2,13 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <vector>
 
 #include "util/tsl/robin_map.h"
 #include "../../data/produced_clause.hpp"
 #include "../../data/produced_clause_candidate.hpp"
+#include "../buffer/adaptive_clause_database.hpp"
 #include "util/sys/threading.hpp"
 
 // Packed struct to get in all meta data within a 32 bit integer.
@@ -18,6 +21,7 @@ struct ClauseInfo {
     // Bitset of which local solver(s) exported the clause 
     uint8_t producers:6;
     // Epoch of last modification (production, or sharing:=true)
+    // (as long as the clause has not been shared, the production epoch is updated)
     uint16_t lastSharedEpoch:16;
 
     ClauseInfo() {
@@ -30,7 +34,7 @@ struct ClauseInfo {
         minProducedLbd = c.lbd;
         minSharedLbd = 0;
         producers = 1 << c.producerId;
-        lastSharedEpoch = 0;
+        lastSharedEpoch = c.epoch;
     }
 };
 
@@ -40,96 +44,103 @@ struct ClauseInfo {
 // subset of solvers should receive the clauses (because they did not export it themselves).
 // The structure takes space linear in the number of clauses successfully added to the
 // AdaptiveClauseDatabase instance which is used for tryRegisterAndInsert. 
+// Entries which have not been modified for more than epochHorizon epochs are evicted
+// (see collectGarbage). Optionally, large clauses are only represented by a 64-bit
+// fingerprint instead of a copy of their literals, and the memory of the structure
+// can be limited, in which case the oldest entries are evicted first.
+// The clauses are partitioned by their hash value into a power-of-two number of shards
+// which are locked individually, so all public methods can be called concurrently.
 class ProducedClauseFilter {
 
 template <typename T>
 using ProducedMap = tsl::robin_map<T, ClauseInfo, ProducedClauseHasher<T>, ProducedClauseEqualsCommutative<T>>;
+using FingerprintMap = tsl::robin_map<uint64_t, ClauseInfo>;
 
 private:
-    ProducedMap<ProducedUnitClause> _map_units;
-    ProducedMap<ProducedBinaryClause> _map_binaries;
-    ProducedMap<ProducedLargeClause> _map_large_clauses;
-
-    Mutex _map_mutex;
+    struct Shard {
+        ProducedMap<ProducedUnitClause> mapUnits;
+        ProducedMap<ProducedBinaryClause> mapBinaries;
+        ProducedMap<ProducedLargeClause> mapLargeClauses;
+        FingerprintMap mapFingerprints;
+        size_t nbLiteralBytes {0}; // literals referenced by mapLargeClauses
+        Mutex mtx;
+    };
+    std::vector<std::unique_ptr<Shard>> _shards;
+    size_t _shard_mask;
 
     const int _epoch_horizon;
     const bool _reshare_improved_lbd;
+    const bool _fingerprints_only;
+    const size_t _max_memory_bytes;
+
+    int _last_aging_epoch = 0;
+    Mutex _gc_mutex;
 
     ClauseInfo _empty_clause_info;
 
 public:
-    ProducedClauseFilter(int epochHorizon, bool reshareImprovedLbd) : 
-        _epoch_horizon(epochHorizon), _reshare_improved_lbd(reshareImprovedLbd) {}
+    ProducedClauseFilter(int epochHorizon, bool reshareImprovedLbd, 
+            bool fingerprintsOnly = false, size_t maxMemoryBytes = 0, int nbShards = 1) : 
+        _epoch_horizon(epochHorizon), _reshare_improved_lbd(reshareImprovedLbd), 
+        _fingerprints_only(fingerprintsOnly), _max_memory_bytes(maxMemoryBytes) {
+        
+        // Round number of shards up to the next power of two
+        size_t nb = 1;
+        while (nb < (size_t) nbShards) nb <<= 1;
+        for (size_t i = 0; i < nb; i++) _shards.emplace_back(new Shard());
+        _shard_mask = nb-1;
+    }
 
     enum ExportResult {ADMITTED, FILTERED, DROPPED};
     ExportResult tryRegisterAndInsert(ProducedClauseCandidate&& c, AdaptiveClauseDatabase& cdb) {
         
+        auto& shard = getShard(c.begin, c.size);
+        auto lock = shard.mtx.getLock();
+
         if (c.size == 1) {
             ProducedUnitClause pc;
             pc.literal = *c.begin;
-            return tryRegisterAndInsert(pc, c, _map_units, cdb);
+            return tryRegisterAndInsert(pc, c, shard.mapUnits, shard, cdb);
 
         } else if (c.size == 2) {
             ProducedBinaryClause pc;
             pc.literals[0] = std::min(c.begin[0], c.begin[1]);
             pc.literals[1] = std::max(c.begin[0], c.begin[1]);
-            return tryRegisterAndInsert(pc, c, _map_binaries, cdb);
+            return tryRegisterAndInsert(pc, c, shard.mapBinaries, shard, cdb);
+
+        } else if (_fingerprints_only) {
+            uint64_t fingerprint = Mallob::fingerprint(c.begin, c.size);
+            return tryRegisterAndInsert(fingerprint, c.begin, c, shard.mapFingerprints, shard, cdb);
 
         } else {
             ProducedLargeClause pc;
             pc.size = c.size;
             pc.data = c.releaseData();
-            return tryRegisterAndInsert(pc, c, _map_large_clauses, cdb);
-        }
-    }
-
-    template<typename T>
-    ExportResult tryRegisterAndInsert(T& pc, ProducedClauseCandidate& c, ProducedMap<T>& map, AdaptiveClauseDatabase& cdb) {
-        
-        // Try to find clause
-        auto it = map.find(pc);
-                
-        // If clause is contained:
-        bool contained = it != map.end();
-        if (contained) {
-            int oldLbd = it.value().minProducedLbd;
-            // No improvement in LBD value? Filter clause.
-            if (oldLbd > 0 && c.lbd >= oldLbd) {
-                updateClauseInfo(c, it.value(), /*updateLbd=*/false);
-                return FILTERED;
-            }
-            // Clause can be accepted (again) due to improved LBD score
-        }
-
-        // Try to insert to sharing database
-        if (!cdb.addClause(prod_cls::data(pc), c.size, c.lbd, /*sortLargeClause=*/true)) {
-            // No space left in database: update meta data, drop clause
-            // (Do not update LBD value because the clause was not exported)
-            if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/false);
-            return DROPPED;
+            return tryRegisterAndInsert(pc, c, shard.mapLargeClauses, shard, cdb);
         }
-
-        // Inserted: do register and set epoch to current epoch
-        if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/true);
-        else map.insert({std::move(pc), ClauseInfo(c)});
-        return ADMITTED;
     }
 
     uint8_t getProducers(Mallob::Clause& c, int epoch) {
 
+        auto& shard = getShard(c.begin, c.size);
+        auto lock = shard.mtx.getLock();
+
         if (c.size == 1) {
             ProducedUnitClause pc(c);
-            return getProducers(pc, _map_units, epoch);
+            return getProducers(pc, shard.mapUnits, epoch);
 
         } else if (c.size == 2) {
             ProducedBinaryClause pc(c);
-            return getProducers(pc, _map_binaries, epoch);
+            return getProducers(pc, shard.mapBinaries, epoch);
+
+        } else if (_fingerprints_only) {
+            return getProducers(Mallob::fingerprint(c.begin, c.size), shard.mapFingerprints, epoch);
 
         } else {
             ProducedLargeClause pc;
             pc.size = c.size;
             pc.data = c.begin;
-            auto info = getProducers(pc, _map_large_clauses, epoch);
+            auto info = getProducers(pc, shard.mapLargeClauses, epoch);
             pc.data = nullptr;
             return info;
         }
@@ -137,31 +148,181 @@ public:
 
     bool admitSharing(Mallob::Clause& c, int epoch) {
 
+        auto& shard = getShard(c.begin, c.size);
+        auto lock = shard.mtx.getLock();
+
         if (c.size == 1) {
             ProducedUnitClause pc(c);
-            return admitSharing(pc, _map_units, c.lbd, epoch);
+            return admitSharing(pc, shard.mapUnits, c.lbd, epoch);
 
         } else if (c.size == 2) {
             ProducedBinaryClause pc(c);
-            return admitSharing(pc, _map_binaries, c.lbd, epoch);
+            return admitSharing(pc, shard.mapBinaries, c.lbd, epoch);
+
+        } else if (_fingerprints_only) {
+            return admitSharing(Mallob::fingerprint(c.begin, c.size), shard.mapFingerprints, c.lbd, epoch);
 
         } else {
             ProducedLargeClause pc;
             pc.data = c.begin;
             pc.size = c.size;
-            bool admitted = admitSharing(pc, _map_large_clauses, c.lbd, epoch);
+            bool admitted = admitSharing(pc, shard.mapLargeClauses, c.lbd, epoch);
             pc.data = nullptr; // avoid freeing of clause data reference
             return admitted;
         }
     }
 
-    inline bool tryAcquireLock() {return _map_mutex.tryLock();}
-    inline void acquireLock() {_map_mutex.lock();}
-    inline void releaseLock() {_map_mutex.unlock();}
+    // Evicts all entries which have not been modified for more than epochHorizon epochs
+    // and, if the memory limit is exceeded, the oldest entries until a fraction of the
+    // limit is used. Locks one shard at a time.
+    void collectGarbage(int epoch) {
+
+        auto gcLock = _gc_mutex.getLock();
+
+        bool aging = _epoch_horizon >= 0 && epoch - _last_aging_epoch >= std::max(1, _epoch_horizon/4);
+        bool overLimit = _max_memory_bytes > 0 && getMemoryFootprint() > _max_memory_bytes;
+        if (!aging && !overLimit) return;
+
+        int maxAge = _epoch_horizon >= 0 ? _epoch_horizon : INT32_MAX;
+        if (overLimit) {
+            // Find max. age such that the remaining entries fit into 3/4 of the limit
+            std::vector<size_t> nbEntriesOfAge(std::min(maxAge, (int)UINT16_MAX)+1, 0);
+            for (auto& shard : _shards) {
+                auto lock = shard->mtx.getLock();
+                forEachMap(*shard, [&](auto& map) {
+                    for (auto it = map.begin(); it != map.end(); ++it) {
+                        int age = getAge(it.value(), epoch);
+                        if (age < nbEntriesOfAge.size()) nbEntriesOfAge[age]++;
+                    }
+                });
+            }
+            double bytesPerEntry = getMemoryFootprint() / (double) std::max((size_t)1, size());
+            size_t maxNbEntries = (3*_max_memory_bytes/4) / bytesPerEntry;
+            size_t nbEntries = 0;
+            maxAge = -1;
+            while (maxAge+1 < nbEntriesOfAge.size() && nbEntries + nbEntriesOfAge[maxAge+1] <= maxNbEntries) {
+                maxAge++;
+                nbEntries += nbEntriesOfAge[maxAge];
+            }
+        }
+
+        size_t sizeBefore = size();
+        for (auto& shard : _shards) {
+            auto lock = shard->mtx.getLock();
+            forEachMap(*shard, [&](auto& map) {
+                for (auto it = map.begin(); it != map.end();) {
+                    if (getAge(it.value(), epoch) > maxAge) {
+                        shard->nbLiteralBytes -= getLiteralBytes(it.key());
+                        it = map.erase(it);
+                    } else ++it;
+                }
+                // Release memory of the erased entries
+                if (overLimit) map.rehash(0);
+            });
+        }
+        if (aging) _last_aging_epoch = epoch;
+        LOG(V5_DEBG, "ProducedClauseFilter: evicted %lu/%lu entries older than %i epochs\n", 
+            sizeBefore-size(), sizeBefore, maxAge);
+    }
+
+    size_t size() {
+        size_t res = 0;
+        for (auto& shard : _shards) {
+            auto lock = shard->mtx.getLock();
+            res += shard->mapUnits.size() + shard->mapBinaries.size() 
+                + shard->mapLargeClauses.size() + shard->mapFingerprints.size();
+        }
+        return res;
+    }
+
+    // Estimated number of bytes occupied by this structure.
+    // Takes constant time per shard.
+    size_t getMemoryFootprint() {
+        size_t bytes = 0;
+        for (auto& shard : _shards) {
+            auto lock = shard->mtx.getLock();
+            bytes += shard->mapUnits.bucket_count() * (sizeof(ProducedUnitClause) + sizeof(ClauseInfo) + 8)
+                + shard->mapBinaries.bucket_count() * (sizeof(ProducedBinaryClause) + sizeof(ClauseInfo) + 8)
+                + shard->mapLargeClauses.bucket_count() * (sizeof(ProducedLargeClause) + sizeof(ClauseInfo) + 8)
+                + shard->mapFingerprints.bucket_count() * (sizeof(uint64_t) + sizeof(ClauseInfo) + 8)
+                + shard->nbLiteralBytes;
+        }
+        return bytes;
+    }
+
+    int getNumShards() const {return _shards.size();}
 
 private:
+    // Uses the upper bits of a hash value which is independent 
+    // from the one used for the buckets of the maps
+    inline Shard& getShard(const int* lits, int size) {
+        if (_shard_mask == 0) return *_shards[0];
+        return *_shards[(Mallob::commutativeHash(lits, size, 7) >> 20) & _shard_mask];
+    }
+
+    // Number of heap bytes an entry's key refers to
+    template <typename K>
+    static size_t getLiteralBytes(const K&) {return 0;}
+    static size_t getLiteralBytes(const ProducedLargeClause& pc) {return pc.size * sizeof(int);}
+
+    static int getAge(const ClauseInfo& info, int epoch) {
+        return (uint16_t) ((uint16_t)epoch - info.lastSharedEpoch);
+    }
+
+    template <typename F>
+    static void forEachMap(Shard& shard, F f) {
+        f(shard.mapUnits);
+        f(shard.mapBinaries);
+        f(shard.mapLargeClauses);
+        f(shard.mapFingerprints);
+    }
+
+    template<typename T>
+    ExportResult tryRegisterAndInsert(T& pc, ProducedClauseCandidate& c, ProducedMap<T>& map, 
+            Shard& shard, AdaptiveClauseDatabase& cdb) {
+        return tryRegisterAndInsert(pc, prod_cls::data(pc), c, map, shard, cdb);
+    }
+
+    template<typename K, typename Map>
+    ExportResult tryRegisterAndInsert(K& pc, int* lits, ProducedClauseCandidate& c, Map& map, 
+            Shard& shard, AdaptiveClauseDatabase& cdb) {
+        
+        // Try to find clause
+        auto it = map.find(pc);
+                
+        // If clause is contained:
+        bool contained = it != map.end();
+        if (contained) {
+            int oldLbd = it.value().minProducedLbd;
+            // No improvement in LBD value? Filter clause.
+            if (oldLbd > 0 && c.lbd >= oldLbd) {
+                updateClauseInfo(c, it.value(), /*updateLbd=*/false);
+                return FILTERED;
+            }
+            // Clause can be accepted (again) due to improved LBD score
+        }
+
+        // Try to insert to sharing database
+        if (!cdb.addClause(lits, c.size, c.lbd, /*sortLargeClause=*/true)) {
+            // No space left in database: update meta data, drop clause
+            // (Do not update LBD value because the clause was not exported)
+            if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/false);
+            return DROPPED;
+        }
+
+        // Inserted: do register and set epoch to current epoch
+        if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/true);
+        else {
+            shard.nbLiteralBytes += getLiteralBytes(pc);
+            map.insert({std::move(pc), ClauseInfo(c)});
+        }
+        return ADMITTED;
+    }
+
     void updateClauseInfo(const ProducedClauseCandidate& c, ClauseInfo& info, bool updateLbd) {
         assert(c.lbd > 0);
+        // Not shared yet: remember the epoch of the latest production
+        if (info.minSharedLbd == 0) info.lastSharedEpoch = c.epoch;
         if (updateLbd) {
             if (info.minProducedLbd == 0 || info.minProducedLbd > c.lbd) {
                 // Improved (or first) LBD
@@ -172,8 +333,8 @@ private:
         info.producers |= (1 << c.producerId);
     }
 
-    template <typename T>
-    inline bool admitSharing(const T& pc, ProducedMap<T>& map, int lbd, int epoch) {
+    template <typename K, typename Map>
+    inline bool admitSharing(const K& pc, Map& map, int lbd, int epoch) {
         
         auto it = map.find(pc);
         if (it == map.end()) return true; // No entry? -> Admit trivially
@@ -201,8 +362,8 @@ private:
         return true;
     }
 
-    template <typename T>
-    inline uint8_t getProducers(const T& pc, ProducedMap<T>& map, int epoch) {
+    template <typename K, typename Map>
+    inline uint8_t getProducers(const K& pc, Map& map, int epoch) {
         auto it = map.find(pc);
         if (it == map.end()) return 0;
         ClauseInfo& info = it.value();
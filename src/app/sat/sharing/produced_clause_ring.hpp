@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "util/assert.hpp"
+
+/*
+Bounded single-producer single-consumer ring buffer for produced clauses.
+The producer (a solver thread inside its learned clause callback) appends
+clauses without any locking. The consumer drains all clauses in batches.
+Consumers must be mutually exclusive (ensured externally).
+Each clause is stored as a record (size, lbd, epoch, lits...) which never
+wraps around the end of the ring: If a record does not fit into the
+remaining space at the end, a padding marker (size 0) is written and the
+record starts at the ring's beginning.
+*/
+class ProducedClauseRing {
+
+private:
+    static constexpr int HEADER_SIZE = 3;
+
+    std::vector<int> _data;
+    size_t _mask;
+
+    // Monotonically increasing positions (modulo ring size: index into _data)
+    alignas(64) std::atomic<size_t> _write_pos {0};
+    alignas(64) std::atomic<size_t> _read_pos {0};
+
+    // Guards against a second producer which may appear for a short time
+    // when a solver is replaced (the ring must never see concurrent pushes).
+    alignas(64) std::atomic_flag _producer_active = ATOMIC_FLAG_INIT;
+
+public:
+    ProducedClauseRing(size_t minCapacity) {
+        size_t capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        _data.resize(capacity);
+        _mask = capacity-1;
+    }
+
+    // Returns false if the clause does not fit into the ring at the moment.
+    bool tryPush(const int* begin, int size, int lbd, int epoch) {
+
+        if (_producer_active.test_and_set(std::memory_order_acquire)) return false;
+
+        size_t writePos = _write_pos.load(std::memory_order_relaxed);
+        size_t readPos = _read_pos.load(std::memory_order_acquire);
+        size_t idx = writePos & _mask;
+        size_t contiguous = _data.size() - idx;
+        size_t recordSize = HEADER_SIZE + size;
+        size_t padding = recordSize > contiguous ? contiguous : 0;
+        if (recordSize + padding > _data.size() - (writePos - readPos)) {
+            // Not enough space
+            _producer_active.clear(std::memory_order_release);
+            return false;
+        }
+
+        if (padding > 0) {
+            _data[idx] = 0; // marker: skip to the beginning of the ring
+            idx = 0;
+        }
+        int* record = _data.data() + idx;
+        record[0] = size;
+        record[1] = lbd;
+        record[2] = epoch;
+        for (int i = 0; i < size; i++) record[HEADER_SIZE+i] = begin[i];
+        _write_pos.store(writePos + padding + recordSize, std::memory_order_release);
+
+        _producer_active.clear(std::memory_order_release);
+        return true;
+    }
+
+    // Calls consume(lits, size, lbd, epoch) for each clause in the ring
+    // in FIFO order, then frees the consumed space. Returns the number of
+    // consumed clauses.
+    template <typename Consumer>
+    int drain(Consumer consume) {
+        size_t readPos = _read_pos.load(std::memory_order_relaxed);
+        size_t writePos = _write_pos.load(std::memory_order_acquire);
+        int nbConsumed = 0;
+        while (readPos != writePos) {
+            size_t idx = readPos & _mask;
+            int* record = _data.data() + idx;
+            if (record[0] == 0) {
+                // Padding: jump to the beginning of the ring
+                readPos += _data.size() - idx;
+                continue;
+            }
+            consume(record+HEADER_SIZE, record[0], record[1], record[2]);
+            readPos += HEADER_SIZE + record[0];
+            nbConsumed++;
+        }
+        _read_pos.store(readPos, std::memory_order_release);
+        return nbConsumed;
+    }
+
+    size_t getFillLevel() const {
+        return _write_pos.load(std::memory_order_relaxed) - _read_pos.load(std::memory_order_relaxed);
+    }
+    size_t getCapacity() const {
+        return _data.size();
+    }
+};
@@ -6,12 +6,14 @@
  */
 
 #include <signal.h>
+#include <atomic>
 
 #include "util/assert.hpp"
 
 #include "sharing_manager.hpp"
 #include "util/sys/timer.hpp"
 #include "util/shuffle.hpp"
+#include "util/sys/thread_pool.hpp"
 #include "buffer/buffer_reducer.hpp"
 
 SharingManager::SharingManager(
@@ -20,7 +22,11 @@ SharingManager::SharingManager(
 	: _solvers(solvers),
 	_max_deferred_lits_per_solver(maxDeferredLitsPerSolver), 
 	_params(params), _logger(logger), _job_index(jobIndex),
-	_filter(params.clauseFilterClearInterval(), params.reshareImprovedLbd()),
+	_filter(params.clauseFilterClearInterval(), params.reshareImprovedLbd(), 
+		params.clauseFilterFingerprints(), ((size_t) params.clauseFilterMemoryLimit()) * 1024 * 1024,
+		// More shards than a few per concurrently accessing thread only add overhead
+		std::min(params.clauseFilterShards(), 4 * std::max((int) solvers.size(), 
+			(int) ProcessWideThreadPool::get().getNumThreads() + 1))),
 	_cdb([&]() {
 		AdaptiveClauseDatabase::Setup setup;
 		setup.maxClauseLength = _params.strictClauseLengthLimit();
@@ -29,7 +35,8 @@ SharingManager::SharingManager(
 		setup.slotsForSumOfLengthAndLbd = _params.groupClausesByLengthLbdSum();
 		return setup;
 	}()), 
-	_export_buffer(_filter, _cdb, _solver_stats, params.strictClauseLengthLimit()),
+	_export_buffer(_filter, _cdb, _solver_stats, params.strictClauseLengthLimit(), 
+		solvers.size(), params.producerRingSize()),
 	_hist_produced(params.strictClauseLengthLimit()), 
 	_hist_returned_to_db(params.strictClauseLengthLimit()) {
 
@@ -133,18 +140,23 @@ void SharingManager::onProduceClause(int solverId, int solverRevision, const Cla
 	if (tldClauseVec) delete tldClauseVec;
 }
 
-int SharingManager::prepareSharing(int* begin, int totalLiteralLimit) {
+int SharingManager::prepareSharing(int* begin, int totalLiteralLimit, int capacity) {
 
+	// Move all clauses produced so far into the clause database
+	_export_buffer.collect();
+
+	// Write the buffer directly to its destination (e.g., shared memory)
 	int numExportedClauses = 0;
-	auto buffer = _cdb.exportBuffer(totalLiteralLimit, numExportedClauses);
-	//assert(buffer.size() <= maxSize);
-	memcpy(begin, buffer.data(), buffer.size()*sizeof(int));
+	int bufferSize = _cdb.exportBuffer(begin, capacity, totalLiteralLimit, numExportedClauses);
 
-	LOGGER(_logger, V5_DEBG, "prepared %i clauses, size %i\n", numExportedClauses, buffer.size());
+	LOGGER(_logger, V5_DEBG, "prepared %i clauses, size %i\n", numExportedClauses, bufferSize);
 	_stats.exportedClauses += numExportedClauses;
 	_internal_epoch++;
 
-	return buffer.size();
+	// Evict outdated entries from filter
+	_filter.collectGarbage(_internal_epoch);
+
+	return bufferSize;
 }
 
 void SharingManager::returnClauses(int* begin, int buflen) {
@@ -160,39 +172,41 @@ void SharingManager::returnClauses(int* begin, int buflen) {
 
 int SharingManager::filterSharing(int* begin, int buflen, int* filterOut) {
 
-	auto reader = _cdb.getBufferReader(begin, buflen);
-	
 	constexpr auto bitsPerElem = 8*sizeof(int);
-	int shift = bitsPerElem;
-	auto clause = reader.getNextIncomingClause();
-	int filterPos = -1;
-	int nbFiltered = 0;
-	int nbTotal = 0;
-
-	_filter.acquireLock();
-	while (clause.begin != nullptr) {
-		++nbTotal;
-
-		if (shift == bitsPerElem) {
-			++filterPos;
-			filterOut[filterPos] = 0;
-			shift = 0;
-		}
-		
-		if (!_filter.admitSharing(clause, _internal_epoch)) {
-			// filtered!
-			auto bitFiltered = 1 << shift;
-			filterOut[filterPos] |= bitFiltered;
-			++nbFiltered;
-		}
-		
-		++shift;
-		clause = reader.getNextIncomingClause();
+
+	// Gather the clauses in buffer order
+	std::vector<Mallob::Clause> clauses;
+	auto reader = _cdb.getBufferReader(begin, buflen);
+	for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+		clauses.push_back(c);
 	}
-	_filter.releaseLock();
+	int nbTotal = clauses.size();
+	int nbFilterInts = (nbTotal + bitsPerElem - 1) / bitsPerElem;
+
+	// Chunks consist of whole filter integers, so concurrent chunks never write to the same integer
+	std::atomic_int nbFiltered {0};
+	const int intsPerChunk = std::max(1, FILTER_CHUNK_NUM_CLAUSES / (int)bitsPerElem);
+	const int nbChunks = (nbFilterInts + intsPerChunk - 1) / intsPerChunk;
+	runConcurrently(nbChunks, [&](int chunk) {
+		int nbFilteredLocally = 0;
+		int filterEnd = std::min(nbFilterInts, (chunk+1)*intsPerChunk);
+		for (int filterPos = chunk*intsPerChunk; filterPos < filterEnd; filterPos++) {
+			int filterInt = 0;
+			int clsEnd = std::min(nbTotal, (int) ((filterPos+1)*bitsPerElem));
+			for (int i = filterPos*bitsPerElem; i < clsEnd; i++) {
+				if (!_filter.admitSharing(clauses[i], _internal_epoch)) {
+					// filtered!
+					filterInt |= 1 << (i - filterPos*bitsPerElem);
+					++nbFilteredLocally;
+				}
+			}
+			filterOut[filterPos] = filterInt;
+		}
+		nbFiltered.fetch_add(nbFilteredLocally);
+	});
 
-	_logger.log(V4_VVER, "filtered %i/%i\n", nbFiltered, nbTotal);
-	return filterPos+1;
+	_logger.log(V4_VVER, "filtered %i/%i\n", nbFiltered.load(), nbTotal);
+	return nbFilterInts;
 }
 
 void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int* filter) {
@@ -235,81 +249,82 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 		});
 	}
 
-	// Prepare to traverse clauses not filtered yet
-	std::vector<std::forward_list<int>> unitLists(importingSolvers.size());
-	std::vector<std::forward_list<std::pair<int, int>>> binaryLists(importingSolvers.size());
-	std::vector<std::forward_list<std::vector<int>>> largeLists(importingSolvers.size());
-	std::vector<int> currentCapacities(importingSolvers.size(), -1);
-	std::vector<int> currentAddedLiterals(importingSolvers.size(), 0);
-
+	// Gather the remaining clauses, which point directly into the received buffer
+	std::vector<Mallob::Clause> clauses;
 	auto reader = _cdb.getBufferReader(begin, buflen);
-	BufferIterator it(_params.strictClauseLengthLimit(), /*slotsForSumOfLengthAndLbd=*/false);
-	auto clause = reader.getNextIncomingClause();
-	bool explicitLbds = false;
+	for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+		clauses.push_back(c);
+		hist.increment(c.size);
+	}
 
-	// Method to publish completed clause lists
-	auto doPublishClauseLists = [&]() {
-		if (it.clauseLength == 1) {
-			// Publish unit lists
-			for (size_t i = 0; i < importingSolvers.size(); i++) {
-				if (!unitLists[i].empty()) {
-					importingSolvers[i]->addLearnedClauses(it.clauseLength, it.lbd, unitLists[i], currentAddedLiterals[i]);
-				}
-			}
-		} else if (it.clauseLength == 2) {
-			// Publish binary lists
-			for (size_t i = 0; i < importingSolvers.size(); i++) {
-				if (!binaryLists[i].empty()) {
-					importingSolvers[i]->addLearnedClauses(it.clauseLength, it.lbd, binaryLists[i], currentAddedLiterals[i]);
-				}
-			}
-		} else {
-			// Publish large lists
-			for (size_t i = 0; i < importingSolvers.size(); i++) {
-				if (!largeLists[i].empty()) {
-					importingSolvers[i]->addLearnedClauses(it.clauseLength, it.lbd, largeLists[i], currentAddedLiterals[i]);
-				}
-			}
+	// Look up the local producers of each clause in the (sharded) filter
+	_logger.log(verb+2, "DG query producers\n");
+	std::vector<uint8_t> producers(clauses.size());
+	const int nbChunks = (clauses.size() + FILTER_CHUNK_NUM_CLAUSES - 1) / FILTER_CHUNK_NUM_CLAUSES;
+	runConcurrently(nbChunks, [&](int chunk) {
+		size_t end = std::min(clauses.size(), (size_t) (chunk+1)*FILTER_CHUNK_NUM_CLAUSES);
+		for (size_t i = chunk*FILTER_CHUNK_NUM_CLAUSES; i < end; i++) {
+			producers[i] = _filter.getProducers(clauses[i], _internal_epoch);
 		}
-	};
-
-	_logger.log(verb+2, "DG prepare import\n");
-
-	// Traverse clauses
-	bool initialized = false;
-	_filter.acquireLock();
+	});
 
+	// Import into disjoint groups of solvers concurrently
 	_logger.log(verb+2, "DG import\n");
+	int nbGroups = std::min(importingSolvers.size(), ProcessWideThreadPool::get().getNumThreads()+1);
+	if (clauses.size() < FILTER_CHUNK_NUM_CLAUSES) nbGroups = std::min(nbGroups, 1);
+	runConcurrently(nbGroups, [&](int group) {
+		std::vector<PortfolioSolverInterface*> solverGroup;
+		for (size_t i = group; i < importingSolvers.size(); i += nbGroups) 
+			solverGroup.push_back(importingSolvers[i]);
+		importClausesToSolvers(clauses, producers, solverGroup);
+	});
+	
+	// Process-wide stats
+	time = Timer::elapsedSeconds() - time;
+	_logger.log(verb, "sharing time:%.4f adm:%i/%i %s\n", time, 
+		_last_num_admitted_cls_to_import, _last_num_cls_to_import, hist.getReport().c_str());
+}
 
-	while (clause.begin != nullptr) {
-		
-		if (!initialized || clause.size != it.clauseLength || clause.lbd != it.lbd) {
-			initialized = true;
-			float publishTime = Timer::elapsedSeconds();
-			_filter.releaseLock();
+void SharingManager::importClausesToSolvers(const std::vector<Mallob::Clause>& clauses, 
+		const std::vector<uint8_t>& producers, const std::vector<PortfolioSolverInterface*>& solvers) {
 
-			doPublishClauseLists();
+	std::vector<std::forward_list<int>> unitLists(solvers.size());
+	std::vector<std::forward_list<std::pair<int, int>>> binaryLists(solvers.size());
+	std::vector<std::forward_list<Mallob::Clause>> largeLists(solvers.size());
+	std::vector<int> currentCapacities(solvers.size(), -1);
+	std::vector<int> currentAddedLiterals(solvers.size(), 0);
 
-			while (clause.size != it.clauseLength || clause.lbd != it.lbd) {
-				it.nextLengthLbdGroup();
-				explicitLbds = it.storeWithExplicitLbd(/*maxLbdPartitioningSize=*/2);
+	// Method to publish completed clause lists
+	auto doPublishClauseLists = [&](int clauseLength, int lbd) {
+		for (size_t i = 0; i < solvers.size(); i++) {
+			if (clauseLength == 1 && !unitLists[i].empty()) {
+				solvers[i]->addLearnedClauses(clauseLength, lbd, unitLists[i], currentAddedLiterals[i]);
+			} else if (clauseLength == 2 && !binaryLists[i].empty()) {
+				solvers[i]->addLearnedClauses(clauseLength, lbd, binaryLists[i], currentAddedLiterals[i]);
+			} else if (clauseLength > 2 && !largeLists[i].empty()) {
+				solvers[i]->addLearnedClauses(clauseLength, lbd, largeLists[i], currentAddedLiterals[i]);
 			}
+		}
+	};
 
-			for (size_t i = 0; i < importingSolvers.size(); i++) {
-				currentCapacities[i] = importingSolvers[i]->getClauseImportBudget(clause.size, clause.lbd);
+	int currentLength = 0;
+	int currentLbd = 0;
+	for (size_t c = 0; c < clauses.size(); c++) {
+		auto& clause = clauses[c];
+
+		if (clause.size != currentLength || clause.lbd != currentLbd) {
+			// New bucket: publish the lists of the previous bucket, reserve new budgets
+			if (currentLength > 0) doPublishClauseLists(currentLength, currentLbd);
+			currentLength = clause.size;
+			currentLbd = clause.lbd;
+			for (size_t i = 0; i < solvers.size(); i++) {
+				currentCapacities[i] = solvers[i]->getClauseImportBudget(clause.size, clause.lbd);
 				currentAddedLiterals[i] = 0;
 			}
-
-			_filter.acquireLock();
-			publishTime = Timer::elapsedSeconds() - publishTime;
-			_logger.log(verb+2, "DG published clause lists (%.4f s)\n", publishTime);
 		}
 
-		hist.increment(clause.size);
-		uint8_t producers = _filter.getProducers(clause, _internal_epoch);
-
-		for (size_t i = 0; i < importingSolvers.size(); i++) {
-			auto& solver = *importingSolvers[i];
+		for (size_t i = 0; i < solvers.size(); i++) {
+			auto& solver = *solvers[i];
 			int sid = solver.getLocalId();
 			auto& solverStats = _solver_stats[sid];
 			solverStats->receivedClauses++;
@@ -318,36 +333,36 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 				solverStats->receivedClausesDropped++;
 				continue;
 			}
-			uint8_t producerFlag = 1 << sid;
-			if ((producers & (1 << sid)) != 0) {
+			if ((producers[c] & (1 << sid)) != 0) {
 				// filtered by solver filter
 				solverStats->receivedClausesFiltered++;
 				continue;
-			} else {
-				// admitted by solver filter
-				if (clause.size == 1) unitLists[i].push_front(clause.begin[0]);
-				else if (clause.size == 2) binaryLists[i].emplace_front(clause.begin[0], clause.begin[1]);
-				else {
-					std::vector<int> clauseVec((explicitLbds ? 1 : 0) + clause.size);
-					size_t idx = 0;
-					if (explicitLbds) clauseVec[idx++] = clause.lbd;
-					for (size_t k = 0; k < clause.size; k++) clauseVec[idx++] = clause.begin[k];
-					largeLists[i].emplace_front(std::move(clauseVec));
-				}
-				currentCapacities[i] -= clause.size;
-				currentAddedLiterals[i] += clause.size;
 			}
+			// admitted by solver filter
+			if (clause.size == 1) unitLists[i].push_front(clause.begin[0]);
+			else if (clause.size == 2) binaryLists[i].emplace_front(clause.begin[0], clause.begin[1]);
+			else largeLists[i].push_front(clause);
+			currentCapacities[i] -= clause.size;
+			currentAddedLiterals[i] += clause.size;
 		}
+	}
+	if (currentLength > 0) doPublishClauseLists(currentLength, currentLbd);
+}
+
+void SharingManager::runConcurrently(int nbTasks, const std::function<void(int)>& task) {
 
-		clause = reader.getNextIncomingClause();
+	// Tasks are claimed dynamically by the calling thread and by helpers from the thread pool
+	std::atomic_int nextTask {0};
+	auto processTasks = [&]() {
+		for (int i = nextTask.fetch_add(1); i < nbTasks; i = nextTask.fetch_add(1)) task(i);
+	};
+	std::vector<std::future<void>> futures;
+	int nbHelpers = std::min(nbTasks-1, (int) ProcessWideThreadPool::get().getNumThreads());
+	for (int i = 0; i < nbHelpers; i++) {
+		futures.push_back(ProcessWideThreadPool::get().addTask(processTasks));
 	}
-	_filter.releaseLock();
-	doPublishClauseLists();
-	
-	// Process-wide stats
-	time = Timer::elapsedSeconds() - time;
-	_logger.log(verb, "sharing time:%.4f adm:%i/%i %s\n", time, 
-		_last_num_admitted_cls_to_import, _last_num_cls_to_import, hist.getReport().c_str());
+	processTasks();
+	for (auto& future : futures) future.get();
 }
 
 void SharingManager::digestSharingWithoutFilter(int* begin, int buflen) {
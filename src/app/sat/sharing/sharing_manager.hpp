@@ -4,6 +4,7 @@
 #include <cstring>
 #include <memory>
 #include <list>
+#include <functional>
 
 #include "buffer/adaptive_clause_database.hpp"
 #include "../solvers/portfolio_solver_interface.hpp"
@@ -13,6 +14,8 @@
 #include "../data/sharing_statistics.hpp"
 
 #define CLAUSE_LEN_HIST_LENGTH 256
+// Minimum number of clauses per concurrently processed chunk in filterSharing
+#define FILTER_CHUNK_NUM_CLAUSES 2048
 
 class SharingManager {
 
@@ -70,7 +73,7 @@ public:
 			int jobIndex);
 	~SharingManager();
 
-    int prepareSharing(int* begin, int totalLiteralLimit);
+    int prepareSharing(int* begin, int totalLiteralLimit, int capacity);
 	int filterSharing(int* begin, int buflen, int* filterOut);
 	void digestSharingWithFilter(int* begin, int buflen, const int* filter);
     void digestSharingWithoutFilter(int* begin, int buflen);
@@ -100,4 +103,13 @@ private:
 
 	void importClausesToSolver(int solverId, const std::vector<Clause>& clauses, const std::vector<uint32_t>& producersPerClause);
 
+	// Imports the given clauses (in buffer order) into the import buffers of the given solvers,
+	// skipping each clause for the solvers which produced it
+	void importClausesToSolvers(const std::vector<Mallob::Clause>& clauses, const std::vector<uint8_t>& producers,
+		const std::vector<PortfolioSolverInterface*>& solvers);
+
+	// Executes task(0), ..., task(nbTasks-1) using the calling thread
+	// and the process-wide thread pool; returns when all tasks are done
+	void runConcurrently(int nbTasks, const std::function<void(int)>& task);
+
 };
@@ -131,7 +131,16 @@ void Client::readIncomingJobs() {
                 auto filesList = foundJob.getFilesList();
                 if (foundJob.hasFiles()) {
                     LOGGER(log, V3_VERB, "[T] Reading job #%i rev. %i %s ...\n", id, foundJob.description->getRevision(), filesList.c_str());
-                    success = JobReader::read(foundJob.files, foundJob.contentMode, *foundJob.description);
+                    success = JobReader::read(foundJob.files, foundJob.contentMode, *foundJob.description, 
+                        _params.numParserThreads(), _formula_cache.get());
+                    if (success && _params.preprocessFormulas() 
+                            && foundJob.description->getApplication() == JobDescription::ONESHOT_SAT) {
+                        std::unique_ptr<FormulaPreprocessor> preprocessor(new FormulaPreprocessor());
+                        if (preprocessor->preprocess(*foundJob.description)) {
+                            auto lock = _preprocessors_lock.getLock();
+                            _preprocessors[id] = std::move(preprocessor);
+                        }
+                    }
                 } else {
                     foundJob.description->beginInitialization(foundJob.description->getRevision());
                     foundJob.description->endInitialization();
@@ -210,6 +219,9 @@ void Client::handleNewJob(JobMetadata&& data) {
 
 void Client::init() {
 
+    _formula_cache.reset(new FormulaCache(_params.formulaCacheDirectory(), 
+        (size_t) _params.formulaCacheMegabytes() * 1024 * 1024));
+
     // Get ID allocator this client should use
     JobIdAllocator jobIdAllocator(getInternalRank(), getFilesystemInterfacePath());
 
@@ -494,6 +506,17 @@ void Client::handleSendJobResult(MessageHandle& handle) {
     LOG(V2_INFO, "RESPONSE_TIME #%i %.6f rev. %i\n", jobId, Timer::elapsedSeconds()-desc.getArrival(), revision);
     LOG(V2_INFO, "SOLUTION #%i %s rev. %i\n", jobId, resultCode == RESULT_SAT ? "SAT" : "UNSAT", revision);
 
+    // Extend the model of a preprocessed formula to the original formula
+    if (resultCode == RESULT_SAT) {
+        auto lock = _preprocessors_lock.getLock();
+        auto it = _preprocessors.find(jobId);
+        if (it != _preprocessors.end()) {
+            auto model = jobResult.extractSolution();
+            it->second->reconstructModel(model);
+            jobResult.setSolutionToSerialize(model.data(), model.size());
+        }
+    }
+
     std::string resultString = "s " + std::string(resultCode == RESULT_SAT ? "SATISFIABLE" 
                         : resultCode == RESULT_UNSAT ? "UNSATISFIABLE" : "UNKNOWN") + "\n";
     std::vector<std::string> modelStrings;
@@ -576,6 +599,10 @@ void Client::finishJob(int jobId, bool hasIncrementalSuccessors) {
         _done_jobs[jobId] = DoneInfo{_active_jobs[jobId]->getRevision(), _active_jobs[jobId]->getChecksum()};
     }
     if (!hasIncrementalSuccessors) {
+        {
+            auto lock = _preprocessors_lock.getLock();
+            _preprocessors.erase(jobId);
+        }
         _root_nodes.erase(jobId);
         _active_jobs.erase(jobId);
         _sys_state.addLocal(SYSSTATE_PROCESSED_JOBS, 1);
@@ -12,6 +12,8 @@
 #include "util/sys/threading.hpp"
 #include "interface/json_interface.hpp"
 #include "data/job_metadata.hpp"
+#include "data/formula_cache.hpp"
+#include "app/sat/data/formula_preprocessor.hpp"
 #include "comm/sysstate.hpp"
 #include "util/sys/background_worker.hpp"
 #include "util/periodic_event.hpp"
@@ -91,6 +93,11 @@ private:
     std::vector<Connector*> _interface_connectors;
     APIConnector* _api_connector;
     BackgroundWorker _instance_reader;
+    std::unique_ptr<FormulaCache> _formula_cache;
+
+    // Reconstruction data of preprocessed jobs, needed to complete their models
+    std::map<int, std::unique_ptr<FormulaPreprocessor>> _preprocessors;
+    Mutex _preprocessors_lock;
 
     // Number of jobs with a loaded description (taking memory!)
     std::atomic_int _num_loaded_jobs = 0;
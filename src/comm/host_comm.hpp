@@ -36,6 +36,10 @@ private:
     int _active_job_index = -1;
     float _last_contributed_criticality = 0;
 
+    // PID of the host's first worker process, which serves as a namespace
+    // for shared memory segments used by several processes of this host
+    pid_t _leader_pid = Proc::getPid();
+
 public:
     HostComm(MPI_Comm parentComm, const Parameters& params) : _params(params), _parent_comm(parentComm) {}
     ~HostComm() {
@@ -88,10 +92,19 @@ public:
 
         LOG(V2_INFO, "Machine color %i with %i total workers (my rank: %i)\n", 
             color, MyMpi::size(_comm), MyMpi::rank(_comm));
+
+        // Agree on a common key for host-wide shared memory
+        int leaderPid = _leader_pid;
+        MPI_Bcast(&leaderPid, 1, MPI_INT, 0, _comm);
+        _leader_pid = leaderPid;
         
         _sysstate = new SysState<4>(_comm, /*periodSeconds=*/1, SysState<4>::ALLGATHER);
     }
 
+    std::string getSharedMemoryKey() const {
+        return std::to_string(_leader_pid);
+    }
+
     void setRamUsageThisWorkerGbs(float ramGbs) {
         _ram_usage_this_worker_gb = ramGbs;
     }
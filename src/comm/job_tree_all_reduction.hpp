@@ -31,6 +31,19 @@ private:
     bool _has_transformation_at_root = false;
     std::function<AllReduceElement(const AllReduceElement&)> _transformation_at_root;
 
+    // Streaming mode: Each element is split into a fixed number of segments
+    // which are aggregated and sent upwards one after the other, so a parent
+    // can aggregate a segment while later segments are still in flight.
+    // Each message carries the segment index as its last integer.
+    int _nb_segments = 1;
+    std::function<std::vector<AllReduceElement>(AllReduceElement&)> _splitter;
+    std::function<AllReduceElement(std::vector<AllReduceElement>&)> _joiner;
+    std::vector<std::list<AllReduceElement>> _segment_elems;
+    std::vector<std::pair<bool, bool>> _received_child_segments;
+    std::vector<AllReduceElement> _aggregated_segments;
+    int _next_segment = 0;
+    int _aggregating_segment = -1;
+
     bool _has_producer = false;
     bool _reduction_locally_done = false;
     bool _finished = false;
@@ -48,12 +61,37 @@ public:
         _received_child_elems = std::pair<bool, bool>(false, false);
     }
 
+    // Enable streaming mode with the given number of segments (if > 1).
+    // The splitter divides an element into its segments, the joiner (only
+    // invoked at the root) concatenates the aggregated segments.
+    // Must be called before any element is produced or received.
+    void setStreaming(int nbSegments, std::function<std::vector<AllReduceElement>(AllReduceElement&)> splitter,
+            std::function<AllReduceElement(std::vector<AllReduceElement>&)> joiner) {
+        assert(!_has_producer);
+        if (nbSegments <= 1) return;
+        _nb_segments = nbSegments;
+        _splitter = splitter;
+        _joiner = joiner;
+        _segment_elems.resize(_nb_segments);
+        _received_child_segments.assign(_nb_segments, std::pair<bool, bool>(false, false));
+        _aggregated_segments.resize(_nb_segments);
+    }
+    bool isStreaming() const {return _nb_segments > 1;}
+    int getNumSegments() const {return _nb_segments;}
+
     // Set the function to compute the local contribution for the all-reduction.
     // This function is invoked immediately
     void produce(std::function<AllReduceElement()> localProducer) {
         assert(!_has_producer);
         _has_producer = true;
         _local_elem = localProducer();
+        if (isStreaming()) {
+            auto segments = _splitter(_local_elem.value());
+            assert(segments.size() == _nb_segments);
+            for (int i = 0; i < _nb_segments; i++) 
+                _segment_elems[i].push_front(std::move(segments[i]));
+            _local_elem.reset();
+        }
     }
 
     void setTransformationOfElementAtRoot(std::function<AllReduceElement(const AllReduceElement&)> transformation) {
@@ -72,6 +110,10 @@ public:
                     && msg.tag == _base_msg.tag;
         if (!accept) return false;
 
+        if (tag == MSG_JOB_TREE_REDUCTION && isStreaming()) {
+            return receiveSegment(source, msg);
+        }
+
         if (tag == MSG_JOB_TREE_REDUCTION) {
 
             if (_aggregating || _future_aggregate.valid() || _reduction_locally_done) 
@@ -102,6 +144,11 @@ public:
 
         if (_finished) return;
 
+        if (isStreaming()) {
+            advanceStreaming();
+            return;
+        }
+
         if (_child_elems.size() == _num_expected_child_elems && _local_elem.has_value()) {
              
             _child_elems.push_front(std::move(_local_elem.value()));
@@ -139,7 +186,14 @@ public:
 
         if (_finished) return;
 
-        if (!_reduction_locally_done) {
+        if (!_reduction_locally_done && isStreaming()) {
+            // Send neutral element upwards for each segment not sent yet
+            for (int segment = _next_segment; segment < _nb_segments; segment++) {
+                _base_msg.payload = _neutral_elem;
+                _base_msg.payload.push_back(segment);
+                MyMpi::isend(_tree.getParentNodeRank(), MSG_JOB_TREE_REDUCTION, _base_msg);
+            }
+        } else if (!_reduction_locally_done) {
             // Aggregation upwards was not performed yet: Send neutral element upwards
             _base_msg.payload = _neutral_elem;
             MyMpi::isend(_tree.getParentNodeRank(), MSG_JOB_TREE_REDUCTION, _base_msg);
@@ -179,6 +233,76 @@ public:
     }
 
 private:
+    bool receiveSegment(int source, JobMessage& msg) {
+
+        if (_reduction_locally_done || msg.payload.empty()) return false;
+        int segment = msg.payload.back();
+        // Segment must not have been aggregated already
+        if (segment < _next_segment || segment >= _nb_segments) return false;
+
+        // check if this segment comes from a child which didn't already send it
+        auto& received = _received_child_segments[segment];
+        bool fromLeftChild = !received.first && source == _expected_child_ranks.first;
+        bool fromRightChild = !received.second && source == _expected_child_ranks.second;
+        if (!fromLeftChild && !fromRightChild) return false;
+
+        // message accepted: store and check off
+        msg.payload.pop_back();
+        _segment_elems[segment].push_back(std::move(msg.payload));
+        if (fromLeftChild) received.first = true;
+        if (fromRightChild) received.second = true;
+        LOG_ADD_SRC(V5_DEBG, "CS got segment %i", source, segment);
+        advance();
+        return true;
+    }
+
+    void advanceStreaming() {
+
+        if (_aggregating_segment >= 0 && !_aggregating) {
+            // Aggregation of a segment done
+            _future_aggregate.get();
+            int segment = _aggregating_segment;
+            _aggregating_segment = -1;
+            _next_segment++;
+            _segment_elems[segment].clear();
+
+            if (_tree.isRoot()) {
+                _aggregated_segments[segment] = std::move(_aggregated_elem.value());
+            } else {
+                // Send segment to parent right away
+                _base_msg.payload = std::move(_aggregated_elem.value());
+                _base_msg.payload.push_back(segment);
+                MyMpi::isend(_tree.getParentNodeRank(), MSG_JOB_TREE_REDUCTION, _base_msg);
+            }
+
+            if (_next_segment == _nb_segments) {
+                _reduction_locally_done = true;
+                if (_tree.isRoot()) {
+                    AllReduceElement elem = _joiner(_aggregated_segments);
+                    _aggregated_segments.clear();
+                    if (_has_transformation_at_root) elem = _transformation_at_root(elem);
+                    // Begin broadcast
+                    receiveAndForwardFinalElem(std::move(elem));
+                }
+                return;
+            }
+        }
+
+        // Begin aggregation of the next segment (in order) if all contributions are present
+        if (_aggregating_segment < 0 && _has_producer && _next_segment < _nb_segments
+                && _segment_elems[_next_segment].size() == _num_expected_child_elems+1) {
+            
+            int segment = _next_segment;
+            assert(!_future_aggregate.valid());
+            _aggregating_segment = segment;
+            _aggregating = true;
+            _future_aggregate = ProcessWideThreadPool::get().addTask([&, segment]() {
+                _aggregated_elem = _aggregator(_segment_elems[segment]);
+                _aggregating = false;
+            });
+        }
+    }
+
     void receiveAndForwardFinalElem(AllReduceElement&& elem) {
         _finished = true;
         _base_msg.payload = std::move(elem);
@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Recycles the byte buffers of messages in size classes of powers of two,
+// so that sending and receiving a message usually does not allocate memory.
+// A buffer is owned by exactly one party at a time: the pool, a message being
+// sent, or a received message. The pool is not thread-safe; each thread which
+// performs message passing uses a pool of its own.
+class MessageBufferPool {
+
+private:
+    static constexpr int MIN_CLASS_EXPONENT = 6; // 64 bytes
+    static constexpr int NUM_CLASSES = 15; // ... 1 MiB
+    static constexpr size_t MAX_BUFFERS_PER_CLASS = 64;
+    static constexpr size_t MAX_BYTES_PER_CLASS = 1<<21;
+
+    std::vector<std::vector<uint8_t>> _free_buffers[NUM_CLASSES];
+
+public:
+    // Returns an empty buffer whose capacity is at least the provided size.
+    std::vector<uint8_t> acquire(size_t size) {
+        int c = 0;
+        while (c < NUM_CLASSES && getClassCapacity(c) < size) c++;
+        std::vector<uint8_t> buffer;
+        if (c < NUM_CLASSES && !_free_buffers[c].empty()) {
+            buffer = std::move(_free_buffers[c].back());
+            _free_buffers[c].pop_back();
+            return buffer;
+        }
+        buffer.reserve(c < NUM_CLASSES ? getClassCapacity(c) : size);
+        return buffer;
+    }
+
+    // Takes over the provided buffer if it fits into one of the size classes
+    // and if this class is not full yet. Returns whether the buffer was taken.
+    bool release(std::vector<uint8_t>& buffer) {
+        size_t capacity = buffer.capacity();
+        if (capacity < getClassCapacity(0) || capacity >= 2*getClassCapacity(NUM_CLASSES-1)) return false;
+        int c = NUM_CLASSES-1;
+        while (getClassCapacity(c) > capacity) c--;
+        auto& freeBuffers = _free_buffers[c];
+        if (freeBuffers.size() >= MAX_BUFFERS_PER_CLASS
+                || (freeBuffers.size()+1) * getClassCapacity(c) > MAX_BYTES_PER_CLASS)
+            return false;
+        buffer.clear();
+        freeBuffers.push_back(std::move(buffer));
+        return true;
+    }
+
+    size_t getNumPooledBuffers() const {
+        size_t num = 0;
+        for (int c = 0; c < NUM_CLASSES; c++) num += _free_buffers[c].size();
+        return num;
+    }
+
+private:
+    static size_t getClassCapacity(int c) {return ((size_t) 1) << (MIN_CLASS_EXPONENT+c);}
+};
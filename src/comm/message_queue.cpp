@@ -9,34 +9,59 @@
 #include <unistd.h>
 
 #include "util/hashing.hpp"
-#include "util/sys/background_worker.hpp"
+#include "util/sys/thread_pool.hpp"
 #include "util/logger.hpp"
 #include "comm/msgtags.h"
 
-MessageQueue::MessageQueue(int maxMsgSize) : _max_msg_size(maxMsgSize) {
+MessageQueue::MessageQueue(int maxMsgSize, int numPostedReceives, bool commThread) : 
+        _max_msg_size(maxMsgSize), _priorities(MSG_OFFSET_BATCHED) {
     
     MPI_Comm_rank(MPI_COMM_WORLD, &_my_rank);
-    _recv_data = (uint8_t*) malloc(maxMsgSize+20);
+    MPI_Comm_dup(MPI_COMM_WORLD, &_batch_comm);
+    int* tagUb;
+    int flag;
+    MPI_Comm_get_attr(_batch_comm, MPI_TAG_UB, &tagUb, &flag);
+    _max_batch_tag = flag ? *tagUb : 32767; // the latter is guaranteed by MPI
 
     _current_recv_tag = &_default_tag_var;
     _current_send_tag = &_default_tag_var;
 
-    resetReceiveHandle();
+    // Coalesced prioritized messages are prioritized as well
+    setPriority(MSG_COALESCED_PRIORITIZED, 1);
 
-    _batch_assembler.run([&]() {
-        Proc::nameThisThread("MsgAssembler");
-        runFragmentedMessageAssembler();
-    });
-    _gc.run([&]() {
-        Proc::nameThisThread("MsgGarbColl");
-        runGarbageCollector();
-    });
+    _recv_slots.resize(numPostedReceives);
+    _recv_requests.resize(numPostedReceives, MPI_REQUEST_NULL);
+    _recv_done_indices.resize(numPostedReceives);
+    _recv_done_statuses.resize(numPostedReceives);
+    for (int i = 0; i < numPostedReceives; i++) {
+        _recv_slots[i].data = (uint8_t*) malloc(maxMsgSize+20);
+        postReceive(i);
+    }
+
+    if (commThread) {
+        _comm_thread_enabled = true;
+        _comm_thread_running = true;
+        _comm_thread = std::thread([&]() {
+            Proc::nameThisThread("MsgCommThread");
+            runCommThread();
+        });
+    }
 }
 
 MessageQueue::~MessageQueue() {
-    _batch_assembler.stop();
-    _gc.stop();
-    free(_recv_data);
+    stopCommThread();
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        // Withdraw the receives which are still posted
+        for (auto& request : _recv_requests) {
+            if (request == MPI_REQUEST_NULL) continue;
+            MPI_Cancel(&request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+        MPI_Comm_free(&_batch_comm);
+    }
+    for (auto& slot : _recv_slots) free(slot.data);
 }
 
 void MessageQueue::registerCallback(int tag, const MsgCallback& cb) {
@@ -55,18 +80,110 @@ void MessageQueue::registerSentCallback(int tag, const SendDoneCallback& cb) {
     _send_done_callbacks[tag] = cb;
 }
 
+void MessageQueue::registerFragmentCallback(int tag, const FragmentCallback& cb) {
+    if (_fragment_callbacks.count(tag)) {
+        LOG(V0_CRIT, "More than one callback for tag %i!\n", tag);
+        abort();
+    }
+    _fragment_callbacks[tag] = cb;
+}
+
+void MessageQueue::setPriority(int tag, int priority) {
+    assert(tag >= 0 && tag < _priorities.size());
+    _priorities[tag].store(priority, std::memory_order_relaxed);
+}
+
+void MessageQueue::prioritizeSchedulingMessages() {
+    for (int tag : {MSG_REQUEST_NODE, MSG_REQUEST_NODE_ONESHOT, MSG_OFFER_ADOPTION, MSG_OFFER_ADOPTION_OF_ROOT, 
+            MSG_ANSWER_ADOPTION_OFFER, MSG_REJECT_ONESHOT, MSG_NOTIFY_NODE_LEAVING_JOB, 
+            MSG_NOTIFY_JOB_ABORTING, MSG_NOTIFY_JOB_TERMINATING, MSG_INTERRUPT, MSG_QUERY_VOLUME, 
+            MSG_NOTIFY_VOLUME_UPDATE, MSG_REQUEST_WORK, MSG_REQUEST_IDLE_NODE_BFS, MSG_ANSWER_IDLE_NODE_BFS, 
+            MSG_NOTIFY_ASSIGNMENT_UPDATE, MSG_SCHED_INITIALIZE_CHILD_WITH_NODES, MSG_SCHED_RETURN_NODES, 
+            MSG_SCHED_RELEASE_FROM_WAITING, MSG_SCHED_NODE_FREED, MSG_DO_EXIT}) {
+        setPriority(tag, 1);
+    }
+}
+
+int MessageQueue::getPriority(int tag) const {
+    if (tag < 0 || tag >= _priorities.size()) return 0;
+    return _priorities[tag].load(std::memory_order_relaxed);
+}
+
 void MessageQueue::clearCallbacks() {
     _callbacks.clear();
     _send_done_callbacks.clear();
+    _fragment_callbacks.clear();
 }
 
 int MessageQueue::send(DataPtr data, int dest, int tag) {
+    return sendGrowing(data, data->size(), dest, tag);
+}
+
+int MessageQueue::sendGrowing(DataPtr data, size_t totalSize, int dest, int tag) {
+
+    if (dest != _my_rank) {
+        if (_coalescing_threshold > 0 && totalSize <= _coalescing_threshold && data->size() == totalSize 
+                && !_send_done_callbacks.count(tag)) {
+            return coalesce(data, dest, tag);
+        }
+        // Keep the order of messages to this destination
+        flushCoalesced(dest);
+    }
+    return sendDirectly(data, totalSize, dest, tag);
+}
+
+int MessageQueue::coalesce(const DataPtr& data, int dest, int tag) {
+
+    int envelopeTag = getPriority(tag) > 0 ? MSG_COALESCED_PRIORITIZED : MSG_COALESCED;
+    int size = data->size();
+    auto& envelope = _coalesced_messages[std::pair<int, int>(dest, envelopeTag)];
+    if (!envelope.empty() && envelope.size() + 2*sizeof(int) + size > _max_msg_size) {
+        flushCoalesced(dest, envelopeTag);
+    }
+
+    // Append [tag, size, data]
+    auto& buffer = _coalesced_messages[std::pair<int, int>(dest, envelopeTag)];
+    if (buffer.capacity() == 0) buffer = getMainThreadPool().acquire(COALESCING_BUFFER_SIZE);
+    size_t pos = buffer.size();
+    buffer.resize(pos + 2*sizeof(int) + size);
+    memcpy(buffer.data()+pos, &tag, sizeof(int));
+    memcpy(buffer.data()+pos+sizeof(int), &size, sizeof(int));
+    memcpy(buffer.data()+pos+2*sizeof(int), data->data(), size);
+    if (data.use_count() == 1) recycle(getMainThreadPool(), std::move(*data));
+    return nextSendId();
+}
+
+void MessageQueue::flushCoalesced() {
+    if (_coalesced_messages.empty()) return;
+    for (auto& [key, buffer] : _coalesced_messages) {
+        size_t size = buffer.size();
+        sendDirectly(DataPtr(new std::vector<uint8_t>(std::move(buffer))), size, key.first, key.second);
+    }
+    _coalesced_messages.clear();
+}
+
+void MessageQueue::flushCoalesced(int dest) {
+    if (_coalesced_messages.empty()) return;
+    flushCoalesced(dest, MSG_COALESCED_PRIORITIZED);
+    flushCoalesced(dest, MSG_COALESCED);
+}
+
+void MessageQueue::flushCoalesced(int dest, int envelopeTag) {
+    auto it = _coalesced_messages.find(std::pair<int, int>(dest, envelopeTag));
+    if (it == _coalesced_messages.end()) return;
+    DataPtr envelope(new std::vector<uint8_t>(std::move(it->second)));
+    _coalesced_messages.erase(it);
+    sendDirectly(envelope, envelope->size(), dest, envelopeTag);
+}
+
+int MessageQueue::sendDirectly(DataPtr data, size_t totalSize, int dest, int tag) {
 
     *_current_send_tag = tag;
 
     // Initialize send handle
     {
-        SendHandle handle(_running_send_id++, dest, tag, data, _max_msg_size);
+        SendHandle handle(nextSendId(), dest, tag, data, _max_msg_size, _batch_comm, totalSize);
+        handle.priority = getPriority(tag);
 
         int msglen = handle.data->size();
         LOG(V5_DEBG, "MQ SEND n=%i d=[%i] t=%i c=(%i,...,%i,%i,%i)\n", handle.data->size(), dest, tag, 
@@ -77,17 +194,34 @@ int MessageQueue::send(DataPtr data, int dest, int tag) {
 
         if (dest == _my_rank) {
             // Self message
+            assert(handle.data->size() == handle.totalSize);
             _self_recv_queue.push_back(std::move(handle));
             return _self_recv_queue.back().id;
         }
 
+        if (_comm_thread_enabled) {
+            // Hand the message over to the communication thread
+            int id = handle.id;
+            if (handle.data->size() < handle.totalSize) {
+                // The data must not be reallocated while the other thread reads them
+                handle.data->reserve(handle.totalSize);
+                handle.sizeReported = true;
+                handle.reportedSize = handle.data->size();
+                _growing_sends.push_back(GrowingSend{id, handle.data, handle.totalSize, handle.reportedSize});
+            }
+            Command cmd;
+            cmd.handle.reset(new SendHandle(std::move(handle)));
+            _commands.push(std::move(cmd));
+            *_current_send_tag = 0;
+            return id;
+        }
+
         _send_queue.push_back(std::move(handle));
     }
 
     SendHandle& h = _send_queue.back();
-    if (_num_concurrent_sends < _max_concurrent_sends) {
-        h.sendNext();
-        _num_concurrent_sends++;
+    if (h.isNextBatchReady() && (!h.occupiesSendSlot() || _num_concurrent_sends < _max_concurrent_sends)) {
+        initiateSend(h);
     }
 
     *_current_send_tag = 0;
@@ -96,6 +230,15 @@ int MessageQueue::send(DataPtr data, int dest, int tag) {
 
 void MessageQueue::cancelSend(int sendId) {
 
+    if (_comm_thread_enabled) {
+        _growing_sends.remove_if([&](const GrowingSend& send) {return send.id == sendId;});
+        Command cmd;
+        cmd.type = Command::CANCEL;
+        cmd.sendId = sendId;
+        _commands.push(std::move(cmd));
+        return;
+    }
+
     for (auto& h : _send_queue) {
         if (h.id != sendId) continue;
 
@@ -108,90 +251,202 @@ void MessageQueue::cancelSend(int sendId) {
 void MessageQueue::advance() {
     //log(V5_DEBG, "BEGADV\n");
     _iteration++;
-    processReceived();
-    processSelfReceived();
-    processAssembledReceived();
-    processSent();
+    flushCoalesced();
+    if (_comm_thread_enabled) {
+        // The communication thread does the rest
+        reportGrowingSends();
+        processEvents();
+        processSelfReceived();
+    } else {
+        processReceived();
+        processSelfReceived();
+        processFragmentedReceived();
+        processSent();
+    }
+    // Send what the callbacks coalesced
+    flushCoalesced();
     //log(V5_DEBG, "ENDADV\n");
 }
 
-void MessageQueue::runFragmentedMessageAssembler() {
+void MessageQueue::waitForEvents(int timeoutMicros) {
+    uint32_t epoch = _event_signal.getEpoch();
+    if (!_events.empty() || !_self_recv_queue.empty()) return;
+    _event_signal.wait(epoch, timeoutMicros);
+}
+
+void MessageQueue::stopCommThread() {
+    _comm_thread_running = false;
+    if (_comm_thread.joinable()) _comm_thread.join();
+}
 
-    while (_batch_assembler.continueRunning()) {
+void MessageQueue::runCommThread() {
 
-        _fragmented_cond_var.wait(_fragmented_mutex, [&]() {return !_fragmented_queue.empty();});
+    while (_comm_thread_running.load(std::memory_order_relaxed)) {
+        processCommands();
+        processReceived();
+        processFragmentedReceived();
+        processSent();
+        std::this_thread::yield();
+    }
 
-        ReceiveFragment data;
-        {
-            if (!_fragmented_mutex.tryLock()) continue;
-            if (_fragmented_queue.empty()) {
-                _fragmented_mutex.unlock();
-                continue;
+    // Initiate the sends which arrived last
+    processCommands();
+    processSent();
+}
+
+void MessageQueue::processCommands() {
+
+    Command cmd;
+    while (_commands.pop(cmd)) {
+        switch (cmd.type) {
+        case Command::SEND: {
+            _send_queue.push_back(std::move(*cmd.handle));
+            cmd.handle.reset();
+            SendHandle& h = _send_queue.back();
+            if (h.isNextBatchReady() && (!h.occupiesSendSlot() || _num_concurrent_sends < _max_concurrent_sends)) {
+                initiateSend(h);
             }
-            data = std::move(_fragmented_queue.front());
-            _fragmented_queue.pop_front();
-            _fragmented_mutex.unlock();
+            break;
         }
-        if (data.dataFragments.empty()) continue;
-
-        if (data.isCancelled()) {
-            // Receive message was cancelled in between batches: 
-            // concurrently clean up any fragments already received
-            auto lock = _garbage_mutex.getLock();
-            int numFragments = 0;
-            for (auto& frag : data.dataFragments) if (frag != nullptr) {
-                std::vector<uint8_t>* ptr = frag.release();
-                _garbage_queue.push_back(DataPtr(ptr));
-                atomics::incrementRelaxed(_num_garbage);
-                numFragments++;
+        case Command::GROW:
+            for (auto& h : _send_queue) if (h.id == cmd.sendId) {
+                h.reportedSize = cmd.size;
+                break;
             }
-            LOG(V4_VVER, "MSG id=%i cancelled (%i fragments)\n", data.id, numFragments);
-            continue;
+            break;
+        case Command::CANCEL:
+            for (auto& h : _send_queue) if (h.id == cmd.sendId) {
+                h.cancel();
+                break;
+            }
+            break;
         }
+    }
+}
 
-        // Assemble fragments
-        MessageHandle h;
-        h.source = data.source;
-        h.tag = data.tag;
-        size_t sumOfSizes = 0;
-        for (size_t i = 0; i < data.dataFragments.size(); i++) {
-            const auto& frag = data.dataFragments[i];
-            assert(frag || LOG_RETURN_FALSE("No valid fragment %i found!\n", i));
-            sumOfSizes += frag->size();
-        }
-        std::vector<uint8_t> outData(sumOfSizes);
-        size_t offset = 0;
-        for (const auto& frag : data.dataFragments) {
-            memcpy(outData.data()+offset, frag->data(), frag->size());
-            offset += frag->size();
-        }
-        h.setReceive(std::move(outData));
-        // Put into finished queue
-        {
-            auto lock = _fused_mutex.getLock();
-            _fused_queue.push_back(std::move(h));
-            atomics::incrementRelaxed(_num_fused);
+void MessageQueue::reportGrowingSends() {
+
+    // Tell the communication thread how much of each growing message is present
+    for (auto it = _growing_sends.begin(); it != _growing_sends.end();) {
+        auto& send = *it;
+        size_t size = send.data->size();
+        if (size > send.reportedSize) {
+            send.reportedSize = size;
+            Command cmd;
+            cmd.type = Command::GROW;
+            cmd.sendId = send.id;
+            cmd.size = size;
+            _commands.push(std::move(cmd));
         }
+        if (size >= send.totalSize) it = _growing_sends.erase(it);
+        else ++it;
+    }
+}
+
+void MessageQueue::processEvents() {
+
+    // Bounded number of events in order to stay responsive
+    Event event;
+    for (int i = 0; i < 1000 && _events.pop(event); i++) {
+        dispatch(event);
     }
 }
 
-void MessageQueue::runGarbageCollector() {
+void MessageQueue::deliver(Event&& event) {
+    if (_comm_thread_enabled) {
+        _events.push(std::move(event));
+        _event_signal.notify();
+    } else dispatch(event);
+}
+
+void MessageQueue::dispatch(Event& event) {
 
-    while (_gc.continueRunning()) {
-        usleep(1000*1000); // 1s
-        while (_num_garbage > 0) {
-            DataPtr dataPtr;
-            {
-                auto lock = _garbage_mutex.getLock();
-                dataPtr = std::move(_garbage_queue.front());
-                _garbage_queue.pop_front();
+    if (event.type == Event::SENT) {
+        signalCompletion(event.handle.tag, event.sendId);
+        return;
+    }
+
+    if (event.type == Event::FRAGMENT) {
+        auto& frag = event.fragment;
+        auto key = std::pair<int, int>(frag.source, frag.id);
+        bool streamed = _streamed_messages.count(key);
+        if (frag.cancelled) {
+            LOG(V4_VVER, "MSG id=%i cancelled\n", frag.id);
+            if (streamed) {
+                *_current_recv_tag = frag.tag;
+                _fragment_callbacks.at(frag.tag)(frag);
+                *_current_recv_tag = 0;
+                _streamed_messages.erase(key);
             }
-            //if (dataPtr.use_count() > 0) {
-            //    LOG(V4_VVER, "GC %p : use count %i\n", dataPtr.get(), dataPtr.use_count());
-            //}
-            dataPtr.reset();
-            atomics::decrementRelaxed(_num_garbage);
+            recycle(getMainThreadPool(), event.handle.moveRecvData());
+            return;
+        }
+        auto cbIt = _fragment_callbacks.find(frag.tag);
+        if (cbIt != _fragment_callbacks.end() && (streamed || frag.index == 0)) {
+            // Hand the batch to the callback, which may take over the message
+            *_current_recv_tag = frag.tag;
+            bool takenOver = cbIt->second(frag);
+            *_current_recv_tag = 0;
+            if (takenOver) _streamed_messages.insert(key);
         }
+        return;
+    }
+
+    auto& h = event.handle;
+    if (event.messageId != -1) {
+        // Large message: only delivered if no callback took it over
+        LOG(V5_DEBG, "MQ FUSED t=%i\n", h.tag);
+        if (_streamed_messages.erase(std::pair<int, int>(h.source, event.messageId))) {
+            recycle(getMainThreadPool(), h.moveRecvData());
+            return;
+        }
+    }
+
+    if (h.tag == MSG_COALESCED || h.tag == MSG_COALESCED_PRIORITIZED) {
+        dispatchCoalesced(h);
+    } else {
+        // Process message according to its tag-specific callback
+        *_current_recv_tag = h.tag;
+        _callbacks.at(h.tag)(h);
+        *_current_recv_tag = 0;
+    }
+    // Reuse the message's buffer unless the callback took it
+    recycle(getMainThreadPool(), h.moveRecvData());
+}
+
+void MessageQueue::dispatchCoalesced(MessageHandle& envelope) {
+
+    const auto& data = envelope.getRecvData();
+    size_t pos = 0;
+    while (pos < data.size()) {
+        int tag, size;
+        memcpy(&tag, data.data()+pos, sizeof(int));
+        memcpy(&size, data.data()+pos+sizeof(int), sizeof(int));
+        pos += 2*sizeof(int);
+        assert(pos+size <= data.size());
+
+        MessageHandle h;
+        h.tag = tag;
+        h.source = envelope.source;
+        auto buffer = getMainThreadPool().acquire(size);
+        buffer.assign(data.data()+pos, data.data()+pos+size);
+        h.setReceive(std::move(buffer));
+        pos += size;
+
+        *_current_recv_tag = h.tag;
+        _callbacks.at(h.tag)(h);
+        *_current_recv_tag = 0;
+        recycle(getMainThreadPool(), h.moveRecvData());
+    }
+}
+
+void MessageQueue::recycle(MessageBufferPool& pool, std::vector<uint8_t>&& data) {
+    std::vector<uint8_t> buffer(std::move(data));
+    if (pool.release(buffer)) return;
+    if (buffer.capacity() > _max_msg_size) {
+        // Deallocating a large chunk of data takes a while: do it in the background
+        auto dataToFree = new std::vector<uint8_t>(std::move(buffer));
+        ProcessWideThreadPool::get().addTask([dataToFree]() {delete dataToFree;});
     }
 }
 
@@ -199,86 +454,208 @@ void MessageQueue::processReceived() {
 
     int k = 0;
     while (k < _num_receives_per_loop) {
-        k++;
 
-        // Test receive
+        // Test all posted receives at once
         //log(V5_DEBG, "MQ TEST\n");
-        int flag = false;
-        MPI_Status status;
-        MPI_Test(&_recv_request, &flag, &status);
-        if (!flag) {
-            // Handle is not finished:
+        int numDone = 0;
+        MPI_Testsome(_recv_requests.size(), _recv_requests.data(), &numDone, 
+            _recv_done_indices.data(), _recv_done_statuses.data());
+        if (numDone == MPI_UNDEFINED) numDone = 0;
+        for (int i = 0; i < numDone; i++) {
+            auto& slot = _recv_slots[_recv_done_indices[i]];
+            slot.done = true;
+            slot.status = _recv_done_statuses[i];
+        }
+
+        int slotIdx = selectNextReceived();
+        if (slotIdx == -1) {
+            // No message to process:
             // reset #receives per loop
             _num_receives_per_loop = _base_num_receives_per_loop;
             return;
         }
+        k++;
+        handleReceived(slotIdx);
+    }
 
-        // Message finished
-        const int source = status.MPI_SOURCE;
-        int tag = status.MPI_TAG;
-        int msglen;
-        MPI_Get_count(&status, MPI_BYTE, &msglen);
-        LOG(V5_DEBG, "MQ RECV n=%i s=[%i] t=%i c=(%i,...,%i,%i,%i)\n", msglen, source, tag, 
-                msglen>=1*sizeof(int) ? *(int*)(_recv_data) : 0, 
-                msglen>=3*sizeof(int) ? *(int*)(_recv_data+msglen - 3*sizeof(int)) : 0, 
-                msglen>=2*sizeof(int) ? *(int*)(_recv_data+msglen - 2*sizeof(int)) : 0, 
-                msglen>=1*sizeof(int) ? *(int*)(_recv_data+msglen - 1*sizeof(int)) : 0);
-
-        if (tag >= MSG_OFFSET_BATCHED) {
-            // Fragment of a message
-
-            tag -= MSG_OFFSET_BATCHED;
-            int id = ReceiveFragment::readId(_recv_data, msglen);
-            auto key = std::pair<int, int>(source, id);
-            
-            if (!_fragmented_messages.count(key)) {
-                _fragmented_messages.emplace(key, ReceiveFragment(source, id, tag));
-            }
-            auto& fragment = _fragmented_messages[key];
+    // Increase #receives per loop for the next time, if necessary
+    if (k == _num_receives_per_loop && _num_receives_per_loop < 1000) {
+        _num_receives_per_loop *= 2;
+    }
+}
 
-            fragment.receiveNext(source, tag, _recv_data, msglen);
+int MessageQueue::selectNextReceived() const {
+
+    // Prioritized messages: highest priority first, then in order of arrival
+    int best = -1;
+    int bestPriority = 0;
+    for (int i = 0; i < _recv_slots.size(); i++) {
+        const auto& slot = _recv_slots[i];
+        if (!slot.done) continue;
+        int priority = getPriority(slot.status.MPI_TAG);
+        if (priority > bestPriority || (priority == bestPriority && priority > 0 
+                && slot.postIndex < _recv_slots[best].postIndex)) {
+            best = i;
+            bestPriority = priority;
+        }
+    }
+    if (best != -1) return best;
 
-            resetReceiveHandle();
+    // Other messages: only the earliest one, and only if it has arrived completely
+    for (int i = 0; i < _recv_slots.size(); i++) {
+        if (best == -1 || _recv_slots[i].postIndex < _recv_slots[best].postIndex) best = i;
+    }
+    return _recv_slots[best].done ? best : -1;
+}
 
-            if (fragment.isCancelled() || fragment.isFinished()) {
-                {
-                    auto lock = _fragmented_mutex.getLock();
-                    _fragmented_queue.push_back(std::move(fragment));
-                    _fragmented_messages.erase(key);
-                }
-                _fragmented_cond_var.notify();
-            }
+void MessageQueue::handleReceived(int slotIdx) {
+
+    // Message finished
+    auto& slot = _recv_slots[slotIdx];
+    const uint8_t* data = slot.data;
+    const int source = slot.status.MPI_SOURCE;
+    int tag = slot.status.MPI_TAG;
+    int msglen;
+    MPI_Get_count(&slot.status, MPI_BYTE, &msglen);
+    LOG(V5_DEBG, "MQ RECV n=%i s=[%i] t=%i c=(%i,...,%i,%i,%i)\n", msglen, source, tag, 
+            msglen>=1*sizeof(int) ? *(int*)(data) : 0, 
+            msglen>=3*sizeof(int) ? *(int*)(data+msglen - 3*sizeof(int)) : 0, 
+            msglen>=2*sizeof(int) ? *(int*)(data+msglen - 2*sizeof(int)) : 0, 
+            msglen>=1*sizeof(int) ? *(int*)(data+msglen - 1*sizeof(int)) : 0);
+
+    if (tag >= MSG_OFFSET_BATCHED) {
+        // Announcement or cancellation of a large message
+        BatchHeader header;
+        assert(msglen == sizeof(BatchHeader));
+        memcpy(&header, data, sizeof(BatchHeader));
+        postReceive(slotIdx);
+        processBatchHeader(source, tag - MSG_OFFSET_BATCHED, header);
+        return;
+    }
 
-            // Receive next message
-            continue;
-        }
+    // Single message
+    //log(V5_DEBG, "MQ singlerecv\n");
+    Event event;
+    auto buffer = _pool.acquire(msglen);
+    buffer.assign(data, data+msglen);
+    event.handle.setReceive(std::move(buffer));
+    event.handle.tag = tag;
+    event.handle.source = source;
 
-        // Single message
-        //log(V5_DEBG, "MQ singlerecv\n");
-        MessageHandle h;
-        h.setReceive(std::vector<uint8_t>(_recv_data, _recv_data+msglen));
-        h.tag = tag;
-        h.source = source;
+    postReceive(slotIdx);
 
-        resetReceiveHandle();
+    deliver(std::move(event));
+}
 
-        // Process message according to its tag-specific callback
-        *_current_recv_tag = h.tag;
-        _callbacks.at(h.tag)(h);
-        *_current_recv_tag = 0;
+void MessageQueue::processBatchHeader(int source, int tag, const BatchHeader& header) {
+
+    auto key = std::pair<int, int>(source, header.id);
+    if (header.numSentBatches >= 0) {
+        // Cancellation: only the batches sent so far are going to arrive
+        auto it = _fragmented_messages.find(key);
+        if (it != _fragmented_messages.end()) it->second.cancel(header.numSentBatches);
+        return;
     }
 
-    // Increase #receives per loop for the next time, if necessary
-    if (k == _num_receives_per_loop && _num_receives_per_loop < 1000) {
-        _num_receives_per_loop *= 2;
+    // Allocate the full message and begin receiving its first batches in place
+    // unless the batch tag is still used by an earlier message from this source
+    ReceiveFragment fragment(source, tag, header);
+    fragment.arrivalIndex = _num_arrived_fragmented_messages++;
+    for (auto& [otherKey, other] : _fragmented_messages) {
+        if (other.source == source && other.batchTag == header.batchTag) fragment.blocked = true;
+    }
+    auto [it, inserted] = _fragmented_messages.emplace(key, std::move(fragment));
+    assert(inserted);
+    it->second.postReceives(_batch_comm);
+}
+
+void MessageQueue::processFragmentedReceived() {
+
+    std::vector<std::pair<int, int>> doneKeys;
+    for (auto& [key, fragment] : _fragmented_messages) {
+
+        while (fragment.testNext()) {
+            int index = fragment.numReceived-1;
+            Event event;
+            event.type = Event::FRAGMENT;
+            event.fragment = Fragment {fragment.source, fragment.id, fragment.tag, index, fragment.totalNumBatches, 
+                fragment.data.data()+fragment.getBatchBegin(index), fragment.getBatchSize(index), false};
+            deliver(std::move(event));
+        }
+        fragment.postReceives(_batch_comm);
+
+        if (fragment.isCancellationComplete()) {
+            // The fragments delivered so far refer to the data: hand them over as well
+            Event event;
+            event.type = Event::FRAGMENT;
+            event.fragment = Fragment {fragment.source, fragment.id, fragment.tag, 0, 0, nullptr, 0, true};
+            event.handle.setReceive(std::move(fragment.data));
+            deliver(std::move(event));
+            doneKeys.push_back(key);
+        } else if (fragment.isFinished()) {
+            // The message is already assembled: deliver it right away
+            Event event;
+            event.messageId = fragment.id;
+            event.handle.source = fragment.source;
+            event.handle.tag = fragment.tag;
+            event.handle.setReceive(std::move(fragment.data));
+            deliver(std::move(event));
+            doneKeys.push_back(key);
+        }
+    }
+
+    for (auto& key : doneKeys) {
+        auto it = _fragmented_messages.find(key);
+        int source = it->second.source;
+        int batchTag = it->second.batchTag;
+        _fragmented_messages.erase(it);
+
+        // Unblock the earliest message waiting for the same batch tag
+        ReceiveFragment* next = nullptr;
+        for (auto& [otherKey, other] : _fragmented_messages) {
+            if (other.source != source || other.batchTag != batchTag) continue;
+            if (next == nullptr || other.arrivalIndex < next->arrivalIndex) next = &other;
+        }
+        if (next != nullptr && next->blocked) {
+            next->blocked = false;
+            next->postReceives(_batch_comm);
+        }
     }
 }
 
-void MessageQueue::resetReceiveHandle() {
+void MessageQueue::postReceive(int slotIdx) {
     // Reset recv handle
     //log(V5_DEBG, "MQ MPI_Irecv\n");
-    MPI_Irecv(_recv_data, _max_msg_size+20, MPI_BYTE, MPI_ANY_SOURCE, 
-        MPI_ANY_TAG, MPI_COMM_WORLD, &_recv_request);
+    auto& slot = _recv_slots[slotIdx];
+    slot.done = false;
+    slot.postIndex = _num_posted_receives++;
+    MPI_Irecv(slot.data, _max_msg_size+20, MPI_BYTE, MPI_ANY_SOURCE, 
+        MPI_ANY_TAG, MPI_COMM_WORLD, &_recv_requests[slotIdx]);
+}
+
+void MessageQueue::initiateSend(SendHandle& h) {
+    if (h.isBatched() && !h.isCancelled()) h.batchTag = acquireBatchTag(h.dest);
+    h.sendNext();
+    if (h.occupiesSendSlot()) _num_concurrent_sends++;
+}
+
+int MessageQueue::nextSendId() {
+    // Positive ids only, also after wrapping around
+    int id = _running_send_id;
+    _running_send_id = id == INT32_MAX ? 1 : id+1;
+    return id;
+}
+
+int MessageQueue::acquireBatchTag(int dest) {
+    // Cycle through all valid tags, skipping the ones in use for this destination
+    while (true) {
+        int batchTag = _running_batch_tag++ % ((unsigned int) _max_batch_tag + 1);
+        if (_used_batch_tags.insert(std::pair<int, int>(dest, batchTag)).second) return batchTag;
+    }
+}
+
+void MessageQueue::releaseBatchTag(int dest, int batchTag) {
+    _used_batch_tags.erase(std::pair<int, int>(dest, batchTag));
 }
 
 void MessageQueue::signalCompletion(int tag, int id) {
@@ -307,44 +684,7 @@ void MessageQueue::processSelfReceived() {
         _callbacks.at(h.tag)(h);
         signalCompletion(h.tag, sh.id);
         *_current_recv_tag = 0;
-    }
-}
-
-void MessageQueue::processAssembledReceived() {
-
-    int numFused = _num_fused.load(std::memory_order_relaxed);
-    if (numFused > 0 && _fused_mutex.tryLock()) {
-
-        int consumed = 0;
-        while (!_fused_queue.empty() && consumed < 4) {
-
-            auto& h = _fused_queue.front();
-            LOG(V5_DEBG, "MQ FUSED t=%i\n", h.tag);
-            
-            *_current_recv_tag = h.tag;
-            _callbacks.at(h.tag)(h);
-            *_current_recv_tag = 0;
-            
-            if (h.getRecvData().size() > _max_msg_size) {
-                // Concurrent deallocation of large chunk of data
-                auto lock = _garbage_mutex.getLock();
-                _garbage_queue.push_back(
-                    DataPtr(
-                        new std::vector<uint8_t>(
-                            h.moveRecvData()
-                        )
-                    )
-                );
-                atomics::incrementRelaxed(_num_garbage);
-            }
-            _fused_queue.pop_front();
-            atomics::decrementRelaxed(_num_fused);
-
-            consumed++;
-            if (consumed >= 4) break;
-        }
-
-        _fused_mutex.unlock();
+        recycle(getMainThreadPool(), h.moveRecvData());
     }
 }
 
@@ -358,6 +698,16 @@ void MessageQueue::processSent() {
         
         SendHandle& h = *it;
 
+        if (h.awaitingData) {
+            // Growing message: send the next batch as soon as it is present
+            if (h.isNextBatchReady()) {
+                h.awaitingData = false;
+                h.sendNext();
+            }
+            ++it;
+            continue;
+        }
+
         if (!h.isInitiated()) {
             // Message has not been sent yet
             uninitiatedHandlesPresent = true;
@@ -377,35 +727,31 @@ void MessageQueue::processSent() {
         // Batched?
         if (h.isBatched()) {
             // Batch of a large message sent
-            LOG(V5_DEBG, "MQ SENT id=%i %i/%i n=%i d=[%i] t=%i c=(%i,...,%i,%i,%i)\n", h.id, h.sentBatches, 
-                h.totalNumBatches, h.data->size(), h.dest, h.tag, 
-                *(int*)(h.tempStorage.data()), 
-                *(int*)(h.tempStorage.data()+h.tempStorage.size()-3*sizeof(int)), 
-                *(int*)(h.tempStorage.data()+h.tempStorage.size()-2*sizeof(int)),
-                *(int*)(h.tempStorage.data()+h.tempStorage.size()-1*sizeof(int)));
+            LOG(V5_DEBG, "MQ SENT id=%i %i/%i n=%i d=[%i] t=%i\n", h.id, h.sentBatches, 
+                h.totalNumBatches, h.getDataSize(), h.dest, h.tag);
 
             // More batches yet to send?
             if (!h.isFinished()) {
-                // Send next batch
-                h.sendNext();
+                // Send next batch (once its data are present)
+                if (h.isNextBatchReady()) h.sendNext();
+                else h.awaitingData = true;
                 completed = false;
             }
         }
 
         if (completed) {
             // Notify completion
-            signalCompletion(h.tag, h.id);
-            _num_concurrent_sends--;
-
-            if (h.data->size() > _max_msg_size) {
-                // Concurrent deallocation of SendHandle's large chunk of data
-                auto lock = _garbage_mutex.getLock();
-                _garbage_queue.push_back(std::move(h.data));
-                atomics::incrementRelaxed(_num_garbage);
-            } else {
-                // Direct deallocation of SendHandle's data
-                h.data.reset();
-            }
+            Event event;
+            event.type = Event::SENT;
+            event.handle.tag = h.tag;
+            event.sendId = h.id;
+            deliver(std::move(event));
+            if (h.occupiesSendSlot()) _num_concurrent_sends--;
+            if (h.batchTag >= 0) releaseBatchTag(h.dest, h.batchTag);
+
+            // Reuse SendHandle's data if no one else refers to them
+            if (h.data.use_count() == 1) recycle(_pool, std::move(*h.data));
+            h.data.reset();
             
             // Remove handle
             it = _send_queue.erase(it); // go to next handle
@@ -417,14 +763,13 @@ void MessageQueue::processSent() {
     if (!uninitiatedHandlesPresent) return;
 
     // Initiate sending messages which have not been initiated yet
-    // as long as there is a "send slot" available to do so
-    it = _send_queue.begin();
-    while (_num_concurrent_sends < _max_concurrent_sends && it != _send_queue.end()) {
-        SendHandle& h = *it;
-        if (!h.isInitiated()) {
-            h.sendNext();
-            _num_concurrent_sends++;
+    // as long as there is a "send slot" available to do so,
+    // beginning with prioritized messages
+    for (bool prioritized : {true, false}) {
+        for (auto& h : _send_queue) {
+            if (h.isInitiated() || h.awaitingData || (h.priority > 0) != prioritized || !h.isNextBatchReady()) continue;
+            if (h.occupiesSendSlot() && _num_concurrent_sends >= _max_concurrent_sends) continue;
+            initiateSend(h);
         }
-        ++it;
     }
 }
@@ -6,110 +6,124 @@
 
 #include <list>
 #include <cmath>
+#include <thread>
 #include "util/assert.hpp"
 #include <unistd.h>
 
 #include "util/hashing.hpp"
-#include "util/sys/background_worker.hpp"
 #include "util/logger.hpp"
 #include "comm/msgtags.h"
+#include "comm/message_buffer_pool.hpp"
 #include "util/sys/atomics.hpp"
+#include "util/sys/futex.hpp"
+#include "util/sys/spsc_queue.hpp"
 
 typedef std::shared_ptr<std::vector<uint8_t>> DataPtr;
 typedef std::unique_ptr<std::vector<uint8_t>> UniqueDataPtr;
 typedef std::shared_ptr<const std::vector<uint8_t>> ConstDataPtr; 
 
 class MessageQueue {
+
+public:
+    // A single fragment of a large message, as seen upon its arrival
+    struct Fragment {
+        int source;
+        int id;
+        int tag;
+        int index;
+        int total;
+        const uint8_t* data;
+        size_t size;
+        bool cancelled;
+    };
     
 private:
+    // Announces a large message to its receiver before any of its batches is sent,
+    // or notifies the receiver that the message was cancelled (numSentBatches >= 0).
+    struct BatchHeader {
+        int id;
+        int batchTag;
+        int totalNumBatches;
+        int sizePerBatch;
+        int numSentBatches;
+        size_t totalSize;
+    };
+
+    // The batches of a large message are exchanged over a separate communicator
+    // with a tag which the sender assigns when announcing the message. A tag is
+    // not reused for a destination while another batched send to it holds the tag.
+
+    // Max. number of batch receives posted ahead per incoming message
+    static constexpr int MAX_POSTED_BATCHES = 4;
+
     struct ReceiveFragment {
         
         int source = -1;
         int id = -1;
         int tag = -1;
-        int receivedFragments = 0;
-        std::vector<UniqueDataPtr> dataFragments;
-        bool cancelled = false;
+        int batchTag = -1;
+        // Receives for the batches are only posted as soon as no earlier message
+        // from the same source with the same batch tag is being received anymore
+        bool blocked = false;
+        unsigned long long arrivalIndex = 0;
+        int totalNumBatches = 0;
+        int sizePerBatch = 0;
+        std::vector<uint8_t> data; // each batch is received at its final position
+        std::vector<MPI_Request> requests;
+        int numPosted = 0;
+        int numReceived = 0;
+        int numSentBeforeCancel = -1;
         
         ReceiveFragment() = default;
-        ReceiveFragment(int source, int id, int tag) : source(source), id(id), tag(tag) {}
-
-        ReceiveFragment(ReceiveFragment&& moved) {
-            source = moved.source;
-            id = moved.id;
-            tag = moved.tag;
-            receivedFragments = moved.receivedFragments;
-            dataFragments = std::move(moved.dataFragments);
-            cancelled = moved.cancelled;
-            moved.id = -1;
-        }
-        ReceiveFragment& operator=(ReceiveFragment&& moved) {
-            source = moved.source;
-            id = moved.id;
-            tag = moved.tag;
-            receivedFragments = moved.receivedFragments;
-            dataFragments = std::move(moved.dataFragments);
-            cancelled = moved.cancelled;
-            moved.id = -1;
-            return *this;
-        }
+        ReceiveFragment(int source, int tag, const BatchHeader& header) : source(source), id(header.id), tag(tag),
+                batchTag(header.batchTag), totalNumBatches(header.totalNumBatches), sizePerBatch(header.sizePerBatch), 
+                data(header.totalSize), requests(header.totalNumBatches, MPI_REQUEST_NULL) {}
 
         bool valid() const {return id != -1;}
-        bool isCancelled() const {return cancelled;}
+        bool isCancelled() const {return numSentBeforeCancel >= 0;}
+        bool isFinished() const {return numReceived == totalNumBatches;}
 
-        static int readId(uint8_t* data, int msglen) {
-            return * (int*) (data+msglen - 3*sizeof(int));
+        size_t getBatchBegin(int index) const {return (size_t)index * sizePerBatch;}
+        size_t getBatchSize(int index) const {
+            return std::min(data.size(), getBatchBegin(index+1)) - getBatchBegin(index);
         }
 
-        void receiveNext(int source, int tag, uint8_t* data, int msglen) {
-            assert(this->source >= 0);
-            assert(valid());
-
-            int id, sentBatch, totalNumBatches;
-            // Read meta data from end of message
-            memcpy(&id,              data+msglen - 3*sizeof(int), sizeof(int));
-            memcpy(&sentBatch,       data+msglen - 2*sizeof(int), sizeof(int));
-            memcpy(&totalNumBatches, data+msglen - 1*sizeof(int), sizeof(int));
-            msglen -= 3*sizeof(int);
-            
-            if (msglen == 0 && sentBatch == 0 && totalNumBatches == 0) {
-                // Message was cancelled!
-                cancelled = true;
-                return;
+        // Keep up to MAX_POSTED_BATCHES receives for upcoming batches
+        void postReceives(MPI_Comm comm) {
+            if (blocked) return;
+            int limit = isCancelled() ? numSentBeforeCancel : totalNumBatches;
+            while (numPosted < limit && numPosted - numReceived < MAX_POSTED_BATCHES) {
+                MPI_Irecv(data.data()+getBatchBegin(numPosted), getBatchSize(numPosted), MPI_BYTE, 
+                    source, batchTag, comm, &requests[numPosted]);
+                numPosted++;
             }
+        }
 
-            if (sentBatch == 0 || sentBatch+1 == totalNumBatches) {
-                LOG(V4_VVER, "RECVB %i %i/%i %i\n", id, sentBatch+1, totalNumBatches, source);
+        // Returns true iff the next batch has been received completely
+        bool testNext() {
+            if (numReceived == numPosted) return false;
+            int flag = false;
+            MPI_Test(&requests[numReceived], &flag, MPI_STATUS_IGNORE);
+            if (!flag) return false;
+            if (numReceived == 0 || numReceived+1 == totalNumBatches) {
+                LOG(V4_VVER, "RECVB %i %i/%i %i\n", id, numReceived+1, totalNumBatches, source);
             } else {
-                LOG(V5_DEBG, "RECVB %i %i/%i %i\n", id, sentBatch+1, totalNumBatches, source);
+                LOG(V5_DEBG, "RECVB %i %i/%i %i\n", id, numReceived+1, totalNumBatches, source);
             }
-
-            // Store data in fragments structure
-            
-            //log(V5_DEBG, "MQ STORE (%i,%i) %i/%i\n", source, id, sentBatch, totalNumBatches);
-
-            assert(this->source == source);
-            assert(this->id == id || LOG_RETURN_FALSE("%i != %i\n", this->id, id));
-            assert(this->tag == tag);
-            assert(sentBatch < totalNumBatches || LOG_RETURN_FALSE("Invalid batch %i/%i!\n", sentBatch, totalNumBatches));
-            if (totalNumBatches > dataFragments.size()) dataFragments.resize(totalNumBatches);
-            assert(receivedFragments >= 0 || LOG_RETURN_FALSE("Batched message was already completed!\n"));
-
-            //log(V5_DEBG, "MQ STORE alloc\n");
-            assert(dataFragments[sentBatch] == nullptr || LOG_RETURN_FALSE("Batch %i/%i already present!\n", sentBatch, totalNumBatches));
-            dataFragments[sentBatch].reset(new std::vector<uint8_t>(data, data+msglen));
-            
-            //log(V5_DEBG, "MQ STORE produce\n");
-            // All fragments of the message received?
-            receivedFragments++;
-            if (receivedFragments == totalNumBatches)
-                receivedFragments = -1;
+            numReceived++;
+            return true;
         }
 
-        bool isFinished() {
-            assert(valid());
-            return receivedFragments == -1;
+        // Withdraw the receives for batches which the sender will not send anymore
+        void cancel(int numSentBatches) {
+            numSentBeforeCancel = numSentBatches;
+            for (int i = std::max(numReceived, numSentBatches); i < numPosted; i++) {
+                MPI_Cancel(&requests[i]);
+                MPI_Wait(&requests[i], MPI_STATUS_IGNORE);
+            }
+            numPosted = std::max(numReceived, std::min(numPosted, numSentBatches));
         }
+        bool isCancellationComplete() const {return isCancelled() && numReceived >= numSentBeforeCancel;}
     };
 
     struct SendHandle {
@@ -117,50 +131,57 @@ private:
         int id = -1;
         int dest;
         int tag;
+        int batchTag = -1; // assigned upon initiating a batched send
+        MPI_Comm batchComm;
         MPI_Request request = MPI_REQUEST_NULL;
+        MPI_Request headerRequest = MPI_REQUEST_NULL;
         DataPtr data;
+        size_t totalSize; // may exceed data->size() while the data are still growing
         int sentBatches = -1;
         int totalNumBatches;
         int sizePerBatch;
-        std::vector<uint8_t> tempStorage;
+        bool awaitingData = false; // previous batch sent, next one not present yet
+        int priority = 0;
+        bool sizeReported = false; // data are growing in another thread, which reports their size
+        size_t reportedSize = 0;
+        BatchHeader header;
+        std::vector<uint8_t> tempStorage; // only for growing data which may still be reallocated
         
-        SendHandle(int id, int dest, int tag, DataPtr data, int maxMsgSize) 
-            : id(id), dest(dest), tag(tag), data(data) {
+        SendHandle(int id, int dest, int tag, DataPtr data, int maxMsgSize, MPI_Comm batchComm, size_t totalSize = 0) 
+            : id(id), dest(dest), tag(tag), batchComm(batchComm), data(data), totalSize(std::max(totalSize, data->size())) {
 
             sizePerBatch = maxMsgSize;
             sentBatches = 0;
-            totalNumBatches = data->size() <= sizePerBatch+3*sizeof(int) ? 1 
-                : std::ceil(data->size() / (float)sizePerBatch);
+            totalNumBatches = this->totalSize <= sizePerBatch+3*sizeof(int) ? 1 
+                : std::ceil(this->totalSize / (float)sizePerBatch);
         }
 
         bool valid() {return id != -1;}
         
         SendHandle(SendHandle&& moved) {
-            assert(moved.valid());
-            id = moved.id;
-            dest = moved.dest;
-            tag = moved.tag;
-            request = moved.request;
-            data = std::move(moved.data);
-            sentBatches = moved.sentBatches;
-            totalNumBatches = moved.totalNumBatches;
-            sizePerBatch = moved.sizePerBatch;
-            tempStorage = std::move(moved.tempStorage);
-            
-            moved.id = -1;
-            moved.data = DataPtr();
-            moved.request = MPI_REQUEST_NULL;
+            *this = std::move(moved);
         }
         SendHandle& operator=(SendHandle&& moved) {
             assert(moved.valid());
+            // Pending sends refer to the header: must not be moved anymore
+            assert(moved.headerRequest == MPI_REQUEST_NULL);
             id = moved.id;
             dest = moved.dest;
             tag = moved.tag;
+            batchTag = moved.batchTag;
+            batchComm = moved.batchComm;
             request = moved.request;
+            headerRequest = moved.headerRequest;
             data = std::move(moved.data);
+            totalSize = moved.totalSize;
             sentBatches = moved.sentBatches;
             totalNumBatches = moved.totalNumBatches;
             sizePerBatch = moved.sizePerBatch;
+            awaitingData = moved.awaitingData;
+            priority = moved.priority;
+            sizeReported = moved.sizeReported;
+            reportedSize = moved.reportedSize;
+            header = moved.header;
             tempStorage = std::move(moved.tempStorage);
             
             moved.id = -1;
@@ -178,11 +199,29 @@ private:
             assert(request != MPI_REQUEST_NULL);
             int flag = false;
             MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
-            return flag;
+            if (!flag) return false;
+            if (headerRequest != MPI_REQUEST_NULL) {
+                MPI_Test(&headerRequest, &flag, MPI_STATUS_IGNORE);
+                if (!flag) {
+                    // Keep the handle initiated until the header is sent as well
+                    std::swap(request, headerRequest);
+                    return false;
+                }
+            }
+            return true;
         }
 
         bool isFinished() const {return sentBatches == totalNumBatches;}
 
+        size_t getDataSize() const {return sizeReported ? reportedSize : data->size();}
+
+        // Whether the data of the next batch to send are present
+        bool isNextBatchReady() const {
+            if (isCancelled()) return true;
+            if (!isBatched()) return getDataSize() == totalSize;
+            return getDataSize() >= std::min(totalSize, (size_t)(sentBatches+1)*sizePerBatch);
+        }
+
         void sendNext() {
             assert(valid());
             assert(!isFinished() || LOG_RETURN_FALSE("Handle (n=%i) already finished!\n", sentBatches));
@@ -196,32 +235,34 @@ private:
             }
 
             if (isCancelled()) {
-                int zero = 0;
-                if (tempStorage.size() < 3*sizeof(int)) tempStorage.resize(3*sizeof(int));
-                memcpy(tempStorage.data(), &id, sizeof(int));
-                memcpy(tempStorage.data()+sizeof(int), &zero, sizeof(int));
-                memcpy(tempStorage.data()+2*sizeof(int), &zero, sizeof(int));
-                MPI_Isend(tempStorage.data(), 3*sizeof(int), MPI_BYTE, 
+                // Tell the receiver how many batches it is going to receive
+                header = BatchHeader{id, batchTag, totalNumBatches, -1, sentBatches, totalSize};
+                MPI_Isend(&header, sizeof(BatchHeader), MPI_BYTE, 
                     dest, tag+MSG_OFFSET_BATCHED, MPI_COMM_WORLD, &request);
                 sentBatches = totalNumBatches; // mark as finished
                 return;
             }
 
+            if (sentBatches == 0) {
+                // Announce the message's size so that the receiver can allocate it at once
+                assert(batchTag >= 0);
+                header = BatchHeader{id, batchTag, totalNumBatches, sizePerBatch, -1, totalSize};
+                MPI_Isend(&header, sizeof(BatchHeader), MPI_BYTE, 
+                    dest, tag+MSG_OFFSET_BATCHED, MPI_COMM_WORLD, &headerRequest);
+            }
+
             size_t begin = sentBatches*sizePerBatch;
-            size_t end = std::min(data->size(), (size_t)(sentBatches+1)*sizePerBatch);
+            size_t end = std::min(totalSize, (size_t)(sentBatches+1)*sizePerBatch);
+            assert(end <= getDataSize());
             assert(end>begin || LOG_RETURN_FALSE("%ld <= %ld\n", end, begin));
-            size_t msglen = (end-begin)+3*sizeof(int);
-            if (msglen > tempStorage.size()) tempStorage.resize(msglen);
-
-            // Copy actual data
-            memcpy(tempStorage.data(), data->data()+begin, end-begin);
-            // Copy meta data at insertion point
-            memcpy(tempStorage.data()+(end-begin), &id, sizeof(int));
-            memcpy(tempStorage.data()+(end-begin)+sizeof(int), &sentBatches, sizeof(int));
-            memcpy(tempStorage.data()+(end-begin)+2*sizeof(int), &totalNumBatches, sizeof(int));
 
-            MPI_Isend(tempStorage.data(), msglen, MPI_BYTE, dest, 
-                    tag+MSG_OFFSET_BATCHED, MPI_COMM_WORLD, &request);
+            // Send directly from the data unless they may still be moved by a reallocation
+            const uint8_t* batch = data->data()+begin;
+            if (data->capacity() < totalSize) {
+                tempStorage.assign(data->data()+begin, data->data()+end);
+                batch = tempStorage.data();
+            }
+            MPI_Isend(batch, end-begin, MPI_BYTE, dest, batchTag, batchComm, &request);
 
             sentBatches++;
             if (sentBatches == 1 || sentBatches == totalNumBatches) {
@@ -229,13 +270,15 @@ private:
             } else {
                 LOG(V5_DEBG, "SENDB %i %i/%i %i\n", id, sentBatches, totalNumBatches, dest);
             }
-            //log(V5_DEBG, "MQ SEND BATCHED id=%i %i/%i\n", id, sentBatches, totalNumBatches);
         }
 
         void cancel() {
             sizePerBatch = -1;
         }
 
+        // Prioritized single messages are sent right away, without waiting for a send slot
+        bool occupiesSendSlot() const {return priority <= 0 || isBatched();}
+
         bool isBatched() const {return totalNumBatches > 1;}
         bool isCancelled() const {return sizePerBatch == -1;}
         size_t getTotalNumBatches() const {assert(isBatched()); return totalNumBatches;}
@@ -245,21 +288,36 @@ private:
     int _my_rank;
     unsigned long long _iteration = 0;
 
-    // Basic receive stuff
-    MPI_Request _recv_request;
-    uint8_t* _recv_data;
+    // Basic receive stuff: a pool of receives which are posted at all times.
+    // Messages are matched to the receives in the order of posting.
+    struct ReceiveSlot {
+        uint8_t* data;
+        unsigned long long postIndex = 0;
+        bool done = false;
+        MPI_Status status;
+    };
+    std::vector<ReceiveSlot> _recv_slots;
+    std::vector<MPI_Request> _recv_requests; // one per slot
+    std::vector<int> _recv_done_indices;
+    std::vector<MPI_Status> _recv_done_statuses;
+    unsigned long long _num_posted_receives = 0;
     std::list<SendHandle> _self_recv_queue;
     int _base_num_receives_per_loop = 10;
     int _num_receives_per_loop = _base_num_receives_per_loop;
 
     // Fragmented messages stuff
+    MPI_Comm _batch_comm;
     robin_hood::unordered_node_map<std::pair<int, int>, ReceiveFragment, IntPairHasher> _fragmented_messages;
-    Mutex _fragmented_mutex;
-    ConditionVariable _fragmented_cond_var;
-    std::list<ReceiveFragment> _fragmented_queue;
-    std::atomic_int _num_fused = 0;
-    Mutex _fused_mutex;
-    std::list<MessageHandle> _fused_queue;
+    unsigned long long _num_arrived_fragmented_messages = 0;
+    int _max_batch_tag; // MPI_TAG_UB of the batch communicator
+    unsigned int _running_batch_tag = 0;
+    robin_hood::unordered_flat_set<std::pair<int, int>, IntPairHasher> _used_batch_tags; // (dest, batch tag)
+    robin_hood::unordered_set<std::pair<int, int>, IntPairHasher> _streamed_messages; // taken over by a callback
+
+    // Small messages to coalesce per (destination, envelope tag), sent at the end of each cycle
+    static constexpr size_t COALESCING_BUFFER_SIZE = 4096;
+    size_t _coalescing_threshold = 0;
+    robin_hood::unordered_node_map<std::pair<int, int>, std::vector<uint8_t>, IntPairHasher> _coalesced_messages;
 
     // Send stuff
     std::list<SendHandle> _send_queue;
@@ -267,49 +325,136 @@ private:
     int _num_concurrent_sends = 0;
     int _max_concurrent_sends = 16;
 
-    // Garbage collection
-    std::atomic_int _num_garbage = 0;
-    Mutex _garbage_mutex;
-    std::list<DataPtr> _garbage_queue;
+    // Recycled message buffers: used by the thread which calls MPI (_pool) 
+    // and, if this is the communication thread, by the main thread (_main_pool)
+    MessageBufferPool _pool;
+    MessageBufferPool _main_pool;
+
+    // Result of the communication which is to be processed by the callbacks
+    struct Event {
+        enum Type {MESSAGE, FRAGMENT, SENT} type = MESSAGE;
+        MessageHandle handle; // received message, or the data of a cancelled large message
+        int messageId = -1; // large messages only
+        Fragment fragment {};
+        int sendId = -1;
+    };
+
+    // Optional dedicated thread which performs all MPI calls of the queue. 
+    // The main thread forwards sends to it and processes the resulting events.
+    struct Command {
+        enum Type {SEND, GROW, CANCEL} type = SEND;
+        std::unique_ptr<SendHandle> handle;
+        int sendId = -1;
+        size_t size = 0; // present size of growing data
+    };
+    struct GrowingSend {
+        int id;
+        DataPtr data;
+        size_t totalSize;
+        size_t reportedSize;
+    };
+    bool _comm_thread_enabled = false;
+    std::atomic_bool _comm_thread_running = false;
+    std::thread _comm_thread;
+    SPSCQueue<Command> _commands;
+    SPSCQueue<Event> _events;
+    Futex _event_signal;
+    std::list<GrowingSend> _growing_sends;
 
     // Callbacks
     typedef std::function<void(MessageHandle&)> MsgCallback;
     typedef std::function<void(int)> SendDoneCallback;
+    typedef std::function<bool(const Fragment&)> FragmentCallback;
     robin_hood::unordered_map<int, MsgCallback> _callbacks;
     robin_hood::unordered_map<int, SendDoneCallback> _send_done_callbacks;
+    robin_hood::unordered_map<int, FragmentCallback> _fragment_callbacks;
+    std::vector<std::atomic_int> _priorities; // indexed by tag
     int _default_tag_var = 0;
     int* _current_recv_tag = nullptr;
     int* _current_send_tag = nullptr;
 
-    BackgroundWorker _batch_assembler;
-    BackgroundWorker _gc;
-
 public:
-    MessageQueue(int maxMsgSize);
+    MessageQueue(int maxMsgSize, int numPostedReceives = 1, bool commThread = false);
     ~MessageQueue();
 
     void registerCallback(int tag, const MsgCallback& cb);
     void registerSentCallback(int tag, const SendDoneCallback& cb);
+    // The callback is offered the first fragment of each large message with the
+    // given tag. If it returns true, it takes over the message: it receives all
+    // further fragments in order (and a cancellation, if any) and no assembled
+    // message is delivered. The fragment's data is only valid during the call.
+    void registerFragmentCallback(int tag, const FragmentCallback& cb);
     void clearCallbacks();
+    // Messages with a tag of positive priority are processed as soon as they
+    // arrive, in order of descending priority, and may thereby overtake
+    // earlier messages of lower priority. All other messages are processed
+    // in the order of their arrival. Outgoing single messages of positive
+    // priority are sent immediately, regardless of the number of active sends.
+    // By default, no tag is prioritized, so the messages from each source are
+    // processed in the order in which they were sent.
+    void setPriority(int tag, int priority);
+    // Prioritizes the job scheduling and request/adoption messages. Their handlers
+    // must then tolerate overtaking earlier messages from the same source, e.g.,
+    // a job's termination may arrive before the rest of its description.
+    void prioritizeSchedulingMessages();
+    // Messages of up to the given size (0: none) which are sent to the same destination
+    // until the next call to advance() are sent as a single message. Their order is kept
+    // except for prioritized messages, and no send callbacks can be registered for them.
+    void setCoalescingThreshold(size_t numBytes) {_coalescing_threshold = numBytes;}
+
+    // Returns an empty buffer of at least the given capacity, e.g., to serialize 
+    // a message into. Buffers of sent and received messages are reused.
+    std::vector<uint8_t> acquireBuffer(size_t size) {return getMainThreadPool().acquire(size);}
     void setCurrentTagPointers(int* recvTag, int* sendTag) {
         _current_recv_tag = recvTag;
         _current_send_tag = sendTag;
     }
 
     int send(DataPtr data, int dest, int tag);
+    // Sends a message whose data are still being appended to (by the calling thread)
+    // until they reach totalSize bytes. Each fragment is sent as soon as it is present,
+    // so the message can be forwarded while it is still being received.
+    int sendGrowing(DataPtr data, size_t totalSize, int dest, int tag);
     void cancelSend(int sendId);
     void advance();
 
+    bool hasCommThread() const {return _comm_thread_enabled;}
+    // Blocks until the communication thread has new events for advance()
+    // or until the timeout has passed.
+    void waitForEvents(int timeoutMicros);
+    // Must be called before MPI is finalized.
+    void stopCommThread();
+
 private:
-    void runFragmentedMessageAssembler();
-    void runGarbageCollector();
+    void runCommThread();
+    int sendDirectly(DataPtr data, size_t totalSize, int dest, int tag);
+    int coalesce(const DataPtr& data, int dest, int tag);
+    void flushCoalesced();
+    void flushCoalesced(int dest);
+    void flushCoalesced(int dest, int envelopeTag);
+    void dispatchCoalesced(MessageHandle& envelope);
+    void processCommands();
+    void processEvents();
+    void reportGrowingSends();
+    void deliver(Event&& event);
+    void dispatch(Event& event);
+    void recycle(MessageBufferPool& pool, std::vector<uint8_t>&& data);
+    MessageBufferPool& getMainThreadPool() {return _comm_thread_enabled ? _main_pool : _pool;}
 
     void processReceived();
+    void processBatchHeader(int source, int tag, const BatchHeader& header);
     void processSelfReceived();
-    void processAssembledReceived();
+    void processFragmentedReceived();
     void processSent();
 
-    void resetReceiveHandle();
+    int getPriority(int tag) const;
+    int selectNextReceived() const;
+    void handleReceived(int slotIdx);
+    void postReceive(int slotIdx);
+    void initiateSend(SendHandle& h);
+    int nextSendId();
+    int acquireBatchTag(int dest);
+    void releaseBatchTag(int dest, int batchTag);
     void signalCompletion(int tag, int id);
 };
 
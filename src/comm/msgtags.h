@@ -152,6 +152,14 @@ const int MSG_SCHED_NODE_FREED = 54;
 const int MSG_JOB_TREE_REDUCTION = 61;
 const int MSG_JOB_TREE_BROADCAST = 62;
 
+/*
+Several small messages to the same destination, sent as a single message.
+The latter tag is used for messages of positive priority.
+Data type: sequence of [tag, size, data (size bytes)]
+*/
+const int MSG_COALESCED = 71;
+const int MSG_COALESCED_PRIORITIZED = 72;
+
 const int MSG_OFFSET_BATCHED = 10000;
 
 // Application message tags
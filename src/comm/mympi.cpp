@@ -16,11 +16,12 @@
 
 MessageQueue* MyMpi::_msg_queue;
 
-void MyMpi::init() {
+void MyMpi::init(bool threadMultiple) {
+    int required = threadMultiple ? MPI_THREAD_MULTIPLE : MPI_THREAD_FUNNELED;
     int provided = -1;
-    MPICALL(MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided), std::string("init"))
-    if (provided != MPI_THREAD_FUNNELED) {
-        std::cout << "[ERROR] MPI: wanted id=" << MPI_THREAD_FUNNELED 
+    MPICALL(MPI_Init_thread(nullptr, nullptr, required, &provided), std::string("init"))
+    if (provided < required) {
+        std::cout << "[ERROR] MPI: wanted id=" << required 
                 << ", got id=" << provided << std::endl;
         Process::doExit(1);
     }
@@ -37,17 +38,38 @@ size_t MyMpi::getBinaryTreeBufferLimit(int numWorkers, int baseSize, float disco
 
 void MyMpi::setOptions(const Parameters& params) {
     int verb = MyMpi::rank(MPI_COMM_WORLD) == 0 ? V2_INFO : V4_VVER;
-    _msg_queue = new MessageQueue(params.messageBatchingThreshold());
+    _msg_queue = new MessageQueue(params.messageBatchingThreshold(), params.numPostedReceives(), 
+        params.commThread());
+    _msg_queue->setCoalescingThreshold(params.messageCoalescingThreshold());
+    if (params.prioritizeSchedulingMessages()) _msg_queue->prioritizeSchedulingMessages();
+}
+
+void MyMpi::setMessageQueue(MessageQueue* queue) {
+    delete _msg_queue;
+    _msg_queue = queue;
+}
+
+void MyMpi::finalize() {
+    // The communication thread must not issue any MPI calls from now on
+    if (_msg_queue != nullptr) _msg_queue->stopCommThread();
+    MPI_Finalize();
 }
 
 int MyMpi::isend(int recvRank, int tag, const Serializable& object) {
-    return isend(recvRank, tag, object.serialize());
+    size_t size = object.getSerializedSize();
+    if (size == 0) return isend(recvRank, tag, object.serialize());
+    // Serialize into a recycled buffer
+    auto packed = _msg_queue->acquireBuffer(size);
+    object.serializeInto(packed);
+    return isend(recvRank, tag, std::move(packed));
 }
 int MyMpi::isend(int recvRank, int tag, std::vector<uint8_t>&& object) {
-    return isend(recvRank, tag, DataPtr(new std::vector<uint8_t>(std::move(object))));
+    return isend(recvRank, tag, std::make_shared<std::vector<uint8_t>>(std::move(object)));
 }
 int MyMpi::isendCopy(int recvRank, int tag, const std::vector<uint8_t>& object) {
-    return isend(recvRank, tag, std::vector<uint8_t>(std::move(object)));
+    auto copy = _msg_queue->acquireBuffer(object.size());
+    copy.assign(object.begin(), object.end());
+    return isend(recvRank, tag, std::move(copy));
 }
 int MyMpi::isend(int recvRank, int tag, const DataPtr& object) {
     return _msg_queue->send(object, recvRank, tag);
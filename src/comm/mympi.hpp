@@ -29,8 +29,12 @@ public:
     */
     static MessageQueue* _msg_queue;
 
-    static void init();
+    // A dedicated communication thread requires full multi-threading support of MPI.
+    static void init(bool threadMultiple = false);
     static void setOptions(const Parameters& params);
+    // Replaces (and deletes) the current message queue.
+    static void setMessageQueue(MessageQueue* queue);
+    static void finalize();
 
     static int isend(int recvRank, int tag, const Serializable& object);
     static int isend(int recvRank, int tag, std::vector<uint8_t>&& object);
@@ -0,0 +1,255 @@
+
+#include "formula_cache.hpp"
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "util/hashing.hpp"
+#include "util/logger.hpp"
+#include "util/sat_reader.hpp"
+#include "util/sys/fileutils.hpp"
+#include "util/sys/proc.hpp"
+#include "util/sys/thread_pool.hpp"
+#include "util/sys/timer.hpp"
+
+namespace {
+    const std::string ENTRY_SUFFIX = ".rawcnf";
+
+    // Fixed-size part of an entry's header. It is followed by the path of the
+    // original file, padded to full integers, and then by the formula.
+    struct EntryHeader {
+        uint64_t fileSize;
+        int64_t mtimeSec;
+        int64_t mtimeNsec;
+        uint64_t pathLength;
+    };
+    static_assert(sizeof(EntryHeader) % sizeof(int) == 0);
+
+    size_t getHeaderSize(size_t pathLength) {
+        size_t paddedPathLength = (pathLength + sizeof(int)-1) / sizeof(int) * sizeof(int);
+        return sizeof(EntryHeader) + paddedPathLength;
+    }
+}
+
+FormulaCache::FormulaCache(const std::string& directory, size_t maxSizeBytes) :
+        _directory(directory), _max_size(maxSizeBytes) {
+    if (isEnabled() && FileUtils::mkdir(_directory) != 0) {
+        LOG(V1_WARN, "[WARN] Cannot create formula cache directory %s - disabling formula cache\n", _directory.c_str());
+        _directory = "";
+    }
+}
+
+FormulaCache::~FormulaCache() {
+    awaitPendingWrites();
+}
+
+bool FormulaCache::read(const std::string& file, JobDescription& desc) const {
+
+    FileKey key;
+    if (!getFileKey(file, key)) return false;
+    auto entry = getEntryPath(key);
+    if (!FileUtils::isRegularFile(entry)) return false;
+
+    float time = Timer::elapsedSeconds();
+    bool corrupt = false;
+    if (!readEntry(entry, key, desc, corrupt)) {
+        if (corrupt) {
+            LOG(V1_WARN, "[WARN] Invalid formula cache entry %s for %s - removing\n", entry.c_str(), file.c_str());
+            FileUtils::rm(entry);
+        } else {
+            LOG(V4_VVER, "Formula cache entry %s belongs to another file than %s\n", entry.c_str(), file.c_str());
+        }
+        return false;
+    }
+    // Mark the entry as recently used
+    utime(entry.c_str(), nullptr);
+    time = Timer::elapsedSeconds() - time;
+    LOG(V4_VVER, "Read %s from formula cache in %.3fs\n", file.c_str(), time);
+    return true;
+}
+
+bool FormulaCache::readEntry(const std::string& entry, const FileKey& key, JobDescription& desc, bool& corrupt) const {
+
+    int fd = open(entry.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    struct stat s;
+    if (fstat(fd, &s) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = s.st_size;
+    void* mmapped = size == 0 ? MAP_FAILED : mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mmapped == MAP_FAILED) {
+        corrupt = true;
+        return false;
+    }
+    const char* data = (const char*) mmapped;
+
+    // Check that the entry was written for the very same file
+    EntryHeader header;
+    size_t headerSize = 0;
+    if (size >= sizeof(EntryHeader)) {
+        memcpy(&header, data, sizeof(EntryHeader));
+        if (header.pathLength <= size) headerSize = getHeaderSize(header.pathLength);
+    }
+    corrupt = headerSize == 0 || size < headerSize || (size - headerSize) % sizeof(int) != 0;
+    bool success = !corrupt && header.fileSize == key.size 
+        && header.mtimeSec == key.mtimeSec && header.mtimeNsec == key.mtimeNsec
+        && header.pathLength == key.path.size()
+        && memcmp(data + sizeof(EntryHeader), key.path.c_str(), key.path.size()) == 0;
+
+    if (success) {
+        success = SatReader(entry, SatReader::ContentMode::RAW).read(
+            (const int*) (data + headerSize), (size - headerSize) / sizeof(int), desc);
+        corrupt = !success;
+    }
+    munmap(mmapped, size);
+    return success;
+}
+
+void FormulaCache::write(const std::string& file, const JobDescription& desc) const {
+
+    FileKey key;
+    if (!getFileKey(file, key)) return;
+    auto entry = getEntryPath(key);
+
+    int rev = desc.getRevision();
+    size_t numLits = desc.getFormulaPayloadSize(rev);
+    size_t numAssumptions = desc.getAssumptionsSize(rev);
+    size_t size = getHeaderSize(key.path.size()) + sizeof(int) * (numLits + numAssumptions + 2);
+    if (size > _max_size) return;
+
+    // The task holds the revision's serialization such that the payload
+    // stays valid even if the description is re-initialized meanwhile
+    auto data = desc.getSerialization(rev);
+    const int* lits = desc.getFormulaPayload(rev);
+    const int* assumptions = desc.getAssumptionsPayload(rev);
+    auto future = ProcessWideThreadPool::get().addTask(
+        [this, entry, key, size, data, lits, numLits, assumptions, numAssumptions]() {
+        evict(size);
+        writeEntry(entry, key, lits, numLits, assumptions, numAssumptions);
+    });
+
+    auto lock = _pending_writes_mutex.getLock();
+    // Forget about writes which are done
+    for (auto it = _pending_writes.begin(); it != _pending_writes.end();) {
+        if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) 
+            it = _pending_writes.erase(it);
+        else ++it;
+    }
+    _pending_writes.push_back(std::move(future));
+}
+
+void FormulaCache::writeEntry(const std::string& entry, const FileKey& key, const int* lits, size_t numLits, 
+        const int* assumptions, size_t numAssumptions) const {
+
+    EntryHeader header {key.size, key.mtimeSec, key.mtimeNsec, key.path.size()};
+    size_t padding = getHeaderSize(key.path.size()) - sizeof(EntryHeader) - key.path.size();
+    const char zeros[sizeof(int)] = {0};
+
+    // Write to a temporary file first so that no other process
+    // can encounter an incomplete entry
+    auto tmpFile = entry + ".tmp." + std::to_string(Proc::getPid()) + "." + std::to_string(Proc::getTid());
+    FILE* f = fopen(tmpFile.c_str(), "wb");
+    if (f == nullptr) return;
+    const int zero = 0;
+    bool success = fwrite(&header, sizeof(EntryHeader), 1, f) == 1
+        && fwrite(key.path.c_str(), 1, key.path.size(), f) == key.path.size()
+        && fwrite(zeros, 1, padding, f) == padding
+        && fwrite(lits, sizeof(int), numLits, f) == numLits
+        && fwrite(&zero, sizeof(int), 1, f) == 1
+        && fwrite(assumptions, sizeof(int), numAssumptions, f) == numAssumptions
+        && fwrite(&zero, sizeof(int), 1, f) == 1;
+    success = (fclose(f) == 0) && success;
+    if (!success || rename(tmpFile.c_str(), entry.c_str()) != 0) {
+        LOG(V1_WARN, "[WARN] Could not write formula cache entry %s\n", entry.c_str());
+        FileUtils::rm(tmpFile);
+        return;
+    }
+    LOG(V4_VVER, "Cached formula of %s in %s\n", key.path.c_str(), entry.c_str());
+}
+
+void FormulaCache::awaitPendingWrites() const {
+    auto lock = _pending_writes_mutex.getLock();
+    for (auto& future : _pending_writes) future.get();
+    _pending_writes.clear();
+}
+
+bool FormulaCache::getFileKey(const std::string& file, FileKey& key) const {
+
+    if (!isEnabled()) return false;
+
+    char resolved[PATH_MAX];
+    key.path = realpath(file.c_str(), resolved) != nullptr ? std::string(resolved) : file;
+    struct stat s;
+    if (stat(key.path.c_str(), &s) != 0) return false;
+    // Pipes and other special files may yield different contents at any time
+    if (!S_ISREG(s.st_mode)) return false;
+
+    key.size = s.st_size;
+    key.mtimeSec = s.st_mtim.tv_sec;
+    key.mtimeNsec = s.st_mtim.tv_nsec;
+    return true;
+}
+
+std::string FormulaCache::getEntryPath(const FileKey& key) const {
+
+    // Any modification of the file results in a different entry
+    size_t hash = 17;
+    hash_combine(hash, key.path);
+    hash_combine(hash, key.size);
+    hash_combine(hash, (size_t) key.mtimeSec);
+    hash_combine(hash, (size_t) key.mtimeNsec);
+    char hashStr[17];
+    snprintf(hashStr, sizeof(hashStr), "%016lx", hash);
+    return _directory + "/" + hashStr + ENTRY_SUFFIX;
+}
+
+void FormulaCache::evict(size_t sizeToFree) const {
+
+    struct Entry {
+        std::string path;
+        size_t size;
+        time_t lastUsed;
+    };
+    std::vector<Entry> entries;
+    size_t totalSize = 0;
+
+    DIR* dir = opendir(_directory.c_str());
+    if (dir == nullptr) return;
+    struct dirent* dirEntry;
+    while ((dirEntry = readdir(dir)) != nullptr) {
+        std::string name(dirEntry->d_name);
+        if (name.size() <= ENTRY_SUFFIX.size()
+            || name.compare(name.size()-ENTRY_SUFFIX.size(), ENTRY_SUFFIX.size(), ENTRY_SUFFIX) != 0)
+            continue;
+        auto path = _directory + "/" + name;
+        struct stat s;
+        if (stat(path.c_str(), &s) != 0) continue;
+        entries.push_back(Entry{path, (size_t) s.st_size, s.st_mtime});
+        totalSize += s.st_size;
+    }
+    closedir(dir);
+
+    // Remove least recently used entries until the new entry fits
+    std::sort(entries.begin(), entries.end(), [](const Entry& left, const Entry& right) {
+        return left.lastUsed < right.lastUsed;
+    });
+    for (const auto& entry : entries) {
+        if (totalSize + sizeToFree <= _max_size) break;
+        LOG(V4_VVER, "Evicting formula cache entry %s\n", entry.path.c_str());
+        FileUtils::rm(entry.path);
+        totalSize -= entry.size;
+    }
+}
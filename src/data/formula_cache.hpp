@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <future>
+
+#include "data/job_description.hpp"
+#include "util/sys/threading.hpp"
+
+// On-disk cache of parsed formulas. Each entry holds a formula in mallob's RAW
+// format (literals, 0, assumptions, 0), keyed by the path, size, and
+// modification time of the original file. These properties are also stored in
+// the entry's header and checked on reading, so colliding keys are harmless.
+// Reading an entry amounts to a single mmap of binary data instead of parsing
+// (and possibly decompressing) text. Entries are written in the background.
+// Entries are replaced in least recently used order as soon as the cache
+// directory grows beyond its size limit.
+class FormulaCache {
+
+private:
+    std::string _directory;
+    size_t _max_size;
+
+    // Identifies the original file of an entry
+    struct FileKey {
+        std::string path;
+        size_t size;
+        int64_t mtimeSec;
+        int64_t mtimeNsec;
+    };
+
+    mutable Mutex _pending_writes_mutex;
+    mutable std::list<std::future<void>> _pending_writes;
+
+public:
+    // An empty directory disables the cache.
+    FormulaCache(const std::string& directory, size_t maxSizeBytes);
+    ~FormulaCache();
+
+    bool isEnabled() const {return !_directory.empty();}
+
+    // Reads the formula of the provided file into the current revision
+    // of the description if it is cached. Returns false otherwise.
+    bool read(const std::string& file, JobDescription& desc) const;
+
+    // Stores the formula of the description's current revision, which has
+    // just been read from the provided file, and evicts old entries as needed.
+    // The entry is written by the process-wide thread pool.
+    void write(const std::string& file, const JobDescription& desc) const;
+
+    // Blocks until all entries issued for writing have been written.
+    void awaitPendingWrites() const;
+
+private:
+    bool getFileKey(const std::string& file, FileKey& key) const;
+    std::string getEntryPath(const FileKey& key) const;
+    bool readEntry(const std::string& entry, const FileKey& key, JobDescription& desc, bool& corrupt) const;
+    void writeEntry(const std::string& entry, const FileKey& key, const int* lits, size_t numLits, 
+        const int* assumptions, size_t numAssumptions) const;
+    void evict(size_t sizeToFree) const;
+};
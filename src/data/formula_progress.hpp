@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "util/sys/futex.hpp"
+
+// Number of literals of a formula which are present so far while the formula
+// is still being received, along with a signal which wakes up readers waiting
+// for more literals. Usable across processes if the instance resides in
+// shared memory.
+struct FormulaProgress {
+
+    std::atomic_size_t numLits {0};
+    Futex changed;
+
+    FormulaProgress() = default;
+    FormulaProgress(size_t numLits) : numLits(numLits) {}
+
+    size_t get() const {
+        return numLits.load(std::memory_order_acquire);
+    }
+
+    // Publishes a new number of present literals and wakes up all readers.
+    void set(size_t n) {
+        numLits.store(n, std::memory_order_release);
+        changed.notify();
+    }
+
+    // Blocks until at least the given number of literals is present or until
+    // the timeout (in microseconds) has passed. Returns whether the literals
+    // are present. Call notify() to wake up all waiting readers prematurely.
+    bool waitFor(size_t n, int timeoutMicros) {
+        auto epoch = changed.getEpoch();
+        if (get() >= n) return true;
+        changed.wait(epoch, timeoutMicros);
+        return get() >= n;
+    }
+
+    void notify() {
+        changed.notify();
+    }
+};
@@ -9,6 +9,7 @@
 
 #include "app/sat/job/forked_sat_job.hpp"
 #include "app/sat/job/threaded_sat_job.hpp"
+#include "app/sat/job/sat_process_pool.hpp"
 #include "app/dummy/dummy_job.hpp"
 
 #include "util/sys/timer.hpp"
@@ -31,6 +32,8 @@ JobDatabase::JobDatabase(Parameters& params, MPI_Comm& comm, WorkerSysState& sys
 
     // Initialize balancer
     _balancer = std::unique_ptr<EventDrivenBalancer>(new EventDrivenBalancer(_comm, _params));
+    // Pre-start SAT processes for upcoming jobs
+    if (_params.applicationSpawnMode() == "fork") SatProcessPool::init(_params);
     // Initialize janitor (cleaning up old jobs)
     _janitor.run([this]() {
         Proc::nameThisThread("JobJanitor");
@@ -717,6 +720,9 @@ JobDatabase::~JobDatabase() {
     watchdog.setWarningPeriod(500);
     watchdog.setAbortPeriod(10*1000);
 
+    // Dismiss pre-started SAT processes
+    SatProcessPool::shutdown();
+
     // Collect all jobs from central job table
     std::vector<int> jobIds;
     for (auto idJobPair : _jobs) jobIds.push_back(idJobPair.first);
@@ -19,6 +19,24 @@ void JobDescription::reserveSize(size_t size) {
     getRevisionData(_revision)->reserve(getMetadataSize() + size);
 }
 
+void JobDescription::addLiterals(const int* lits, size_t numLits) {
+    auto& data = _data_per_revision[_revision];
+    size_t pos = data->size();
+    data->resize(pos + sizeof(int)*numLits);
+    memcpy(data->data()+pos, lits, sizeof(int)*numLits);
+    _f_size += numLits;
+    if (_use_checksums) for (size_t i = 0; i < numLits; i++) _checksum.combine(lits[i]);
+}
+
+void JobDescription::addAssumptions(const int* lits, size_t numLits) {
+    auto& data = _data_per_revision[_revision];
+    size_t pos = data->size();
+    data->resize(pos + sizeof(int)*numLits);
+    memcpy(data->data()+pos, lits, sizeof(int)*numLits);
+    _a_size += numLits;
+    if (_use_checksums) for (size_t i = 0; i < numLits; i++) _checksum.combine(-lits[i]);
+}
+
 void JobDescription::endInitialization() {
     // Add preloaded literals and assumptions (if any)
     for (int l : _preloaded_literals) addLiteral(l);
@@ -48,6 +66,7 @@ void JobDescription::writeMetadata() {
     n = sizeof(int);         memcpy(data->data()+i, &_max_demand, n); i += n;
     n = sizeof(Application); memcpy(data->data()+i, &_application, n); i += n;
     n = sizeof(Checksum);    memcpy(data->data()+i, &_checksum, n); i += n;
+    assert(i == META_FIXED_SIZE);
     
     auto configSerialized = _app_config.serialize();
     n = configSerialized.size();
@@ -91,6 +110,10 @@ size_t JobDescription::getTransferSize(int revision) const {
     return getRevisionData(revision)->size();
 }
 
+size_t JobDescription::getFullTransferSize(int revision) const {
+    return getMetadataSize() + sizeof(int) * (getFormulaPayloadSize(revision) + getAssumptionsSize(revision));
+}
+
 
 
 int JobDescription::getMetadataSize() const {
@@ -105,13 +128,45 @@ int JobDescription::getMetadataSize() const {
 
 
 int JobDescription::readRevisionIndex(const std::vector<uint8_t>& serialized) {
-    assert(serialized.size() >= 3*sizeof(int)+2*sizeof(size_t));
+    assert(serialized.size() >= META_OFFSET_A_SIZE+sizeof(size_t));
+    return readRevisionIndex(serialized.data());
+}
+
+size_t JobDescription::readMetadataSize(const uint8_t* serialized, size_t size) {
+    // Meta data of fixed size precede the serialized app configuration
+    size_t i = META_FIXED_SIZE;
+    if (size < i + sizeof(int)) return 0;
+    int configSize;
+    memcpy(&configSize, serialized+i, sizeof(int)); i += sizeof(int);
+    i += configSize;
+    return size < i ? 0 : i;
+}
+
+int JobDescription::readJobId(const uint8_t* serialized) {
+    int jobId;
+    memcpy(&jobId, serialized+META_OFFSET_ID, sizeof(int));
+    return jobId;
+}
+
+int JobDescription::readRevisionIndex(const uint8_t* serialized) {
     int revision;
-    memcpy(&revision, serialized.data()+sizeof(int), sizeof(int));
+    memcpy(&revision, serialized+META_OFFSET_REVISION, sizeof(int));
     assert(revision >= 0);
     return revision;
 }
 
+size_t JobDescription::readFormulaSize(const uint8_t* serialized) {
+    size_t fSize;
+    memcpy(&fSize, serialized+META_OFFSET_F_SIZE, sizeof(size_t));
+    return fSize;
+}
+
+size_t JobDescription::readAssumptionsSize(const uint8_t* serialized) {
+    size_t aSize;
+    memcpy(&aSize, serialized+META_OFFSET_A_SIZE, sizeof(size_t));
+    return aSize;
+}
+
 int JobDescription::prepareRevision(const std::vector<uint8_t>& packed) {
     int revision = JobDescription::readRevisionIndex(packed);
     while (revision >= _data_per_revision.size()) _data_per_revision.emplace_back();
@@ -158,6 +213,7 @@ void JobDescription::deserialize() {
     n = sizeof(int);         memcpy(&_max_demand, latestData->data()+i, n);      i += n;
     n = sizeof(Application); memcpy(&_application, latestData->data()+i, n);     i += n;
     n = sizeof(Checksum);    memcpy(&_checksum, latestData->data()+i, n);        i += n;
+    assert(i == META_FIXED_SIZE);
     // size of config
     memcpy(&n, latestData->data()+i, sizeof(int)); i += sizeof(int);
     // bytes of config
@@ -63,6 +63,16 @@ private:
     // For each revision, the shared_ptr contains the full serialization
     // of this revision including all meta data of this object.
     std::vector<std::shared_ptr<std::vector<uint8_t>>> _data_per_revision;
+
+    // Byte offsets of the meta data fields at the beginning of each revision's
+    // serialization (see writeMetadata()) which are read without deserializing
+    static constexpr size_t META_OFFSET_ID = 0;
+    static constexpr size_t META_OFFSET_REVISION = META_OFFSET_ID + sizeof(int);
+    static constexpr size_t META_OFFSET_F_SIZE = META_OFFSET_REVISION + 2*sizeof(int);
+    static constexpr size_t META_OFFSET_A_SIZE = META_OFFSET_F_SIZE + sizeof(size_t);
+    // Size of all meta data preceding the serialized app configuration
+    static constexpr size_t META_FIXED_SIZE = META_OFFSET_A_SIZE + sizeof(size_t) 
+        + 3*sizeof(int) + 3*sizeof(float) + sizeof(Application) + sizeof(Checksum);
     
     // Stores the position (in bytes) and size (in integers) of each revision's payload.
     struct RevisionInfo {
@@ -156,6 +166,9 @@ public:
         _a_size++;
         if (_use_checksums) _checksum.combine(-lit);
     }
+    // Append blocks of literals resp. assumptions at once
+    void addLiterals(const int* lits, size_t numLits);
+    void addAssumptions(const int* lits, size_t numLits);
     void endInitialization();
     void writeMetadata();
 
@@ -197,6 +210,7 @@ public:
     void setAppConfiguration(AppConfiguration&& appConfig) {_app_config = std::move(appConfig);}
     void setPreloadedLiterals(std::vector<int>&& lits) {_preloaded_literals = std::move(lits);}
     void setPreloadedAssumptions(std::vector<int>&& asmpt) {_preloaded_assumptions = std::move(asmpt);}
+    bool hasPreloadedData() const {return !_preloaded_literals.empty() || !_preloaded_assumptions.empty();}
 
     Checksum getChecksum() const {return _checksum;}
     void setChecksum(const Checksum& checksum) {_checksum = checksum;}
@@ -216,8 +230,19 @@ public:
     const int* getAssumptionsPayload(int revision) const;
     
     size_t getTransferSize(int revision) const;
+    // Size of the revision's serialization once it has been received completely
+    size_t getFullTransferSize(int revision) const;
     
     static int readRevisionIndex(const std::vector<uint8_t>& serialized);
+    // Returns the size of the meta data at the beginning of a (partial) serialization
+    // of a revision, or zero if the serialization does not contain all of it yet.
+    static size_t readMetadataSize(const uint8_t* serialized, size_t size);
+    // Read single meta data fields from a (partial) serialization of a revision
+    // which contains all of its meta data, i.e., readMetadataSize() is non-zero.
+    static int readJobId(const uint8_t* serialized);
+    static int readRevisionIndex(const uint8_t* serialized);
+    static size_t readFormulaSize(const uint8_t* serialized);
+    static size_t readAssumptionsSize(const uint8_t* serialized);
 
     Statistics& getStatistics() {
         if (_stats == nullptr) _stats = new Statistics();
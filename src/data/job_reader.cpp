@@ -3,13 +3,21 @@
 
 #include "app/dummy/dummy_reader.hpp"
 
-bool JobReader::read(const std::vector<std::string>& files, SatReader::ContentMode contentMode, JobDescription& desc) {
+bool JobReader::read(const std::vector<std::string>& files, SatReader::ContentMode contentMode, JobDescription& desc, 
+        int numThreads, const FormulaCache* cache) {
     switch (desc.getApplication()) {
     case JobDescription::DUMMY:
         return DummyReader::read(files, desc);
     case JobDescription::ONESHOT_SAT:
-    case JobDescription::INCREMENTAL_SAT:
-        return SatReader(files.front(), contentMode).read(desc);
+    case JobDescription::INCREMENTAL_SAT: {
+        // Parsed text formulas are cached in binary form
+        bool useCache = cache != nullptr && cache->isEnabled() 
+            && contentMode == SatReader::ContentMode::ASCII && !desc.hasPreloadedData();
+        if (useCache && cache->read(files.front(), desc)) return true;
+        bool success = SatReader(files.front(), contentMode, numThreads).read(desc);
+        if (success && useCache) cache->write(files.front(), desc);
+        return success;
+    }
     default:
         return false;
     }
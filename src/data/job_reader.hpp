@@ -4,9 +4,11 @@
 
 #include "data/job_description.hpp"
 #include "util/sat_reader.hpp"
+#include "data/formula_cache.hpp"
 
 namespace JobReader {
-    bool read(const std::vector<std::string>& files, SatReader::ContentMode contentMode, JobDescription& desc);
+    bool read(const std::vector<std::string>& files, SatReader::ContentMode contentMode, JobDescription& desc, 
+        int numThreads = 1, const FormulaCache* cache = nullptr);
 };
 
 #endif
@@ -11,8 +11,13 @@ size_t JobRequest::getTransferSize() {
 }
 
 std::vector<uint8_t> JobRequest::serialize() const {
-    int size = getTransferSize();
-    std::vector<uint8_t> packed(size);
+    std::vector<uint8_t> packed;
+    serializeInto(packed);
+    return packed;
+}
+
+void JobRequest::serializeInto(std::vector<uint8_t>& packed) const {
+    packed.resize(getTransferSize());
     int i = 0, n;
     n = sizeof(int); memcpy(packed.data()+i, &jobId, n); i += n;
     n = sizeof(JobDescription::Application); memcpy(packed.data()+i, &application, n); i += n;
@@ -23,7 +28,6 @@ std::vector<uint8_t> JobRequest::serialize() const {
     n = sizeof(float); memcpy(packed.data()+i, &timeOfBirth, n); i += n;
     n = sizeof(int); memcpy(packed.data()+i, &numHops, n); i += n;
     n = sizeof(int); memcpy(packed.data()+i, &balancingEpoch, n); i += n;
-    return packed;
 }
 
 JobRequest& JobRequest::deserialize(const std::vector<uint8_t> &packed) {
@@ -133,8 +137,17 @@ JobSignature& JobSignature::deserialize(const std::vector<uint8_t>& packed) {
 }
 
 std::vector<uint8_t> JobMessage::serialize() const {
-    int size = 4*sizeof(int) + sizeof(bool) + payload.size()*sizeof(int) + sizeof(Checksum);
-    std::vector<uint8_t> packed(size);
+    std::vector<uint8_t> packed;
+    serializeInto(packed);
+    return packed;
+}
+
+size_t JobMessage::getSerializedSize() const {
+    return 4*sizeof(int) + sizeof(bool) + payload.size()*sizeof(int) + sizeof(Checksum);
+}
+
+void JobMessage::serializeInto(std::vector<uint8_t>& packed) const {
+    packed.resize(getSerializedSize());
 
     int i = 0, n;
     n = sizeof(int); memcpy(packed.data()+i, &jobId, n); i += n;
@@ -144,7 +157,6 @@ std::vector<uint8_t> JobMessage::serialize() const {
     n = sizeof(bool); memcpy(packed.data()+i, &returnedToSender, n); i += n;
     n = sizeof(Checksum); memcpy(packed.data()+i, &checksum, n); i += n;
     n = payload.size()*sizeof(int); memcpy(packed.data()+i, payload.data(), n); i += n;
-    return packed;
 }
 
 JobMessage& JobMessage::deserialize(const std::vector<uint8_t>& packed) {
@@ -177,12 +189,16 @@ IntPair& IntPair::deserialize(const std::vector<uint8_t>& packed) {
 }
 
 std::vector<uint8_t> IntVec::serialize() const {
-    int size = (data.size()*sizeof(int));
-    std::vector<uint8_t> packed(size);
-    memcpy(packed.data(), data.data(), size);
+    std::vector<uint8_t> packed;
+    serializeInto(packed);
     return packed;
 }
 
+void IntVec::serializeInto(std::vector<uint8_t>& packed) const {
+    packed.resize(getSerializedSize());
+    memcpy(packed.data(), data.data(), packed.size());
+}
+
 IntVec& IntVec::deserialize(const std::vector<uint8_t>& packed) {
     data.resize(packed.size() / sizeof(int));
     memcpy(data.data(), packed.data(), packed.size());
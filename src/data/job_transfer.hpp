@@ -43,6 +43,8 @@ public:
 
     static size_t getTransferSize();
     std::vector<uint8_t> serialize() const override;
+    size_t getSerializedSize() const override {return getTransferSize();}
+    void serializeInto(std::vector<uint8_t>& packed) const override;
     JobRequest& deserialize(const std::vector<uint8_t> &packed) override;
     std::string toStr() const;
     bool operator==(const JobRequest& other) const;
@@ -122,6 +124,8 @@ public:
         jobId(jobId), revision(revision), tag(tag), epoch(epoch), payload(payload) {}
 
     std::vector<uint8_t> serialize() const override;
+    size_t getSerializedSize() const override;
+    void serializeInto(std::vector<uint8_t>& packed) const override;
     JobMessage& deserialize(const std::vector<uint8_t>& packed) override;
 };
 
@@ -148,6 +152,8 @@ public:
     IntVec(const std::initializer_list<int>& list) : data(list) {}
 
     std::vector<uint8_t> serialize() const override;
+    size_t getSerializedSize() const override {return data.size()*sizeof(int);}
+    void serializeInto(std::vector<uint8_t>& packed) const override;
     IntVec& deserialize(const std::vector<uint8_t>& packed) override;
     int& operator[](const int pos);
 };
@@ -22,6 +22,12 @@ class Serializable {
 public:
     virtual std::vector<uint8_t> serialize() const = 0;
     virtual Serializable& deserialize(const std::vector<uint8_t>& packed) = 0;
+
+    // Frequently sent objects can be serialized into a recycled buffer: If the 
+    // serialized size is known (> 0), serializeInto() fills an empty buffer
+    // whose capacity is at least this size.
+    virtual size_t getSerializedSize() const {return 0;}
+    virtual void serializeInto(std::vector<uint8_t>& packed) const {packed = serialize();}
     
     template<typename T>
     static T get(const std::vector<uint8_t>& packed);
@@ -109,7 +109,10 @@ void doMainProgram(MPI_Comm& commWorkers, MPI_Comm& commClients, Parameters& par
 
     // Create intra-machine communicator (collective operation)
     hostComm.create();
-    if (isWorker) worker->setHostComm(hostComm);
+    if (isWorker) {
+        worker->setHostComm(hostComm);
+        params.hostSharedMemoryKey.set(hostComm.getSharedMemoryKey());
+    }
 
     // If mono solving mode is enabled, introduce the singular job to solve
     if (params.monoFilename.isSet() && isClient && MyMpi::rank(commClients) == 0)
@@ -134,7 +137,12 @@ void doMainProgram(MPI_Comm& commWorkers, MPI_Comm& commClients, Parameters& par
         // Check termination, sleep, and/or yield thread
         if (doTerminate(params, myRank)) 
             break;
-        if (params.sleepMicrosecs() > 0) usleep(params.sleepMicrosecs());
+        if (params.sleepMicrosecs() > 0) {
+            // With a communication thread, arriving messages end the nap right away
+            if (MyMpi::getMessageQueue().hasCommThread())
+                MyMpi::getMessageQueue().waitForEvents(params.sleepMicrosecs());
+            else usleep(params.sleepMicrosecs());
+        }
         if (params.yield()) std::this_thread::yield();
         if (monoJobDone) {
             // Terminate all processes
@@ -155,7 +163,11 @@ void longStartupWarnMsg(int rank, const char* msg) {
 
 int main(int argc, char *argv[]) {
     
-    MyMpi::init();
+    // The options determine the required level of thread support of MPI
+    Parameters params;
+    params.init(argc, argv);
+
+    MyMpi::init(params.commThread());
     Timer::init();
     Proc::nameThisThread("MainThread");
 
@@ -164,8 +176,6 @@ int main(int argc, char *argv[]) {
 
     longStartupWarnMsg(rank, "Init'd MPI");
 
-    Parameters params;
-    params.init(argc, argv);
     if (rank == 0) params.printBanner();
 
     longStartupWarnMsg(rank, "Init'd params");
@@ -202,7 +212,7 @@ int main(int argc, char *argv[]) {
         if (rank == 0) {
             params.printUsage();
         }
-        MPI_Finalize();
+        MyMpi::finalize();
         Process::doExit(0);
     }
 
@@ -269,7 +279,7 @@ int main(int argc, char *argv[]) {
 
     // Exit properly
     MPI_Barrier(MPI_COMM_WORLD);
-    MPI_Finalize();
+    MyMpi::finalize();
     LOG(V2_INFO, "Exiting happily\n");
     Process::doExit(0);
 }
@@ -14,8 +14,11 @@ OptMap _map;
 //  TYPE  member name                    option ID (short, long)                      default (, min, max)     description
 
 OPT_BOOL(abortNonincrementalSubprocess,  "ans", "abort-noninc-subproc",               false,                   "Abort (hence restart) each sub-process which works (partially) non-incrementally upon the arrival of a new revision")
+OPT_BOOL(clauseFilterFingerprints,       "cff", "clause-filter-fingerprints",         false,                   "Represent large clauses by 64-bit fingerprints (instead of copies) in the filter of produced clauses")
 OPT_BOOL(collectClauseHistory,           "ch", "collect-clause-history",              false,                   "Employ clause history collection mechanism")
 OPT_BOOL(coloredOutput,                  "colors", "",                                false,                   "Colored terminal output based on messages' verbosity")
+OPT_BOOL(compressClauseBuffers,          "ccb", "compress-clause-buffers",            false,                   "Transfer clause buffers in the clause sharing all-reduction in a compressed (delta + varint) encoding")
+OPT_BOOL(commThread,                     "ct", "comm-thread",                         false,                   "Perform all message passing in a dedicated thread, which occupies a core; the main thread only processes arrived messages")
 OPT_BOOL(continuousGrowth,               "cg", "continuous-growth",                   true,                    "Continuous growth of job demands")
 OPT_BOOL(distributedDuplicateDetection,  "ddd", "",                                   false,                   "Distributed duplicate detection for clauses")
 OPT_BOOL(delayMonkey,                    "delaymonkey", "",                           false,                   "Small chance for each MPI call to block for some random amount of time")
@@ -33,12 +36,15 @@ OPT_BOOL(latencyMonkey,                  "latencymonkey", "",
 OPT_BOOL(monitorMpi,                     "mmpi", "monitor-mpi",                       false,                   "Launch an additional thread per process checking when the main thread is inside an MPI call")
 OPT_BOOL(omitSolution,                   "os", "omit-solution",                       false,                   "Do not output solution in mono mode of operation")
 OPT_BOOL(phaseDiversification,           "phasediv", "",                              true,                    "Diversify solvers based on phase in addition to native diversification")
+OPT_BOOL(preprocessFormulas,             "pre", "preprocess",                         false,                   "Simplify non-incremental SAT formulas at the client before distributing them (unit propagation, duplicate/tautology/subsumption removal, bounded variable elimination)")
 OPT_BOOL(pipeLargeSolutions,             "pls", "pipe-large-solutions",               false,                   "Provide large solutions over a named pipe instead of directly writing them into the response JSON")
+OPT_BOOL(prioritizeSchedulingMessages,   "psm", "prioritize-scheduling-messages",     false,                   "Process job scheduling messages as soon as they arrive, possibly before earlier messages from the same source")
 OPT_BOOL(quiet,                          "q", "quiet",                                false,                   "Do not log to stdout besides critical information")
 OPT_BOOL(reactivationScheduling,         "rs", "use-reactivation-scheduling",         true,                    "Perform reactivation-based scheduling")
 OPT_BOOL(regularProcessDistribution,     "rpa", "regular-process-allocation",         false,                   "Signal that processes have been allocated regularly, i.e., the i-th machine hosts ranks c*i through c*i + c-1")
 OPT_BOOL(reshareImprovedLbd,             "ril", "reshare-improved-lbd",               false,                   "Reshare clauses (regardless of their last sharing epoch) if their LBD improved")
 OPT_BOOL(shuffleJobDescriptions,         "sjd", "shuffle-job-descriptions",           false,                   "Shuffle job descriptions given via -job-desc-template option")
+OPT_BOOL(streamJobDescriptions,          "stjd", "stream-job-descriptions",           false,                   "Start a one-shot SAT job while its description is still being received and feed the arriving fragments to its solvers")
 OPT_BOOL(useChecksums,                   "checksums", "",                             false,                   "Compute and verify checksum for every job description transfer")
 OPT_BOOL(watchdog,                       "watchdog", "",                              true,                    "Employ watchdog threads to detect unresponsive program flow")
 OPT_BOOL(warmup,                         "warmup", "",                                false,                   "Do one explicit All-To-All warmup among all nodes in the beginning")
@@ -49,9 +55,14 @@ OPT_BOOL(zeroOnlyLogging,                "0o", "zero-only-logging",
 OPT_INT(activeJobsPerClient,             "ajpc", "active-jobs-per-client",            0,         0, LARGE_INT, "Make each client have up to this many active jobs at any given time")
 OPT_INT(bufferedImportedClsGenerations,  "bicg", "buffered-imported-cls-generations", 4,         1, LARGE_INT, "Number of subsequent full clause sharings to fit in each solver's import buffer")
 OPT_INT(clauseBufferBaseSize,            "cbbs", "clause-buffer-base-size",           1500,      0, MAX_INT,   "Clause buffer base size in integers")
+OPT_INT(clauseFilterMemoryLimit,         "cfml", "clause-filter-memory-limit",        0,         0, LARGE_INT, "Memory limit in MiB for the filter of produced clauses in each process (0: no limit)")
+OPT_INT(clauseFilterShards,              "cfs", "clause-filter-shards",               16,        1, 4096,      "Partition the filter of produced clauses into up to this many individually locked shards, at most four per thread accessing the filter (rounded up to a power of two)")
 OPT_INT(clauseHistoryAggregationFactor,  "chaf", "clause-history-aggregation",        5,         1, LARGE_INT, "Aggregate historic clause batches by this factor")
 OPT_INT(clauseHistoryShortTermMemSize,   "chstms", "clause-history-shortterm-size",   10,        1, LARGE_INT, "Save this many \"full\" aggregated epochs until reducing them")
+OPT_INT(clauseSharingSegments,           "css", "clause-sharing-segments",            1,         1, LARGE_INT, "Split clause buffers into this many bucket-aligned segments which are merged and forwarded in a pipelined manner (1: no pipelining)")
+OPT_INT(distributedDuplicateDetectionEpochs, "ddde", "ddd-epochs",                    30,   -1, LARGE_INT,     "With -ddd, recognize clauses as duplicates which were shared during this many previous epochs (-1: forever)")
 OPT_INT(firstApiIndex,                   "fapii", "first-api-index",                  0,    0, LARGE_INT,      "1st API index: with c clients, uses .api/jobs.{<index>..<index>+c-1}/ as directories")
+OPT_INT(formulaCacheMegabytes,           "fcmb", "formula-cache-megabytes",           4096, 1, LARGE_INT,      "Size limit of the formula cache directory (in MiB); least recently used formulas are removed beyond it")
 OPT_INT(hopsBetweenBfs,                  "hbbfs", "hops-between-bfs",                 10,   0, MAX_INT,        "After a job request hopped this many times after unsuccessful \"hill climbing\" BFS, perform another BFS")
 OPT_INT(hopsUntilBfs,                    "hubfs", "hops-until-bfs",                   LARGE_INT, 0, MAX_INT,   "After a job request hopped this many times, perform a \"hill climbing\" BFS")
 OPT_INT(hopsUntilCollectiveAssignment,   "huca", "hops-until-collective-assignment",  0,    -1, LARGE_INT,     "After a job request hopped this many times, add it to collective negotiation of requests and idle nodes (0: immediately, -1: never");
@@ -63,14 +74,18 @@ OPT_INT(maxIdleDistance,                 "mid", "max-idle-distance",
 OPT_INT(maxJobsPerStreamer,              "mjps", "max-jobs-per-streamer",             0,    0, LARGE_INT,      "Maximum number of jobs to introduce per streamer")
 OPT_INT(maxLbdPartitioningSize,          "mlbdps", "max-lbd-partition-size",          8,    1, LARGE_INT,      "Store clauses with up to this LBD in separate buckets")
 OPT_INT(messageBatchingThreshold,        "mbt", "message-batching-threshold",         1000000, 1000, MAX_INT,  "Employ batching of messages in batches of provided size")
+OPT_INT(messageCoalescingThreshold,      "mct", "message-coalescing-threshold",       0,    0, 65536,          "Send messages up to this size (in bytes) to the same destination within one main loop cycle as a single message (0: disabled)")
 OPT_INT(minNumChunksForImportPerSolver,  "mcips", "min-import-chunks-per-solver",     10,   1, LARGE_INT,      "Min. number of cbbs-sized chunks for buffering produced clauses for export")
 OPT_INT(numBounceAlternatives,           "ba", "bounce-alternatives",                 4,    1, LARGE_INT,      "Number of bounce alternatives per PE (only relevant if -derandomize)")
 OPT_INT(numChunksForExport,              "nce", "export-chunks",                      20,   1, LARGE_INT,      "Number of cbbs-sized chunks for buffering produced clauses for export")
 OPT_INT(numClients,                      "c", "clients",                              1,    -1, LARGE_INT,     "Number of client PEs to initialize (counting backwards from last rank), -1: all PEs are clients")
 OPT_INT(numJobs,                         "J", "jobs",                                 0,    0, LARGE_INT,      "Exit as soon as this number of jobs has been processed")
+OPT_INT(numParserThreads,                "pth", "parser-threads",                     4,    1, LARGE_INT,      "Number of threads with which a client parses each (uncompressed) CNF file")
+OPT_INT(numPostedReceives,               "npr", "posted-receives",                    8,    1, 1024,           "Number of receives for incoming messages which are posted at all times")
 OPT_INT(numThreadsPerProcess,            "t", "threads-per-process",                  1,    0, LARGE_INT,      "Number of worker threads per node")
 OPT_INT(maxLiteralsPerThread,            "mlpt", "max-lits-per-thread",               50000000, 0, MAX_INT,    "If formula is larger than threshold, reduce #threads per PE until #threads=1 or until limit is met \"on average\"")
 OPT_INT(processesPerHost,                "pph", "processes-per-host",                 0,    0, LARGE_INT,      "Tells Mallob how many MPI processes are executed on each physical host")
+OPT_INT(producerRingSize,                "prs", "producer-ring-size",                 65536, 0, 16777216,      "Capacity (in integers) of each solver's lock-free ring buffer for produced clauses")
 OPT_INT(qualityClauseLengthLimit,        "qcll", "quality-clause-length-limit",       8,    0, LARGE_INT,      "Clauses up to this length are considered \"high quality\"")
 OPT_INT(qualityLbdLimit,                 "qlbdl", "quality-lbd-limit",                2,    0, LARGE_INT,      "Clauses with an LBD score up to this value are considered \"high quality\"")
 OPT_INT(seed,                            "seed", "",                                  0,    0, MAX_INT,        "Random seed")
@@ -79,6 +94,7 @@ OPT_INT(strictClauseLengthLimit,         "scll", "strict-clause-length-limit",
 OPT_INT(strictLbdLimit,                  "slbdl", "strict-lbd-limit",                 30,   0, LARGE_INT,      "Only clauses with an LBD score up to this value will be shared")
 OPT_INT(verbosity,                       "v", "verbosity",                            2,    0, 6,              "Logging verbosity: 0=CRIT 1=WARN 2=INFO 3=VERB 4=VVERB 5=DEBG")
 OPT_INT(numWorkers,                      "w", "workers",                              -1,   -1, LARGE_INT,     "Number of worker PEs to initialize (beginning from rank #0), -1: all PEs are workers")
+OPT_INT(warmProcessPoolSize,             "wpp", "warm-process-pool-size",             0,    0, 64,             "Number of pre-started SAT processes per worker which new jobs can be handed to (0: spawn a process per job; ignored with -subproc-prefix)")
 OPT_INT(watchdogAbortMillis,             "wam", "watchdog-abort-millis",              10000, 1, MAX_INT,       "Interval (in milliseconds) after which an un-reset watchdog in a worker's main thread will invoke a crash")
 
 OPT_FLOAT(appCommPeriod,                 "s", "app-comm-period",                      1,    0, LARGE_INT,      "Do job-internal communication every t seconds") 
@@ -99,6 +115,8 @@ OPT_FLOAT(timeLimit,                     "T", "time-limit",
 OPT_STRING(applicationConfiguration,     "app-config", "",                            "",                      "Application configuration: structured as (-key=value;)*")
 OPT_STRING(applicationSpawnMode,         "appmode", "app-spawn-mode",                 "fork",                  "Application mode: \"fork\" (spawn child process for each job on each MPI process) or \"thread\" (execute jobs in separate threads but within the same process)")
 OPT_STRING(clientTemplate,               "client-template", "",                       "",                      "JSON template file which each client uses to decide on job parameters (with -job-template option)")
+OPT_STRING(formulaCacheDirectory,        "fcd", "formula-cache-dir",                  "",                      "Directory in which clients cache parsed formulas in binary form for repeated reads (empty: no caching)")
+OPT_STRING(hostSharedMemoryKey,          "hsmk", "",                                  "",                      "Key of shared memory segments common to the worker processes of a host [internal option, do not use]")
 OPT_STRING(satEngineConfig,              "sec", "sat-engine-config",                  "",                      "Supply config for SAT engine subprocess [internal option, do not use]")
 OPT_STRING(jobDescriptionTemplate,       "job-desc-template", "",                     "",                      "Plain text file, one file path per line, to use as job descriptions (with -job-template option)")
 OPT_STRING(jobTemplate,                  "job-template", "",                          "",                      "JSON template file which each client uses to instantiate jobs indeterminately")
@@ -261,6 +261,321 @@ void testReduce() {
     //LOG(V2_INFO, "BUF: %s\n", out.c_str());
 }
 
+void testMergeManyReaders() {
+    LOG(V2_INFO, "Testing merge of many overlapping clause buffers ...\n");
+
+    for (bool sumMode : {false, true}) {
+
+        AdaptiveClauseDatabase::Setup setup;
+        setup.maxClauseLength = 10;
+        setup.maxLbdPartitionedSize = 5;
+        setup.numLiterals = 1'000'000;
+        setup.slotsForSumOfLengthAndLbd = sumMode;
+        const int nbBuffers = 37;
+
+        // Each buffer draws its clauses from a small common pool
+        // such that many duplicates across buffers arise
+        std::vector<std::vector<int>> buffers;
+        std::set<std::vector<int>> distinct;
+        for (int i = 0; i < nbBuffers; i++) {
+            AdaptiveClauseDatabase cdb(setup);
+            for (int j = 0; j < 500; j++) {
+                int id = (int) (Random::rand() * 2000);
+                int len = 1 + id % setup.maxClauseLength;
+                int lbd = len == 1 ? 1 : 2 + (id/setup.maxClauseLength) % (len-1);
+                std::vector<int> lits;
+                for (int l = 0; l < len; l++) lits.push_back(id*setup.maxClauseLength + l + 1);
+                Clause c{lits.data(), len, lbd};
+                if (!cdb.addClause(c)) continue;
+                lits.push_back(-lbd);
+                distinct.insert(lits);
+            }
+            int numExported;
+            buffers.push_back(cdb.exportBuffer(-1, numExported));
+        }
+
+        AdaptiveClauseDatabase cdb(setup);
+        auto merger = cdb.getBufferMerger(-1);
+        for (auto& buffer : buffers) merger.add(cdb.getBufferReader(buffer.data(), buffer.size()));
+        auto merged = merger.merge();
+
+        // Merged buffer must contain each distinct clause exactly once, in order
+        ClauseComparator compare(sumMode ?
+            (AbstractClauseThreewayComparator*) new LengthLbdSumClauseThreewayComparator(setup.maxClauseLength+2) :
+            (AbstractClauseThreewayComparator*) new LexicographicClauseThreewayComparator()
+        );
+        auto reader = cdb.getBufferReader(merged.data(), merged.size());
+        std::set<std::vector<int>> found;
+        std::vector<int> lastLits;
+        Clause last;
+        for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+            std::vector<int> lits(c.begin, c.begin+c.size);
+            if (last.begin != nullptr) {
+                assert(compare(last, c) || log_return_false("%s >= %s!\n", 
+                    last.toStr().c_str(), c.toStr().c_str()));
+            }
+            last = c;
+            lits.push_back(-c.lbd);
+            assert(!found.count(lits));
+            found.insert(lits);
+        }
+        assert(found == distinct);
+        delete compare.compare;
+    }
+}
+
+void testChunkedSlots() {
+    LOG(V2_INFO, "Testing chunked storage of large clauses ...\n");
+
+    for (bool sumMode : {false, true}) for (bool sortClauses : {false, true}) {
+
+        AdaptiveClauseDatabase::Setup setup;
+        setup.maxClauseLength = 20;
+        setup.maxLbdPartitionedSize = 5;
+        setup.numLiterals = 1'000'000;
+        setup.slotsForSumOfLengthAndLbd = sumMode;
+        AdaptiveClauseDatabase cdb(setup);
+
+        // Insert enough clauses to span many chunks per slot
+        std::multiset<std::vector<int>> inserted;
+        int nbLits = 0;
+        for (int i = 0; i < 20000; i++) {
+            int len = 3 + (int) (Random::rand() * (setup.maxClauseLength-2));
+            len = std::min(len, setup.maxClauseLength);
+            int lbd = std::min(len, 2 + (int) (Random::rand() * (len-1)));
+            std::vector<int> lits;
+            for (int j = 0; j < len; j++) lits.push_back(1 + i*setup.maxClauseLength + j);
+            Clause c{lits.data(), len, lbd};
+            if (!cdb.addClause(c)) continue;
+            lits.push_back(-lbd);
+            inserted.insert(lits);
+            nbLits += len;
+        }
+        assert(cdb.getCurrentlyUsedLiterals() == nbLits);
+        cdb.checkTotalLiterals();
+
+        // Export in two halves to exercise partially consumed chunks
+        std::multiset<std::vector<int>> exported;
+        for (int half : {0, 1}) {
+            int numExported;
+            auto buf = cdb.exportBuffer(half == 0 ? nbLits/2 : -1, numExported, 
+                AdaptiveClauseDatabase::ANY, sortClauses);
+            cdb.checkTotalLiterals();
+            auto reader = cdb.getBufferReader(buf.data(), buf.size());
+            int nbRead = 0;
+            for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+                std::vector<int> lits(c.begin, c.begin+c.size);
+                lits.push_back(-c.lbd);
+                exported.insert(lits);
+                nbRead++;
+            }
+            assert(nbRead == numExported);
+        }
+        assert(cdb.getCurrentlyUsedLiterals() == 0);
+        assert(exported == inserted);
+    }
+}
+
+void testEncodedBuffers() {
+    LOG(V2_INFO, "Testing encoded clause buffers ...\n");
+
+    for (bool sumMode : {false, true}) {
+
+        AdaptiveClauseDatabase::Setup setup;
+        setup.maxClauseLength = 20;
+        setup.maxLbdPartitionedSize = 5;
+        setup.numLiterals = 1'000'000;
+        setup.slotsForSumOfLengthAndLbd = sumMode;
+        AdaptiveClauseDatabase cdb(setup);
+        auto codec = cdb.getBufferCodec();
+
+        std::vector<std::vector<int>> buffers;
+        std::vector<std::vector<int>> encodedBuffers;
+        size_t rawSize = 0, encodedSize = 0;
+        for (int i = 0; i < 8; i++) {
+            AdaptiveClauseDatabase localCdb(setup);
+            for (int j = 0; j < 2000; j++) {
+                int len = 1 + (int) (Random::rand() * setup.maxClauseLength);
+                int lbd = len == 1 ? 1 : 2 + (int) (Random::rand() * (len-1));
+                std::vector<int> lits;
+                for (int l = 0; l < len; l++) {
+                    int var = 1 + (int) (Random::rand() * 1'000'000);
+                    lits.push_back(Random::rand() < 0.5 ? -var : var);
+                }
+                std::sort(lits.begin(), lits.end());
+                localCdb.addClause(Clause{lits.data(), len, lbd});
+            }
+            int numExported;
+            buffers.push_back(localCdb.exportBuffer(-1, numExported));
+            encodedBuffers.push_back(codec.encode(buffers.back().data(), buffers.back().size()));
+            rawSize += buffers.back().size();
+            encodedSize += encodedBuffers.back().size();
+
+            // Full decoding restores the original buffer
+            auto decoded = codec.decode(encodedBuffers.back().data(), encodedBuffers.back().size());
+            assert(decoded == buffers.back());
+        }
+        LOG(V2_INFO, "%i ints raw, %i ints encoded\n", rawSize, encodedSize);
+        assert(encodedSize < rawSize);
+
+        // Merging encoded buffers yields the same result as merging the raw buffers
+        auto rawMerger = cdb.getBufferMerger(-1);
+        for (auto& buffer : buffers) rawMerger.add(cdb.getBufferReader(buffer.data(), buffer.size()));
+        auto rawMerged = rawMerger.merge();
+        auto encodedMerger = cdb.getBufferMerger(-1);
+        for (auto& buffer : encodedBuffers) encodedMerger.add(cdb.getEncodedBufferReader(buffer.data(), buffer.size()));
+        auto encodedMerged = encodedMerger.merge();
+        assert(rawMerged == encodedMerged);
+
+        // Empty buffers
+        std::vector<int> empty;
+        auto reader = cdb.getEncodedBufferReader(empty.data(), empty.size());
+        assert(reader.getNextIncomingClause().begin == nullptr);
+        assert(codec.decode(empty.data(), empty.size()).empty());
+    }
+}
+
+void testSegmentedMerge() {
+    LOG(V2_INFO, "Testing segment-wise merge of clause buffers ...\n");
+
+    for (bool sumMode : {false, true}) for (int nbSegments : {2, 3, 5}) {
+
+        AdaptiveClauseDatabase::Setup setup;
+        setup.maxClauseLength = 20;
+        setup.maxLbdPartitionedSize = 5;
+        setup.numLiterals = 1'000'000;
+        setup.slotsForSumOfLengthAndLbd = sumMode;
+        AdaptiveClauseDatabase cdb(setup);
+        auto segmenter = cdb.getBufferSegmenter(nbSegments);
+
+        std::vector<std::vector<int>> buffers;
+        for (int i = 0; i < 6; i++) {
+            AdaptiveClauseDatabase localCdb(setup);
+            for (int j = 0; j < 1000; j++) {
+                int len = 1 + (int) (Random::rand() * setup.maxClauseLength);
+                int lbd = len == 1 ? 1 : 2 + (int) (Random::rand() * (len-1));
+                std::vector<int> lits;
+                for (int l = 0; l < len; l++) lits.push_back(1 + (int) (Random::rand() * 1000));
+                std::sort(lits.begin(), lits.end());
+                localCdb.addClause(Clause{lits.data(), len, lbd});
+            }
+            int numExported;
+            buffers.push_back(localCdb.exportBuffer(-1, numExported));
+        }
+
+        const int limit = 20000;
+        auto fullMerger = cdb.getBufferMerger(limit);
+        for (auto& buffer : buffers) fullMerger.add(cdb.getBufferReader(buffer.data(), buffer.size()));
+        std::vector<int> fullExcess;
+        auto fullMerged = fullMerger.merge(&fullExcess);
+
+        // Split each buffer and merge segment by segment with the remaining budget
+        std::vector<std::vector<std::vector<int>>> splitBuffers;
+        for (auto& buffer : buffers) {
+            auto segments = segmenter.split(buffer);
+            assert(segments.size() == nbSegments);
+            assert(segmenter.join(segments) == buffer);
+            splitBuffers.push_back(std::move(segments));
+        }
+        std::vector<std::vector<int>> mergedSegments, excessSegments;
+        int mergedLits = 0, excessLits = 0;
+        bool exceeded = false;
+        for (int s = 0; s < nbSegments; s++) {
+            auto merger = cdb.getBufferMerger(exceeded ? 0 : limit - mergedLits);
+            merger.setExcessSizeLimit(limit - excessLits);
+            for (auto& segments : splitBuffers) 
+                merger.add(cdb.getBufferReader(segments[s].data(), segments[s].size()));
+            std::vector<int> excess;
+            mergedSegments.push_back(merger.merge(&excess));
+            excessSegments.push_back(std::move(excess));
+            mergedLits += merger.getNumMergedLiterals();
+            excessLits += merger.getNumExcessLiterals();
+            exceeded |= merger.hasExceededSizeLimit();
+        }
+        assert(exceeded);
+        assert(segmenter.join(mergedSegments) == fullMerged);
+        assert(segmenter.join(excessSegments) == fullExcess);
+    }
+}
+
+void testExportToMemoryRegion() {
+    LOG(V2_INFO, "Testing export of clause buffers to a memory region ...\n");
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 20;
+    setup.maxLbdPartitionedSize = 5;
+    setup.numLiterals = 1'000'000;
+    AdaptiveClauseDatabase cdbVec(setup), cdbRaw(setup);
+    for (int j = 0; j < 5000; j++) {
+        int len = 1 + (int) (Random::rand() * setup.maxClauseLength);
+        int lbd = len == 1 ? 1 : 2 + (int) (Random::rand() * (len-1));
+        std::vector<int> lits;
+        for (int l = 0; l < len; l++) lits.push_back(1 + j*setup.maxClauseLength + l);
+        cdbVec.addClause(Clause{lits.data(), len, lbd});
+        cdbRaw.addClause(Clause{lits.data(), len, lbd});
+    }
+
+    // Both variants yield identical buffers
+    int nbExportedVec, nbExportedRaw;
+    auto buffer = cdbVec.exportBuffer(10'000, nbExportedVec);
+    std::vector<int> region(20'000, -1);
+    size_t size = cdbRaw.exportBuffer(region.data(), region.size(), 10'000, nbExportedRaw);
+    assert(nbExportedRaw == nbExportedVec);
+    assert(size == buffer.size());
+    assert(std::equal(buffer.begin(), buffer.end(), region.begin()));
+    assert(region[size] == -1);
+
+    // A small region limits the number of exported literals
+    std::vector<int> smallRegion(500);
+    size = cdbRaw.exportBuffer(smallRegion.data(), smallRegion.size(), -1, nbExportedRaw);
+    assert(size <= smallRegion.size());
+    assert(nbExportedRaw > 0);
+    auto reader = cdbRaw.getBufferReader(smallRegion.data(), size);
+    int nbRead = 0;
+    for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) nbRead++;
+    assert(nbRead == nbExportedRaw);
+}
+
+void testLargeSlotOrder() {
+    LOG(V2_INFO, "Testing LIFO order of large clauses ...\n");
+
+    for (bool sumMode : {false, true}) {
+
+        AdaptiveClauseDatabase::Setup setup;
+        setup.maxClauseLength = 20;
+        setup.maxLbdPartitionedSize = 5;
+        setup.numLiterals = 1'000'000;
+        setup.slotsForSumOfLengthAndLbd = sumMode;
+        AdaptiveClauseDatabase cdb(setup);
+
+        // Clauses of the same length and LBD, spanning several chunks
+        int len = 5;
+        int nbClauses = 10000;
+        for (int i = 0; i < nbClauses; i++) {
+            std::vector<int> lits;
+            for (int j = 0; j < len; j++) lits.push_back(1 + i*len + j);
+            Clause c{lits.data(), len, 3};
+            assert(cdb.addClause(c));
+        }
+
+        // The newest clause is popped first
+        Clause popped;
+        assert(cdb.popFrontWeak(AdaptiveClauseDatabase::ANY, popped));
+        assert(popped.size == len && popped.begin[0] == 1 + (nbClauses-1)*len);
+        free(popped.begin);
+
+        // An export with a tight limit contains the newest remaining clauses
+        int numExported;
+        auto buf = cdb.exportBuffer(100*len, numExported, AdaptiveClauseDatabase::ANY, /*sortClauses=*/false);
+        assert(numExported == 100);
+        auto reader = cdb.getBufferReader(buf.data(), buf.size());
+        for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+            assert(c.begin[0] > (nbClauses-102)*len);
+        }
+        cdb.checkTotalLiterals();
+    }
+}
+
 int main() {
     Timer::init();
     Random::init(rand(), rand());
@@ -272,6 +587,12 @@ int main() {
     testMinimal();
     testMerge();
     testReduce();
+    testMergeManyReaders();
+    testChunkedSlots();
+    testLargeSlotOrder();
+    testEncodedBuffers();
+    testSegmentedMerge();
+    testExportToMemoryRegion();
 }
 
 
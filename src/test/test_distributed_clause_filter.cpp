@@ -51,6 +51,7 @@ int main() {
     for (int volume = 1; volume <= 32; volume++) {
 
         std::vector<std::vector<bool>> passedMatrix;
+        std::vector<int> numFilteringRanks(clauses.size(), 0);
 
         int allNumFiltered = 0;
         for (int rank = 0; rank < volume; rank++) {
@@ -61,7 +62,10 @@ int main() {
             for (auto& c : clauses) {
                 filter.passClause(c, /*epoch=*/1);
                 r.push_back(filter.passClause(c, /*epoch=*/2));
-                if (!r.back()) numFiltered++;
+                if (!r.back()) {
+                    numFiltered++;
+                    numFilteringRanks[r.size()-1]++;
+                }
             }
             passedMatrix.push_back(std::move(r));
             auto indices = filter.getSlotIndices();
@@ -69,10 +73,21 @@ int main() {
             allNumFiltered += numFiltered;
         }
         LOG(V2_INFO, "[v=%i] Total filtered: %i\n\n", volume, allNumFiltered);
+        // Each clause is detected as a duplicate by exactly one rank
+        for (int n : numFilteringRanks) assert(n == 1);
     }
 
 
     
+    // Entries expire after the number of remembered epochs
+    DistributedClauseFilter filter(/*filterMemory=*/2);
+    filter.update(0, 1);
+    assert(filter.passClause(clauses[0], 1));
+    assert(!filter.passClause(clauses[0], 3));
+    assert(filter.passClause(clauses[0], 6));
+    filter.collectGarbage(10);
+    assert(filter.size() == 0);
+
     //for (auto& c : clauses) LOG(V2_INFO, "%s ~> %lu\n", c.toStr().c_str(), ClauseHasher::hash(c, /*which=*/3));
     //for (auto& v : passedMatrix) {
     //    std::string out;
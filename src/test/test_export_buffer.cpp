@@ -0,0 +1,200 @@
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+
+#include "util/sys/timer.hpp"
+#include "util/logger.hpp"
+#include "util/random.hpp"
+#include "util/sys/process.hpp"
+#include "util/assert.hpp"
+
+#include "app/sat/sharing/export_buffer.hpp"
+
+void testConcurrentProduction() {
+    LOG(V2_INFO, "Testing concurrent clause production ...\n");
+
+    const int maxClauseLength = 20;
+    const int nbProducers = 4;
+    const int nbClausesPerProducer = 200000;
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = maxClauseLength;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 100000;
+    AdaptiveClauseDatabase cdb(setup);
+    ProducedClauseFilter filter(/*epochHorizon=*/20, /*reshareImprovedLbd=*/false, 
+        /*fingerprintsOnly=*/false, /*maxMemoryBytes=*/0, /*nbShards=*/8);
+
+    std::vector<SolverStatistics> stats(nbProducers);
+    std::vector<SolverStatistics*> statsPtrs;
+    for (auto& s : stats) statsPtrs.push_back(&s);
+    ExportBuffer exportBuffer(filter, cdb, statsPtrs, maxClauseLength, nbProducers, /*ringCapacity=*/4096);
+
+    std::atomic_int nbDone = 0;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < nbProducers; p++) {
+        producers.emplace_back([&, p]() {
+            std::vector<int> lits(maxClauseLength);
+            for (int i = 0; i < nbClausesPerProducer; i++) {
+                int len = 1 + (i % maxClauseLength);
+                int lbd = len == 1 ? 1 : 2 + (i % (len-1));
+                for (int j = 0; j < len; j++) lits[j] = (p*nbClausesPerProducer + i)*maxClauseLength + j + 1;
+                exportBuffer.produce(lits.data(), len, lbd, p, /*epoch=*/0);
+            }
+            nbDone++;
+        });
+    }
+
+    // Periodically collect and export as a sharing manager would
+    int nbExported = 0;
+    while (true) {
+        bool done = nbDone == nbProducers;
+        exportBuffer.collect();
+        int nbExportedNow;
+        auto buf = cdb.exportBuffer(-1, nbExportedNow);
+        auto reader = cdb.getBufferReader(buf.data(), buf.size());
+        for (auto c = reader.getNextIncomingClause(); c.begin != nullptr; c = reader.getNextIncomingClause()) {
+            c.assertNonZeroLiterals();
+        }
+        nbExported += nbExportedNow;
+        if (done) break;
+        usleep(1000);
+    }
+    for (auto& t : producers) t.join();
+
+    // Every produced clause must be accounted for exactly once
+    unsigned long nbAdmitted = 0, nbFiltered = 0, nbDropped = 0;
+    exportBuffer.collect();
+    for (auto& s : stats) {
+        nbAdmitted += s.producedClausesAdmitted;
+        nbFiltered += s.producedClausesFiltered;
+        nbDropped += s.producedClausesDropped;
+    }
+    LOG(V2_INFO, "%lu admitted, %lu filtered, %lu dropped, %i exported\n", 
+        nbAdmitted, nbFiltered, nbDropped, nbExported);
+    assert(nbAdmitted + nbFiltered + nbDropped == nbProducers * nbClausesPerProducer);
+    assert(nbFiltered == 0);
+    // Admitted clauses may still be displaced by more important clauses
+    assert(nbExported > 0 && nbExported <= nbAdmitted);
+}
+
+void testFilterEviction() {
+    LOG(V2_INFO, "Testing eviction from produced clause filter ...\n");
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 20;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 10'000'000;
+
+    auto makeCandidate = [&](int id, int epoch) {
+        int len = 1 + (id % setup.maxClauseLength);
+        int lbd = len == 1 ? 1 : 2;
+        std::vector<int> lits;
+        for (int j = 0; j < len; j++) lits.push_back(id*setup.maxClauseLength + j + 1);
+        return ProducedClauseCandidate(lits.data(), len, lbd, /*producerId=*/0, epoch);
+    };
+
+    for (bool fingerprints : {false, true}) {
+
+        // Aging
+        AdaptiveClauseDatabase cdb(setup);
+        ProducedClauseFilter filter(/*epochHorizon=*/4, /*reshareImprovedLbd=*/false, fingerprints);
+        for (int id = 0; id < 1000; id++) 
+            assert(filter.tryRegisterAndInsert(makeCandidate(id, 0), cdb) == ProducedClauseFilter::ADMITTED);
+        for (int id = 0; id < 1000; id++) 
+            assert(filter.tryRegisterAndInsert(makeCandidate(id, 1), cdb) == ProducedClauseFilter::FILTERED);
+        assert(filter.size() == 1000);
+        for (int id = 0; id < 500; id++) {
+            auto c = makeCandidate(id, 2);
+            Clause clause(c.begin, c.size, c.lbd);
+            assert(filter.admitSharing(clause, 2));
+            assert(!filter.admitSharing(clause, 3));
+        }
+        filter.collectGarbage(6);
+        // Entries shared at epoch 2 remain, entries last produced at epoch 1 are evicted
+        assert(filter.size() == 500);
+        filter.collectGarbage(10);
+        assert(filter.size() == 0);
+        assert(filter.tryRegisterAndInsert(makeCandidate(0, 10), cdb) == ProducedClauseFilter::ADMITTED);
+
+        // Memory limit
+        const size_t limit = 1<<20;
+        AdaptiveClauseDatabase cdb2(setup);
+        ProducedClauseFilter limitedFilter(/*epochHorizon=*/-1, /*reshareImprovedLbd=*/false, fingerprints, limit, /*nbShards=*/4);
+        for (int epoch = 0; epoch < 20; epoch++) {
+            for (int id = epoch*2000; id < (epoch+1)*2000; id++) 
+                limitedFilter.tryRegisterAndInsert(makeCandidate(id, epoch), cdb2);
+            limitedFilter.collectGarbage(epoch);
+            assert(limitedFilter.getMemoryFootprint() <= limit);
+        }
+        LOG(V2_INFO, "fingerprints=%i : %lu entries in %lu bytes\n", fingerprints, 
+            limitedFilter.size(), limitedFilter.getMemoryFootprint());
+        assert(limitedFilter.size() > 0);
+    }
+}
+
+void testConcurrentFilter() {
+    LOG(V2_INFO, "Testing concurrent access to sharded produced clause filter ...\n");
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 10;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 10'000'000;
+    AdaptiveClauseDatabase cdb(setup);
+    ProducedClauseFilter filter(/*epochHorizon=*/20, /*reshareImprovedLbd=*/false, 
+        /*fingerprintsOnly=*/false, /*maxMemoryBytes=*/0, /*nbShards=*/5);
+    assert(filter.getNumShards() == 8);
+
+    // All threads register the same clauses: each clause is admitted exactly once,
+    // and each clause is admitted for sharing exactly once
+    const int nbThreads = 4;
+    const int nbClauses = 20000;
+    std::atomic_int nbAdmitted = 0, nbFiltered = 0, nbShared = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nbThreads; t++) {
+        threads.emplace_back([&, t]() {
+            std::vector<int> lits(setup.maxClauseLength);
+            for (int i = 0; i < nbClauses; i++) {
+                int id = (i + t*nbClauses/nbThreads) % nbClauses;
+                int len = 1 + (id % setup.maxClauseLength);
+                for (int j = 0; j < len; j++) lits[j] = id*setup.maxClauseLength + j + 1;
+                auto result = filter.tryRegisterAndInsert(ProducedClauseCandidate(lits.data(), len, 
+                    len == 1 ? 1 : 2, /*producerId=*/t, /*epoch=*/0), cdb);
+                if (result == ProducedClauseFilter::ADMITTED) nbAdmitted++;
+                if (result == ProducedClauseFilter::FILTERED) nbFiltered++;
+            }
+            for (int i = 0; i < nbClauses; i++) {
+                int id = (i + t*nbClauses/nbThreads) % nbClauses;
+                int len = 1 + (id % setup.maxClauseLength);
+                for (int j = 0; j < len; j++) lits[j] = id*setup.maxClauseLength + j + 1;
+                Clause c(lits.data(), len, len == 1 ? 1 : 2);
+                if (filter.admitSharing(c, /*epoch=*/1)) nbShared++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert(nbAdmitted == nbClauses);
+    assert(nbFiltered == (nbThreads-1) * nbClauses);
+    assert(nbShared == nbClauses);
+    assert(filter.size() == nbClauses);
+
+    // Each clause was produced by all threads
+    std::vector<int> lits(setup.maxClauseLength);
+    for (int id = 0; id < nbClauses; id++) {
+        int len = 1 + (id % setup.maxClauseLength);
+        for (int j = 0; j < len; j++) lits[j] = id*setup.maxClauseLength + j + 1;
+        Clause c(lits.data(), len, len == 1 ? 1 : 2);
+        assert(filter.getProducers(c, 1) == (1 << nbThreads) - 1);
+    }
+}
+
+int main() {
+    Timer::init();
+    Random::init(rand(), rand());
+    Logger::init(0, V5_DEBG);
+    Process::init(0);
+
+    testConcurrentProduction();
+    testFilterEviction();
+    testConcurrentFilter();
+}
@@ -0,0 +1,146 @@
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "data/formula_cache.hpp"
+#include "data/job_reader.hpp"
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+#include "util/random.hpp"
+#include "util/sys/fileutils.hpp"
+#include "util/sys/thread_pool.hpp"
+#include "util/sys/timer.hpp"
+
+const std::string cacheDir = "/tmp/mallob_test_formula_cache";
+
+void writeCnf(const std::string& f, int numClauses, std::vector<int>& lits) {
+    lits.clear();
+    std::ofstream out(f);
+    out << "p cnf 1000 " << numClauses << "\n";
+    for (int c = 0; c < numClauses; c++) {
+        for (int i = 0; i < 3; i++) {
+            int lit = (1 + (int) (Random::rand() * 1000)) * (Random::rand() < 0.5 ? -1 : 1);
+            lits.push_back(lit);
+            out << lit << " ";
+        }
+        lits.push_back(0);
+        out << "0\n";
+    }
+    out << "a 1 -2 0\n";
+}
+
+void readAndCompare(const std::string& f, const FormulaCache& cache, const std::vector<int>& lits, bool expectHit) {
+    JobDescription d(1, 1, JobDescription::ONESHOT_SAT);
+    bool hit = cache.read(f, d);
+    assert(hit == expectHit);
+    if (!hit) {
+        assert(JobReader::read({f}, SatReader::ContentMode::ASCII, d, 1, &cache));
+        cache.awaitPendingWrites();
+    }
+    assert(d.getNumFormulaLiterals() == lits.size());
+    const int* fLits = d.getFormulaPayload(0);
+    for (size_t i = 0; i < lits.size(); i++) assert(fLits[i] == lits[i]);
+    assert(d.getNumAssumptionLiterals() == 2);
+    assert(d.getAssumptionsPayload(0)[0] == 1 && d.getAssumptionsPayload(0)[1] == -2);
+}
+
+size_t getNumEntries() {
+    return FileUtils::glob(cacheDir + "/*.rawcnf").size();
+}
+
+void testCacheHit() {
+    LOG(V2_INFO, "Testing cache hits ...\n");
+    FormulaCache cache(cacheDir, 1<<30);
+    std::string f = "/tmp/mallob_test_formula_cache_1.cnf";
+    std::vector<int> lits;
+    writeCnf(f, 10000, lits);
+
+    readAndCompare(f, cache, lits, false);
+    assert(getNumEntries() == 1);
+    readAndCompare(f, cache, lits, true);
+    readAndCompare(f, cache, lits, true);
+
+    // An entry whose header describes another file must not be served
+    auto entries = FileUtils::glob(cacheDir + "/*.rawcnf");
+    {
+        std::fstream entry(entries.front(), std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t otherSize = 1;
+        entry.write((const char*) &otherSize, sizeof(otherSize));
+    }
+    readAndCompare(f, cache, lits, false);
+    readAndCompare(f, cache, lits, true);
+
+    // A modified file must not be served from the old entry
+    usleep(10000);
+    writeCnf(f, 5000, lits);
+    readAndCompare(f, cache, lits, false);
+    readAndCompare(f, cache, lits, true);
+    remove(f.c_str());
+}
+
+void testEviction() {
+    LOG(V2_INFO, "Testing eviction ...\n");
+    std::vector<std::string> files;
+    std::vector<std::vector<int>> lits(4);
+    for (int i = 0; i < 4; i++) {
+        files.push_back("/tmp/mallob_test_formula_cache_evict_" + std::to_string(i) + ".cnf");
+        writeCnf(files.back(), 1000, lits[i]);
+    }
+    // Each entry takes 16kB: room for two of them
+    FormulaCache cache(cacheDir, 40'000);
+    readAndCompare(files[0], cache, lits[0], false);
+    sleep(1);
+    readAndCompare(files[1], cache, lits[1], false);
+    sleep(1);
+    readAndCompare(files[0], cache, lits[0], true); // refresh #0
+    sleep(1);
+    readAndCompare(files[2], cache, lits[2], false); // evicts #1
+    assert(getNumEntries() == 2);
+    readAndCompare(files[0], cache, lits[0], true);
+    readAndCompare(files[2], cache, lits[2], true);
+    readAndCompare(files[1], cache, lits[1], false);
+    for (auto& f : files) remove(f.c_str());
+}
+
+void testNamedPipe() {
+    LOG(V2_INFO, "Testing named pipes ...\n");
+    FormulaCache cache(cacheDir, 1<<30);
+    std::string f = "/tmp/mallob_test_formula_cache_fifo.pipe";
+    std::string plain = "/tmp/mallob_test_formula_cache_fifo_src.cnf";
+    remove(f.c_str());
+    assert(mkfifo(f.c_str(), 0600) == 0);
+
+    // Each formula written to the pipe must be read anew, never from the cache
+    for (int numClauses : {1000, 500}) {
+        std::vector<int> lits;
+        writeCnf(plain, numClauses, lits);
+        std::thread writer([&]() {
+            std::ifstream in(plain);
+            std::ofstream out(f);
+            out << in.rdbuf();
+        });
+        readAndCompare(f, cache, lits, false);
+        writer.join();
+        assert(getNumEntries() == 0);
+    }
+    remove(plain.c_str());
+    remove(f.c_str());
+}
+
+int main() {
+    Timer::init();
+    Random::init(rand(), rand());
+    Logger::init(0, V5_DEBG);
+    ProcessWideThreadPool::init(1);
+
+    for (auto& entry : FileUtils::glob(cacheDir + "/*")) FileUtils::rm(entry);
+    testCacheHit();
+    for (auto& entry : FileUtils::glob(cacheDir + "/*")) FileUtils::rm(entry);
+    testEviction();
+    for (auto& entry : FileUtils::glob(cacheDir + "/*")) FileUtils::rm(entry);
+    testNamedPipe();
+}
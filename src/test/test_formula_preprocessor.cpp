@@ -0,0 +1,142 @@
+
+#include <vector>
+
+#include "app/sat/data/formula_preprocessor.hpp"
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+#include "util/random.hpp"
+#include "util/sys/timer.hpp"
+
+bool satisfies(const std::vector<int>& model, const std::vector<int>& lits);
+
+// Brute force: returns some model satisfying all clauses and assumptions (empty if there is none)
+std::vector<int> solve(const std::vector<int>& lits, const std::vector<int>& assumptions, int numVars) {
+    std::vector<int> model(numVars+1);
+    for (size_t bits = 0; bits < (1ul << numVars); bits++) {
+        for (int x = 1; x <= numVars; x++) model[x] = (bits & (1ul << (x-1))) ? x : -x;
+        bool ok = true;
+        for (int a : assumptions) if (model[std::abs(a)] != a) ok = false;
+        if (ok && satisfies(model, lits)) return model;
+    }
+    return std::vector<int>();
+}
+
+bool satisfies(const std::vector<int>& model, const std::vector<int>& lits) {
+    bool clauseSat = false;
+    for (int lit : lits) {
+        if (lit == 0) {
+            if (!clauseSat) return false;
+            clauseSat = false;
+        } else if (model[std::abs(lit)] == lit) clauseSat = true;
+    }
+    return true;
+}
+
+void testRandomFormulas() {
+
+    const int numVars = 14;
+    int numSat = 0, numUnsat = 0, numChanged = 0;
+    for (int round = 0; round < 300; round++) {
+
+        // Random formula with short clauses and some duplicates
+        std::vector<int> lits;
+        int numClauses = 10 + (int) (Random::rand() * 60);
+        for (int c = 0; c < numClauses; c++) {
+            int len = Random::rand() < 0.03 ? 1 : 2 + (int) (Random::rand() * 4);
+            for (int i = 0; i < len; i++) {
+                lits.push_back((1 + (int) (Random::rand() * numVars)) * (Random::rand() < 0.5 ? -1 : 1));
+            }
+            lits.push_back(0);
+            if (Random::rand() < 0.1) {
+                // duplicate the clause
+                size_t end = lits.size(), begin = end-1;
+                while (begin > 0 && lits[begin-1] != 0) begin--;
+                for (size_t i = begin; i < end; i++) lits.push_back(lits[i]);
+            }
+        }
+        std::vector<int> assumptions;
+        if (round % 3 == 0) assumptions = {(Random::rand() < 0.5 ? -1 : 1) * (1 + (int) (Random::rand() * numVars))};
+
+        JobDescription desc(1, 1, JobDescription::ONESHOT_SAT);
+        desc.beginInitialization(0);
+        desc.addLiterals(lits.data(), lits.size());
+        desc.addAssumptions(assumptions.data(), assumptions.size());
+        desc.endInitialization();
+
+        FormulaPreprocessor pre;
+        bool changed = pre.preprocess(desc);
+        if (changed) numChanged++;
+        std::vector<int> simplified(desc.getFormulaPayload(0), desc.getFormulaPayload(0) + desc.getFormulaPayloadSize(0));
+        std::vector<int> newAssumptions(desc.getAssumptionsPayload(0), desc.getAssumptionsPayload(0) + desc.getAssumptionsSize(0));
+        assert(newAssumptions == assumptions);
+        if (!changed) assert(simplified == lits);
+
+        bool sat = !solve(lits, assumptions, numVars).empty();
+        auto model = solve(simplified, assumptions, numVars);
+        assert(sat == !model.empty() || log_return_false("Round %i: satisfiability changed\n", round));
+        if (!sat) {
+            numUnsat++;
+            continue;
+        }
+        numSat++;
+        // Only variables which occur in the simplified formula are known to the solver
+        std::vector<int> solverModel(1, 0);
+        int maxVar = 0;
+        for (int lit : simplified) maxVar = std::max(maxVar, std::abs(lit));
+        for (int a : assumptions) maxVar = std::max(maxVar, std::abs(a));
+        for (int x = 1; x <= maxVar; x++) solverModel.push_back(model[x]);
+        pre.reconstructModel(solverModel);
+        int origMaxVar = 0;
+        for (int lit : lits) origMaxVar = std::max(origMaxVar, std::abs(lit));
+        for (int a : assumptions) origMaxVar = std::max(origMaxVar, std::abs(a));
+        assert(solverModel.size() == origMaxVar+1);
+        assert(satisfies(solverModel, lits) || log_return_false("Round %i: reconstructed model invalid\n", round));
+        for (int a : assumptions) assert(solverModel[std::abs(a)] == a);
+    }
+    LOG(V2_INFO, "%i SAT, %i UNSAT, %i simplified\n", numSat, numUnsat, numChanged);
+    assert(numSat > 0 && numUnsat > 0);
+}
+
+void testLargeFormula(bool withUnit) {
+    // Chain of implications with duplicate and subsumed clauses
+    std::vector<int> lits;
+    const int n = 1'000'000;
+    for (int x = 1; x < n; x++) {
+        lits.insert(lits.end(), {-x, x+1, 0});
+        lits.insert(lits.end(), {x+1, -x, 0});
+        lits.insert(lits.end(), {-x, x+1, -(x % 100 + 1), 0});
+    }
+    if (withUnit) lits.insert(lits.end(), {1, 0});
+    JobDescription desc(1, 1, JobDescription::ONESHOT_SAT);
+    desc.beginInitialization(0);
+    desc.addLiterals(lits.data(), lits.size());
+    desc.endInitialization();
+
+    float time = Timer::elapsedSeconds();
+    FormulaPreprocessor pre;
+    assert(pre.preprocess(desc));
+    time = Timer::elapsedSeconds() - time;
+    LOG(V2_INFO, "Preprocessed %i-var chain to %lu lits in %.3fs\n", n, desc.getFormulaPayloadSize(0), time);
+    if (withUnit) assert(desc.getFormulaPayloadSize(0) == 0);
+    else assert(desc.getFormulaPayloadSize(0) < lits.size() / 10);
+
+    std::vector<int> model(1, 0);
+    const int* simplified = desc.getFormulaPayload(0);
+    for (size_t i = 0; i < desc.getFormulaPayloadSize(0); i++) {
+        int var = std::abs(simplified[i]);
+        if (var >= model.size()) model.resize(var+1, 0);
+    }
+    pre.reconstructModel(model);
+    assert(model.size() == n+1);
+    assert(satisfies(model, lits));
+}
+
+int main() {
+    Timer::init();
+    Random::init(rand(), rand());
+    Logger::init(0, V5_DEBG);
+
+    testRandomFormulas();
+    testLargeFormula(true);
+    testLargeFormula(false);
+}
@@ -0,0 +1,69 @@
+
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+
+#include "util/sys/timer.hpp"
+#include "util/logger.hpp"
+#include "util/sys/process.hpp"
+#include "util/sys/shared_memory.hpp"
+#include "util/sys/futex.hpp"
+#include "util/assert.hpp"
+
+void testWakeUp() {
+    LOG(V2_INFO, "Testing futex wake-up ...\n");
+
+    // Place the futex in shared memory as a SAT process adapter would
+    std::string shmemId = "/mallob_test_futex." + std::to_string(getpid());
+    void* mem = SharedMemory::create(shmemId, sizeof(Futex));
+    Futex* futex = new (mem) Futex();
+
+    // Waiting on an outdated epoch returns immediately
+    uint32_t epoch = futex->getEpoch();
+    futex->notify();
+    float time = Timer::elapsedSeconds();
+    futex->wait(epoch, 5'000'000);
+    assert(Timer::elapsedSeconds() - time < 1);
+
+    // Waiting without a notification ends with the timeout
+    epoch = futex->getEpoch();
+    time = Timer::elapsedSeconds();
+    futex->wait(epoch, 20'000);
+    time = Timer::elapsedSeconds() - time;
+    assert(time >= 0.015 && time < 1);
+
+    // A notification wakes up a waiting thread long before its timeout
+    std::atomic_bool request = false;
+    std::atomic_int nbServed = 0;
+    std::thread waiter([&]() {
+        uint32_t seen = futex->getEpoch();
+        while (true) {
+            if (request) {
+                request = false;
+                if (++nbServed == 100) break;
+            }
+            futex->wait(seen, 5'000'000);
+            seen = futex->getEpoch();
+        }
+    });
+    time = Timer::elapsedSeconds();
+    for (int i = 0; i < 100; i++) {
+        request = true;
+        futex->notify();
+        while (request) usleep(10);
+    }
+    waiter.join();
+    time = Timer::elapsedSeconds() - time;
+    LOG(V2_INFO, "100 round trips in %.4fs\n", time);
+    assert(time < 5);
+
+    SharedMemory::free(shmemId, (char*) mem, sizeof(Futex));
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+    Process::init(0);
+
+    testWakeUp();
+}
@@ -4,6 +4,11 @@
 
 #include <unordered_set>
 #include <iostream>
+#include <algorithm>
+
+#include "app/sat/data/clause_kernels.hpp"
+#include "util/assert.hpp"
+#include "util/random.hpp"
 
 size_t commutativeHash(const int* begin, int size, int which = 3) {
     static unsigned const int primes [] = 
@@ -28,8 +33,35 @@ size_t nonCommutativeHash(const int* begin, int size, int which = 3) {
     return res;
 }
 
+void testKernels() {
+    Random::init(1, 1);
+    std::cout << "Kernels: " << Mallob::kernels::getSelectedInstructionSet() << std::endl;
+    std::vector<int> left, right;
+    for (int rep = 0; rep < 100000; rep++) {
+        int size = 1 + (int) (Random::rand() * 255);
+        left.resize(size);
+        for (int i = 0; i < size; i++) {
+            left[i] = (int) (Random::rand() * 2000001) - 1000000;
+        }
+        right = left;
+        if (Random::rand() < 0.5) {
+            int pos = (int) (Random::rand() * size);
+            right[pos] += Random::rand() < 0.5 ? -1 : 1;
+        }
+        for (int which : {1, 3}) {
+            assert(Mallob::commutativeHash(left.data(), size, which) == commutativeHash(left.data(), size, which));
+        }
+        bool equal = left == right;
+        assert(Mallob::kernels::equals(left.data(), right.data(), size) == equal);
+        int cmp = std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end()) ? -1 : (equal ? 0 : 1);
+        assert(Mallob::kernels::compare(left.data(), right.data(), size) == cmp);
+    }
+}
+
 int main() {
 
+    testKernels();
+
     for (int shift = 0; shift < 64; shift += 4) {
         std::cout << "shift=" << shift << std::endl;
 
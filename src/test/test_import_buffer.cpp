@@ -1,5 +1,6 @@
 
 #include <algorithm>
+#include <set>
 
 #include "app/sat/sharing/import_buffer.hpp"
 
@@ -144,6 +145,54 @@ void testConcurrentImport() {
     LOG(V2_INFO, "%i produced, %i digested\n", nbTotalAdded, nbTotalDigested);
 }
 
+void testImportOfReferencedClauses() {
+    LOG(V2_INFO, "Testing import of clauses referencing an external buffer ...\n");
+
+    SolverSetup setup;
+    setup.strictClauseLengthLimit = 20;
+	setup.strictLbdLimit = 20;
+	setup.clauseBaseBufferSize = 1500;
+	setup.anticipatedLitsToImportPerCycle = 20000;
+	setup.minNumChunksPerSolver = 100;
+	setup.numBufferedClsGenerations = 4;
+    SolverStatistics stats;
+    stats.histProduced = new ClauseHistogram(20);
+    stats.histDigested = new ClauseHistogram(20);
+    ImportBuffer importBuffer(setup, stats);
+
+    // Clauses of length 6 with an implicit (LBD=6) and with an explicit LBD
+    const int len = 6;
+    std::vector<int> data;
+    for (int i = 0; i < 100*len; i++) data.push_back(i+1);
+    std::set<std::vector<int>> expected;
+    for (int lbd : {2, len}) {
+        std::forward_list<Mallob::Clause> list;
+        for (int i = 0; i < 50; i++) {
+            int* begin = data.data() + ((lbd == len ? 50 : 0) + i)*len;
+            list.emplace_front(begin, len, lbd);
+            std::vector<int> lits(begin, begin+len);
+            lits.push_back(lbd);
+            expected.insert(lits);
+        }
+        int budget = importBuffer.getLiteralBudget(len, lbd);
+        assert(budget >= 50*len);
+        importBuffer.performImport(len, lbd, list, 50*len);
+        assert(list.empty());
+    }
+    // The import buffer must not refer to the original data
+    std::fill(data.begin(), data.end(), 0);
+
+    std::set<std::vector<int>> received;
+    auto cls = importBuffer.get(AdaptiveClauseDatabase::NONUNITS);
+    while (cls.begin != nullptr) {
+        std::vector<int> lits(cls.begin, cls.begin+cls.size);
+        lits.push_back(cls.lbd);
+        received.insert(lits);
+        cls = importBuffer.get(AdaptiveClauseDatabase::NONUNITS);
+    }
+    assert(received == expected);
+}
+
 int main() {
     Timer::init();
     Random::init(rand(), rand());
@@ -151,5 +200,6 @@ int main() {
     Process::init(0);
     ProcessWideThreadPool::init(4);
     
+    testImportOfReferencedClauses();
     testConcurrentImport();
 }
@@ -50,6 +50,14 @@ void testIncrementalExample() {
     assert(desc.getNumAssumptionLiterals() == 1);
 
     auto exported = desc.getSerialization(0);
+    // Meta data can be read from a partial serialization
+    size_t metadataSize = JobDescription::readMetadataSize(exported->data(), exported->size());
+    assert(metadataSize > 0);
+    assert(JobDescription::readMetadataSize(exported->data(), metadataSize-1) == 0);
+    assert(JobDescription::readJobId(exported->data()) == 1);
+    assert(JobDescription::readRevisionIndex(exported->data()) == 0);
+    assert(JobDescription::readFormulaSize(exported->data()) == 6);
+    assert(JobDescription::readAssumptionsSize(exported->data()) == 1);
 
     JobDescription imported(1, 1, JobDescription::Application::INCREMENTAL_SAT, true);
     imported.deserialize(exported);
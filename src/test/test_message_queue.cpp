@@ -11,11 +11,48 @@
 #include "comm/mympi.hpp"
 #include "util/params.hpp"
 #include "data/job_transfer.hpp"
+#include "comm/message_buffer_pool.hpp"
+#include "util/sys/thread_pool.hpp"
 
 const int TAG_INT_VEC = 111;
 const int TAG_ACK = 112;
 const int TAG_EXIT = 113;
 const int TAG_PINGPONG = 114;
+const int TAG_PRIORITIZED = 115;
+
+void testBufferPool() {
+
+    MessageBufferPool pool;
+    auto buffer = pool.acquire(100);
+    assert(buffer.empty() && buffer.capacity() >= 100);
+    buffer.resize(100);
+    const uint8_t* address = buffer.data();
+    assert(pool.release(buffer));
+    assert(pool.getNumPooledBuffers() == 1);
+
+    // The buffer is reused for any size of its class
+    buffer = pool.acquire(128);
+    assert(buffer.empty() && buffer.data() == address);
+    assert(pool.getNumPooledBuffers() == 0);
+    assert(pool.release(buffer));
+
+    // Too small or too large buffers are not pooled
+    std::vector<uint8_t> tiny(10);
+    assert(!pool.release(tiny));
+    std::vector<uint8_t> huge(100'000'000);
+    assert(!pool.release(huge));
+
+    // A size class only holds a limited amount of memory
+    int numReleased = 0;
+    for (int i = 0; i < 10; i++) {
+        auto large = pool.acquire(1'000'000);
+        assert(large.capacity() >= 1'000'000);
+        std::vector<uint8_t> other(1'000'000);
+        if (pool.release(other)) numReleased++;
+    }
+    assert(numReleased > 0 && numReleased < 10);
+    LOG(V2_INFO, "Buffer pool verified\n");
+}
 
 void testSelfMessages() {
 
@@ -175,9 +212,261 @@ void testBigP2P() {
     LOG(V2_INFO, "Max delay: %.4f s\n", maxDelay);
 }
 
+void testStreamedP2P() {
+
+    Terminator::reset();
+    int rank = MyMpi::rank(MPI_COMM_WORLD);
+    auto& q = MyMpi::getMessageQueue();
+    q.clearCallbacks();
+
+    // Message #0 is declined by the fragment callback, message #1 is taken over
+    const int n = 10'000'000;
+    auto makeVec = [&](int marker) {
+        IntVec vec;
+        vec.data.push_back(marker);
+        for (int i = 1; i < n; i++) vec.data.push_back(i);
+        return vec.serialize();
+    };
+
+    std::vector<uint8_t> streamed;
+    int numFragments = 0;
+    bool streamDone = false;
+    int numAssembled = 0;
+    auto checkDone = [&](int source) {
+        if (!streamDone || numAssembled != 1) return;
+        MyMpi::isend(source, TAG_EXIT, IntVec());
+        Terminator::setTerminating();
+    };
+    q.registerFragmentCallback(TAG_INT_VEC, [&](const MessageQueue::Fragment& frag) {
+        assert(!frag.cancelled);
+        if (frag.index == 0) {
+            int marker;
+            memcpy(&marker, frag.data, sizeof(int));
+            if (marker == 0) return false;
+            streamed.reserve(frag.total * frag.size);
+        }
+        assert(frag.index == numFragments);
+        numFragments++;
+        streamed.insert(streamed.end(), frag.data, frag.data+frag.size);
+        if (frag.index+1 == frag.total) {
+            auto vec = Serializable::get<IntVec>(streamed).data;
+            assert(vec.size() == n);
+            for (size_t i = 1; i < vec.size(); i++) assert(vec[i] == i);
+            LOG(V2_INFO, "Streamed message verified (%i fragments)\n", numFragments);
+            streamDone = true;
+            checkDone(frag.source);
+        }
+        return true;
+    });
+    q.registerCallback(TAG_INT_VEC, [&](MessageHandle& h) {
+        auto vec = Serializable::get<IntVec>(h.getRecvData()).data;
+        assert(vec.size() == n && vec[0] == 0);
+        numAssembled++;
+        LOG(V2_INFO, "Assembled message verified\n");
+        checkDone(h.source);
+    });
+    q.registerCallback(TAG_EXIT, [&](MessageHandle& h) {
+        Terminator::setTerminating();
+    });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        MyMpi::isend(1, TAG_INT_VEC, makeVec(0));
+        MyMpi::isend(1, TAG_INT_VEC, makeVec(1));
+    }
+    while (!Terminator::isTerminating()) q.advance();
+    if (rank == 1) assert(numAssembled == 1 && numFragments > 1);
+}
+
+void testGrowingP2P(bool reserve) {
+
+    Terminator::reset();
+    int rank = MyMpi::rank(MPI_COMM_WORLD);
+    auto& q = MyMpi::getMessageQueue();
+    q.clearCallbacks();
+
+    // The message is sent while its data are still being appended to
+    const int n = 10'000'000;
+    IntVec vec;
+    for (int i = 0; i < n; i++) vec.data.push_back(i);
+    auto full = vec.serialize();
+
+    q.registerCallback(TAG_INT_VEC, [&](MessageHandle& h) {
+        auto recv = Serializable::get<IntVec>(h.getRecvData()).data;
+        assert(recv.size() == n);
+        for (size_t i = 0; i < recv.size(); i++) assert(recv[i] == i);
+        LOG(V2_INFO, "Grown message verified\n");
+        MyMpi::isend(h.source, TAG_EXIT, IntVec());
+        Terminator::setTerminating();
+    });
+    q.registerCallback(TAG_EXIT, [&](MessageHandle& h) {
+        Terminator::setTerminating();
+    });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    DataPtr growing(new std::vector<uint8_t>());
+    size_t chunkSize = full.size() / 100;
+    if (rank == 0) {
+        // Without a reservation, the data may still be reallocated while they are sent
+        if (reserve) growing->reserve(full.size());
+        growing->insert(growing->end(), full.begin(), full.begin()+chunkSize);
+        q.sendGrowing(growing, full.size(), 1, TAG_INT_VEC);
+    }
+    while (!Terminator::isTerminating()) {
+        if (rank == 0 && growing->size() < full.size()) {
+            size_t end = std::min(full.size(), growing->size()+chunkSize);
+            growing->insert(growing->end(), full.begin()+growing->size(), full.begin()+end);
+        }
+        q.advance();
+    }
+}
+
+void testCancelledP2P() {
+
+    Terminator::reset();
+    int rank = MyMpi::rank(MPI_COMM_WORLD);
+    auto& q = MyMpi::getMessageQueue();
+    q.clearCallbacks();
+
+    // Message #1 is streamed and cancelled after some of its fragments, 
+    // message #0 is sent afterwards and must arrive intact
+    const int n = 10'000'000;
+    auto makeVec = [&](int marker) {
+        IntVec vec;
+        vec.data.push_back(marker);
+        for (int i = 1; i < n; i++) vec.data.push_back(i);
+        return vec.serialize();
+    };
+
+    int numFragments = 0;
+    bool cancelSeen = false;
+    bool assembled = false;
+    auto checkDone = [&](int source) {
+        if (!cancelSeen || !assembled) return;
+        MyMpi::isend(source, TAG_EXIT, IntVec());
+        Terminator::setTerminating();
+    };
+    q.registerFragmentCallback(TAG_INT_VEC, [&](const MessageQueue::Fragment& frag) {
+        if (frag.cancelled) {
+            LOG(V2_INFO, "Stream cancelled after %i fragments\n", numFragments);
+            assert(numFragments > 0);
+            cancelSeen = true;
+            checkDone(frag.source);
+            return true;
+        }
+        if (frag.index == 0) {
+            int marker;
+            memcpy(&marker, frag.data, sizeof(int));
+            if (marker == 0) return false;
+        }
+        assert(frag.index == numFragments);
+        assert(frag.index+1 < frag.total);
+        numFragments++;
+        return true;
+    });
+    q.registerCallback(TAG_INT_VEC, [&](MessageHandle& h) {
+        auto vec = Serializable::get<IntVec>(h.getRecvData()).data;
+        assert(vec.size() == n && vec[0] == 0);
+        for (size_t i = 1; i < vec.size(); i++) assert(vec[i] == i);
+        LOG(V2_INFO, "Message after cancelled message verified\n");
+        assembled = true;
+        checkDone(h.source);
+    });
+    q.registerCallback(TAG_EXIT, [&](MessageHandle& h) {
+        Terminator::setTerminating();
+    });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    auto full = makeVec(1);
+    DataPtr growing(new std::vector<uint8_t>());
+    if (rank == 0) {
+        growing->reserve(full.size());
+        growing->insert(growing->end(), full.begin(), full.begin()+full.size()/3);
+        int sendId = q.sendGrowing(growing, full.size(), 1, TAG_INT_VEC);
+        float time = Timer::elapsedSeconds();
+        while (Timer::elapsedSeconds() - time < 0.5) q.advance();
+        q.cancelSend(sendId);
+        MyMpi::isend(1, TAG_INT_VEC, makeVec(0));
+    }
+    while (!Terminator::isTerminating()) q.advance();
+}
+
+void testPrioritizedP2P(int coalescingThreshold) {
+
+    Terminator::reset();
+    int rank = MyMpi::rank(MPI_COMM_WORLD);
+    auto& q = MyMpi::getMessageQueue();
+    q.clearCallbacks();
+    q.setPriority(TAG_PRIORITIZED, 1);
+    q.setCoalescingThreshold(coalescingThreshold);
+
+    // Ordinary messages of varying size must arrive in order, 
+    // prioritized messages may overtake them
+    const int numMessages = 2000;
+    const int prioritizedInterval = 50;
+    int numReceived = 0;
+    int numPrioritizedReceived = 0;
+    int numOvertaking = 0;
+    auto checkDone = [&](int source) {
+        if (numReceived < numMessages || numPrioritizedReceived < numMessages/prioritizedInterval) return;
+        LOG(V2_INFO, "All messages received, %i prioritized messages overtook others\n", numOvertaking);
+        MyMpi::isend(source, TAG_EXIT, IntVec());
+        Terminator::setTerminating();
+    };
+    q.registerCallback(TAG_INT_VEC, [&](MessageHandle& h) {
+        auto vec = Serializable::get<IntVec>(h.getRecvData()).data;
+        assert(vec[0] == numReceived || LOG_RETURN_FALSE("Message %i received at position %i\n", vec[0], numReceived));
+        numReceived++;
+        checkDone(h.source);
+    });
+    q.registerCallback(TAG_PRIORITIZED, [&](MessageHandle& h) {
+        auto vec = Serializable::get<IntVec>(h.getRecvData()).data;
+        // sent right after ordinary message #vec[0]
+        if (numReceived <= vec[0]) numOvertaking++;
+        numPrioritizedReceived++;
+        checkDone(h.source);
+    });
+    q.registerCallback(TAG_EXIT, [&](MessageHandle& h) {
+        Terminator::setTerminating();
+    });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        for (int i = 0; i < numMessages; i++) {
+            IntVec vec;
+            vec.data.resize(i % 7 == 0 ? 200'000 : 1+i%10);
+            vec.data[0] = i;
+            MyMpi::isend(1, TAG_INT_VEC, vec);
+            if ((i+1) % prioritizedInterval == 0) {
+                vec.data.resize(1);
+                MyMpi::isend(1, TAG_PRIORITIZED, vec);
+            }
+            if (i % 10 == 9) q.advance();
+        }
+    }
+    while (!Terminator::isTerminating()) q.advance();
+    q.setCoalescingThreshold(0);
+}
+
+void testAll() {
+    //testSelfMessages();
+    //testSimpleP2P();
+    testBigP2P();
+    testStreamedP2P();
+    testGrowingP2P(true);
+    testGrowingP2P(false);
+    testCancelledP2P();
+    testPrioritizedP2P(0);
+    testPrioritizedP2P(1000);
+}
+
 int main(int argc, char *argv[]) {
 
-    MyMpi::init();
+    Parameters params;
+    params.init(argc, argv);
+
+    // The second round of tests uses a communication thread
+    MyMpi::init(/*threadMultiple=*/true);
     Timer::init();
     int rank = MyMpi::rank(MPI_COMM_WORLD);
 
@@ -186,13 +475,18 @@ int main(int argc, char *argv[]) {
     Random::init(rand(), rand());
     Logger::init(rank, V5_DEBG);
 
-    Parameters params;
-    params.init(argc, argv);
+    ProcessWideThreadPool::init(2);
     MyMpi::setOptions(params);
 
-    //testSelfMessages();
-    //testSimpleP2P();
-    testBigP2P();
+    testBufferPool();
+    testAll();
+
+    LOG(V2_INFO, "Repeating tests with a communication thread\n");
+    MPI_Barrier(MPI_COMM_WORLD);
+    MyMpi::setMessageQueue(new MessageQueue(params.messageBatchingThreshold(), 
+        params.numPostedReceives(), /*commThread=*/true));
+    MyMpi::getMessageQueue().setCoalescingThreshold(params.messageCoalescingThreshold());
+    testAll();
 
-    MPI_Finalize();
+    MyMpi::finalize();
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+
+#include <string>
+#include <unistd.h>
+
+#include "util/sys/timer.hpp"
+#include "util/logger.hpp"
+#include "util/sys/process.hpp"
+#include "util/assert.hpp"
+#include "app/sat/job/sat_process_pool.hpp"
+
+// Forks a child which behaves like a warm SAT process: It waits until its
+// slot has been created, then awaits the options of a job and exits with
+// code 0 if it received the expected options, 1 if it received other options,
+// and 2 if it was told to terminate.
+pid_t launchWarmChild(const std::string& expectedArgs) {
+    int fds[2];
+    assert(pipe(fds) == 0);
+    pid_t pid = Process::createChild();
+    if (pid == 0) {
+        char c;
+        close(fds[1]);
+        if (read(fds[0], &c, 1) != 1) _exit(3);
+        std::string args;
+        if (!SatProcessPool::awaitStart(args)) _exit(2);
+        _exit(args == expectedArgs ? 0 : 1);
+    }
+    close(fds[0]);
+    SatProcessPool::adopt(pid);
+    char c = 0;
+    assert(write(fds[1], &c, 1) == 1);
+    close(fds[1]);
+    return pid;
+}
+
+int awaitExitCode(pid_t pid) {
+    int status;
+    while (!Process::didChildExit(pid, &status)) usleep(1000);
+    assert(WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+void testHandOver() {
+    LOG(V2_INFO, "Testing hand-over of a job to a warm process ...\n");
+
+    std::string args = "-t=4 -v=3 -mono=/tmp/instance.cnf";
+    pid_t warmPid = launchWarmChild(args);
+
+    // The process can be taken as soon as it listens
+    pid_t pid = -1;
+    float time = Timer::elapsedSeconds();
+    while (pid == -1) {
+        assert(Timer::elapsedSeconds() - time < 10);
+        pid = SatProcessPool::take(args);
+        if (pid == -1) usleep(1000);
+    }
+    assert(pid == warmPid);
+    assert(awaitExitCode(pid) == 0);
+
+    // No further process left
+    assert(SatProcessPool::take(args) == -1);
+}
+
+void testShutdown() {
+    LOG(V2_INFO, "Testing shutdown of warm processes ...\n");
+
+    pid_t pid = launchWarmChild("");
+    SatProcessPool::shutdown();
+    assert(awaitExitCode(pid) == 2);
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+    Process::init(0);
+
+    testHandOver();
+    testShutdown();
+}
@@ -3,18 +3,107 @@
 #include "util/assert.hpp"
 #include <vector>
 #include <string>
+#include <fstream>
 
 #include "util/random.hpp"
 #include "util/sat_reader.hpp"
 #include "util/logger.hpp"
 #include "util/sys/timer.hpp"
 
+// Write a random CNF with comments, multi-line clauses, and assumptions
+void writeRandomCnf(const std::string& f, std::vector<int>& lits, std::vector<int>& assumptions) {
+    std::ofstream out(f);
+    out << "c random test formula\np cnf 100000000 2000000\n";
+    for (int c = 0; c < 2'000'000; c++) {
+        int len = 1 + (int) (Random::rand() * 8);
+        for (int i = 0; i < len; i++) {
+            int lit = (1 + (int) (Random::rand() * 100'000'000)) * (Random::rand() < 0.5 ? -1 : 1);
+            lits.push_back(lit);
+            out << lit << (Random::rand() < 0.01 ? "\n" : " ");
+        }
+        lits.push_back(0);
+        out << "0\n";
+        if (c % 100'000 == 0) out << "c comment\n";
+    }
+    for (int i = 1; i <= 5; i++) assumptions.push_back(-i);
+    out << "a -1 -2 -3 -4 -5 0\n";
+}
+
+void readAndCompare(const std::string& f, int numThreads, const std::vector<int>& lits, const std::vector<int>& assumptions) {
+    float time = Timer::elapsedSeconds();
+    JobDescription d(1, 1, JobDescription::ONESHOT_SAT);
+    SatReader r(f, SatReader::ContentMode::ASCII, numThreads);
+    bool success = r.read(d);
+    time = Timer::elapsedSeconds() - time;
+    LOG(V2_INFO, "Parsed %s with %i threads in %.3fs\n", f.c_str(), numThreads, time);
+    assert(success);
+    assert(d.getNumFormulaLiterals() == lits.size());
+    assert(d.getNumAssumptionLiterals() == assumptions.size());
+    const int* fLits = d.getFormulaPayload(0);
+    for (size_t i = 0; i < lits.size(); i++) assert(fLits[i] == lits[i]);
+    const int* aLits = d.getAssumptionsPayload(0);
+    for (size_t i = 0; i < assumptions.size(); i++) assert(aLits[i] == assumptions[i]);
+}
+
+void testConcurrentParsing() {
+
+    std::string f = "/tmp/mallob_test_sat_reader.cnf";
+    std::vector<int> lits, assumptions;
+    writeRandomCnf(f, lits, assumptions);
+
+    for (int numThreads : {1, 3, 8}) readAndCompare(f, numThreads, lits, assumptions);
+
+    // Incomplete final clause
+    {
+        std::ofstream out(f);
+        out << "p cnf 3 2\n1 2 0\n-1 3\n";
+    }
+    JobDescription d(1, 1, JobDescription::ONESHOT_SAT);
+    assert(!SatReader(f, SatReader::ContentMode::ASCII, 2).read(d));
+    remove(f.c_str());
+}
+
+void testCompressedParsing() {
+
+    std::string f = "/tmp/mallob_test_sat_reader_compressed.cnf";
+    std::vector<int> lits, assumptions;
+    writeRandomCnf(f, lits, assumptions);
+
+    for (std::string cmd : {"gzip -1 -k -f ", "xz -0 -k -f ", "zstd -1 -q -k -f "}) {
+        std::string compressor = cmd.substr(0, cmd.find(' '));
+        if (system(("which " + compressor + " > /dev/null 2>&1").c_str()) != 0) {
+            LOG(V2_INFO, "%s not available, skipping\n", compressor.c_str());
+            continue;
+        }
+        int retval = system((cmd + f).c_str());
+        assert(retval == 0);
+        std::string ending = compressor == "gzip" ? ".gz" : (compressor == "xz" ? ".xz" : ".zst");
+        for (int numThreads : {1, 4}) readAndCompare(f + ending, numThreads, lits, assumptions);
+
+        // Truncated file, in the middle of the data or within its trailer
+        auto truncated = f + ".truncated" + ending;
+        for (std::string truncation : {"1000000", "-20"}) {
+            retval = system(("head -c " + truncation + " " + f + ending + " > " + truncated).c_str());
+            assert(retval == 0);
+            JobDescription d(1, 1, JobDescription::ONESHOT_SAT);
+            assert(!SatReader(truncated, SatReader::ContentMode::ASCII).read(d));
+        }
+        remove(truncated.c_str());
+        remove((f + ending).c_str());
+    }
+    readAndCompare(f, 1, lits, assumptions);
+    remove(f.c_str());
+}
+
 int main() {
 
     Timer::init();
     Random::init(rand(), rand());
     Logger::init(0, V5_DEBG);
 
+    testConcurrentParsing();
+    testCompressedParsing();
+
     auto files = {"Steiner-9-5-bce.cnf.xz", "uum12.smt2.cnf.xz", 
         "LED_round_29-32_faultAt_29_fault_injections_5_seed_1579630418.cnf.xz", "SAT_dat.k80.cnf.xz", "Timetable_C_497_E_62_Cl_33_S_30.cnf.xz", 
         "course0.2_2018_3-sc2018.cnf.xz", "sv-comp19_prop-reachsafety.queue_longer_false-unreach-call.i-witness.cnf.xz"};
@@ -0,0 +1,92 @@
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <csignal>
+
+#include "util/sys/timer.hpp"
+#include "util/logger.hpp"
+#include "util/sys/process.hpp"
+#include "util/sys/shared_memory.hpp"
+#include "util/assert.hpp"
+
+void testSharedSegment() {
+    LOG(V2_INFO, "Testing host-wide shared segments ...\n");
+
+    std::string id = "/mallob_test_shared_segment." + std::to_string(getpid());
+    std::vector<int> data(100'000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = i;
+    size_t size = sizeof(int) * data.size();
+
+    // First acquisition creates the segment, second one maps it
+    int* first = (int*) SharedMemory::acquireShared(id, size, data.data());
+    assert(first != nullptr);
+    std::vector<int> other(data.size(), -1);
+    int* second = (int*) SharedMemory::acquireShared(id, size, other.data());
+    assert(second != nullptr && second != first);
+    for (size_t i = 0; i < data.size(); i++) assert(second[i] == data[i]);
+
+    // Read-only access as performed by a SAT subprocess
+    const int* readOnly = (const int*) SharedMemory::accessShared(id, size);
+    assert(readOnly != nullptr && readOnly[data.size()-1] == data.back());
+
+    // The segment persists until its last user releases it
+    SharedMemory::releaseShared(id, first, size);
+    assert(SharedMemory::canAccess(id));
+    SharedMemory::releaseShared(id, second, size);
+    assert(!SharedMemory::canAccess(id));
+    assert(readOnly[0] == 0);
+
+    // Concurrent acquisitions by several processes
+    std::vector<pid_t> children;
+    for (int c = 0; c < 8; c++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (int rep = 0; rep < 100; rep++) {
+                int* ptr = (int*) SharedMemory::acquireShared(id, size, data.data());
+                if (ptr == nullptr || ptr[12345] != 12345) _exit(1);
+                // While referenced, the segment must remain accessible by name
+                const int* readOnly = (const int*) SharedMemory::accessShared(id, size);
+                if (readOnly == nullptr || readOnly[12345] != 12345) _exit(2);
+                SharedMemory::releaseShared(id, ptr, size);
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    assert(!SharedMemory::canAccess(id));
+
+    // A process dies while filling a segment
+    void* unreadable = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(unreadable != MAP_FAILED);
+    pid_t pid = fork();
+    if (pid == 0) {
+        signal(SIGSEGV, SIG_DFL);
+        SharedMemory::acquireShared(id, size, unreadable);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFSIGNALED(status));
+    assert(SharedMemory::canAccess(id));
+    // The incomplete segment is replaced by a complete one
+    int* replaced = (int*) SharedMemory::acquireShared(id, size, data.data());
+    assert(replaced != nullptr);
+    for (size_t i = 0; i < data.size(); i++) assert(replaced[i] == data[i]);
+    SharedMemory::releaseShared(id, replaced, size);
+    assert(!SharedMemory::canAccess(id));
+    munmap(unreadable, size);
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+    Process::init(0);
+
+    testSharedSegment();
+}
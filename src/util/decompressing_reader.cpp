@@ -0,0 +1,224 @@
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+#ifdef MALLOB_USE_LZMA
+#include <lzma.h>
+#endif
+#ifdef MALLOB_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "decompressing_reader.hpp"
+#include "util/logger.hpp"
+
+namespace {
+    constexpr size_t INPUT_BUFFER_SIZE = 1<<20;
+
+    bool endsWith(const std::string& str, const std::string& suffix) {
+        return str.size() > suffix.size() && str.compare(str.size()-suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+DecompressingReader::Format DecompressingReader::getFormat(const std::string& filename) {
+    if (endsWith(filename, ".xz") || endsWith(filename, ".lzma")) return XZ;
+    if (endsWith(filename, ".gz")) return GZIP;
+    if (endsWith(filename, ".zst")) return ZSTD;
+    return PLAIN;
+}
+
+DecompressingReader::DecompressingReader(const std::string& filename, Format format, int numThreads) : _format(format) {
+
+    switch (_format) {
+    case GZIP: {
+        gzFile gz = gzopen(filename.c_str(), "rb");
+        if (gz == nullptr) {
+            _error = true;
+            break;
+        }
+        gzbuffer(gz, INPUT_BUFFER_SIZE);
+        _gz = gz;
+        break;
+    }
+    case XZ: {
+#ifdef MALLOB_USE_LZMA
+        _fd = open(filename.c_str(), O_RDONLY);
+        if (_fd == -1) {
+            _error = true;
+            break;
+        }
+        lzma_stream* strm = new lzma_stream;
+        *strm = LZMA_STREAM_INIT;
+        _lzma = strm;
+#if LZMA_VERSION >= 50040000
+        // Blocks of multi-block files (xz -T) are decoded in parallel
+        lzma_mt mt;
+        memset(&mt, 0, sizeof(mt));
+        mt.flags = LZMA_CONCATENATED;
+        mt.threads = std::max(1, numThreads);
+        mt.memlimit_threading = UINT64_MAX;
+        mt.memlimit_stop = UINT64_MAX;
+        lzma_ret ret = lzma_stream_decoder_mt(strm, &mt);
+#else
+        lzma_ret ret = lzma_stream_decoder(strm, UINT64_MAX, LZMA_CONCATENATED);
+#endif
+        if (ret != LZMA_OK) {
+            LOG(V1_WARN, "[WARN] Cannot initialize xz decoder (code %i)\n", (int)ret);
+            _error = true;
+        }
+#else
+        openPipe("xz -c -d ", filename);
+#endif
+        break;
+    }
+    case ZSTD: {
+#ifdef MALLOB_USE_ZSTD
+        _fd = open(filename.c_str(), O_RDONLY);
+        if (_fd == -1) {
+            _error = true;
+            break;
+        }
+        ZSTD_DStream* ds = ZSTD_createDStream();
+        _zstd = ds;
+        if (ds == nullptr || ZSTD_isError(ZSTD_initDStream(ds))) _error = true;
+#else
+        openPipe("zstd -c -d ", filename);
+#endif
+        break;
+    }
+    case PLAIN:
+        _fd = open(filename.c_str(), O_RDONLY);
+        if (_fd == -1) _error = true;
+        break;
+    }
+
+    if (_fd != -1) _in_buffer.resize(INPUT_BUFFER_SIZE);
+}
+
+void DecompressingReader::openPipe(const std::string& command, const std::string& filename) {
+    _pipe = popen((command + filename).c_str(), "r");
+    if (_pipe == nullptr) _error = true;
+}
+
+long DecompressingReader::read(char* out, size_t size) {
+    // Fill the output as far as possible
+    size_t numRead = 0;
+    while (numRead < size && !_finished && !_error) {
+        long res = readSome(out+numRead, size-numRead);
+        if (res < 0) _error = true;
+        else if (res == 0) _finished = true;
+        else numRead += res;
+    }
+    return _error ? -1 : numRead;
+}
+
+long DecompressingReader::readSome(char* out, size_t size) {
+
+    if (_pipe != nullptr) {
+        long res = ::read(fileno(_pipe), out, size);
+        if (res == 0) {
+            // End of output: the decompressor must have succeeded
+            int status = pclose(_pipe);
+            _pipe = nullptr;
+            if (status != 0) {
+                LOG(V1_WARN, "[WARN] External decompressor exited with status %i\n", status);
+                return -1;
+            }
+        }
+        return res;
+    }
+
+    switch (_format) {
+    case PLAIN:
+        return ::read(_fd, out, size);
+    case GZIP: {
+        int res = gzread((gzFile) _gz, out, std::min(size, (size_t) (1<<30)));
+        if (res <= 0) {
+            // A truncated input ends without any data but with Z_BUF_ERROR
+            int errnum;
+            const char* msg = gzerror((gzFile) _gz, &errnum);
+            if (res < 0 || errnum != Z_OK) {
+                LOG(V1_WARN, "[WARN] gzip error: %s\n", msg);
+                return -1;
+            }
+        }
+        return res;
+    }
+    case XZ: {
+#ifdef MALLOB_USE_LZMA
+        lzma_stream* strm = (lzma_stream*) _lzma;
+        strm->next_out = (uint8_t*) out;
+        strm->avail_out = size;
+        while (strm->avail_out == size) {
+            if (strm->avail_in == 0 && !_in_exhausted) {
+                if (!refill()) return -1;
+                strm->next_in = _in_buffer.data();
+                strm->avail_in = _in_size;
+            }
+            lzma_ret ret = lzma_code(strm, _in_exhausted ? LZMA_FINISH : LZMA_RUN);
+            if (ret == LZMA_STREAM_END) {
+                _finished = true;
+                break;
+            }
+            if (ret != LZMA_OK) {
+                LOG(V1_WARN, "[WARN] xz decoding error (code %i)\n", (int)ret);
+                return -1;
+            }
+        }
+        return size - strm->avail_out;
+#else
+        return -1;
+#endif
+    }
+    case ZSTD: {
+#ifdef MALLOB_USE_ZSTD
+        ZSTD_outBuffer output {out, size, 0};
+        while (output.pos == 0) {
+            if (_in_pos == _in_size && !_in_exhausted && !refill()) return -1;
+            ZSTD_inBuffer input {_in_buffer.data(), _in_size, _in_pos};
+            size_t ret = ZSTD_decompressStream((ZSTD_DStream*) _zstd, &output, &input);
+            if (ZSTD_isError(ret)) {
+                LOG(V1_WARN, "[WARN] zstd decoding error: %s\n", ZSTD_getErrorName(ret));
+                return -1;
+            }
+            if (input.pos > _in_pos || output.pos > 0) _frame_complete = ret == 0;
+            _in_pos = input.pos;
+            if (output.pos == 0 && _in_pos == _in_size && _in_exhausted) {
+                // End of input: the last frame must be complete
+                return _frame_complete ? 0 : -1;
+            }
+        }
+        return output.pos;
+#else
+        return -1;
+#endif
+    }
+    }
+    return -1;
+}
+
+bool DecompressingReader::refill() {
+    long res = ::read(_fd, _in_buffer.data(), _in_buffer.size());
+    if (res < 0) return false;
+    _in_pos = 0;
+    _in_size = res;
+    if (res == 0) _in_exhausted = true;
+    return true;
+}
+
+DecompressingReader::~DecompressingReader() {
+    if (_gz != nullptr) gzclose((gzFile) _gz);
+#ifdef MALLOB_USE_LZMA
+    if (_lzma != nullptr) {
+        lzma_end((lzma_stream*) _lzma);
+        delete (lzma_stream*) _lzma;
+    }
+#endif
+#ifdef MALLOB_USE_ZSTD
+    if (_zstd != nullptr) ZSTD_freeDStream((ZSTD_DStream*) _zstd);
+#endif
+    if (_pipe != nullptr) pclose(_pipe);
+    if (_fd != -1) close(_fd);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+// Reads a (possibly compressed) file as a stream of decompressed bytes.
+// xz/lzma, gzip and zstd files are decoded in-process if mallob was built
+// with the according library (zlib is always present); otherwise, an
+// external decompressor is invoked and its output is read over a pipe.
+class DecompressingReader {
+
+public:
+    enum Format {PLAIN, XZ, GZIP, ZSTD};
+    static Format getFormat(const std::string& filename);
+
+private:
+    Format _format;
+    int _fd = -1;
+    FILE* _pipe = nullptr; // external decompressor
+    void* _gz = nullptr;   // gzFile
+    void* _lzma = nullptr; // lzma_stream*
+    void* _zstd = nullptr; // ZSTD_DStream*
+
+    std::vector<uint8_t> _in_buffer;
+    size_t _in_pos = 0;
+    size_t _in_size = 0;
+    bool _in_exhausted = false;
+    bool _frame_complete = false;
+
+    bool _error = false;
+    bool _finished = false;
+
+public:
+    DecompressingReader(const std::string& filename, Format format, int numThreads = 1);
+    ~DecompressingReader();
+
+    bool isValid() const {return !_error;}
+
+    // Reads up to size decompressed bytes into out. Returns the number of bytes read,
+    // which is only smaller than size at the end of the input, or -1 upon an error.
+    long read(char* out, size_t size);
+
+private:
+    long readSome(char* out, size_t size);
+    bool refill();
+    void openPipe(const std::string& command, const std::string& filename);
+};
@@ -7,20 +7,50 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <cstring>
+#include <thread>
 
 #include "sat_reader.hpp"
 #include "util/sys/terminator.hpp"
 
+namespace {
+
+	// Minimum number of bytes to be parsed by an individual thread
+	constexpr size_t MIN_CHUNK_SIZE = 1<<22;
+
+	// Returns the number of leading decimal digits among the eight characters 
+	// in the given (little-endian) word, examining all characters at once
+	inline int countLeadingDigits(uint64_t word) {
+		uint64_t hiNibbles = word & 0xF0F0F0F0F0F0F0F0ULL;
+		uint64_t hiNibblesPlus6 = (word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL;
+		uint64_t nonDigits = (hiNibbles ^ 0x3030303030303030ULL) | (hiNibblesPlus6 ^ 0x3030303030303030ULL);
+		return nonDigits == 0 ? 8 : __builtin_ctzll(nonDigits) / 8;
+	}
+
+	// Converts the n (1 <= n <= 8) leading decimal digits of the given word
+	inline uint32_t parseLeadingDigits(uint64_t word, int n) {
+		word -= 0x3030303030303030ULL;
+		word <<= 8 * (8-n);
+		word = word * 10 + (word >> 8);
+		return (((word & 0x000000FF000000FFULL) * 0x000F424000000064ULL)
+			+ (((word >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+	}
+
+	const long POWERS_OF_10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+	// Number of decompressed bytes which are parsed at once
+	constexpr size_t STREAM_BLOCK_SIZE = 1<<25;
+}
+
 bool SatReader::read(JobDescription& desc) {
 
-	FILE* pipe = nullptr;
+	std::unique_ptr<DecompressingReader> compressed;
 	int namedpipe = -1;
-	if ((_filename.size() > 3 && _filename.substr(_filename.size()-3, 3) == ".xz")
-		|| (_filename.size() > 5 && _filename.substr(_filename.size()-5, 5) == ".lzma")) {
-		// Decompress, read output
-		auto command = "xz -c -d " + _filename;
-		pipe = popen(command.c_str(), "r");
-		if (pipe == nullptr) return false;
+	auto format = DecompressingReader::getFormat(_filename);
+	if (format != DecompressingReader::PLAIN) {
+		// Decompress while reading
+		compressed.reset(new DecompressingReader(_filename, format, _num_threads));
+		if (!compressed->isValid()) return false;
 	} else if (_filename.size() > 5 && _filename.substr(_filename.size()-5, 5) == ".pipe") {
 		// Named pipe!
 		namedpipe = open(_filename.c_str(), O_RDONLY);
@@ -28,7 +58,7 @@ bool SatReader::read(JobDescription& desc) {
 	
 	desc.beginInitialization(desc.getRevision());
 	
-	if (pipe == nullptr && namedpipe == -1) {
+	if (!compressed && namedpipe == -1) {
 		// Read file with mmap
 		int fd = open(_filename.c_str(), O_RDONLY);
 		if (fd == -1) return false;
@@ -38,20 +68,14 @@ bool SatReader::read(JobDescription& desc) {
 		int status = stat(_filename.c_str(), &s);
 		if (status == -1) return false;
 		size = s.st_size;
-		desc.reserveSize(size / sizeof(int));
 		void* mmapped = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
 
 		if (_content_mode == RAW) {
-			int* f = (int*) mmapped;
-			for (long i = 0; i < size; i++) {
-				processInt(f[i], desc);
-			}
+			desc.reserveSize(size);
+			_valid_input = readRaw((const int*) mmapped, size / sizeof(int), desc);
 		} else {
-			char* f = (char*) mmapped;
-			for (long i = 0; i < size; i++) {
-				process(f[i], desc);
-			}
-			process(EOF, desc);
+			_valid_input = parseConcurrently((const char*) mmapped, size, desc, /*reserveExactly=*/true)
+				&& finishParsing(desc);
 		}
 		munmap(mmapped, size);
 		close(fd);
@@ -84,37 +108,225 @@ bool SatReader::read(JobDescription& desc) {
 			process(EOF, desc);
 		}
 
+	} else if (_content_mode == RAW) {
+		_valid_input = readRawStream(*compressed, desc);
 	} else {
-		// Read file over pipe
-		if (_content_mode == RAW) {
-			int iteration = 0;
-			int buffer[1024] = {0};
-			while (iteration ^ 511 != 0 || !Terminator::isTerminating()) {
-				int numRead = ::read(fileno(pipe), buffer, sizeof(buffer));
-				if (numRead <= 0) break;
-				for (int i = 0; i < numRead; i++) {
-					int c = buffer[i];
-					processInt(c, desc);
+		_valid_input = parseStream(*compressed, desc);
+	}
+
+	desc.endInitialization();
+
+	if (namedpipe != -1) close(namedpipe);
+
+	return isValidInput();
+}
+
+bool SatReader::read(const int* data, size_t size, JobDescription& desc) {
+	assert(_content_mode == RAW);
+	desc.beginInitialization(desc.getRevision());
+	desc.reserveSize(sizeof(int) * size);
+	_valid_input = readRaw(data, size, desc);
+	desc.endInitialization();
+	return isValidInput();
+}
+
+void SatReader::parseChunk(const char* begin, const char* end, const char* dataEnd, ParsedChunk& out) {
+
+	// Estimate: a literal takes up at least four characters on average
+	out.lits.reserve((end-begin) / 4);
+
+	const char* p = begin;
+	while (p < end) {
+
+		// Skip comment and header lines
+		if (*p == 'c' || *p == 'p') {
+			p = (const char*) memchr(p, '\n', end-p);
+			if (p == nullptr) break;
+			p++;
+			continue;
+		}
+
+		bool assumption = *p == 'a';
+		if (assumption) p++;
+
+		// Read numbers up to the end of the line
+		while (p < end && *p != '\n') {
+			char c = *p;
+			if (c == ' ' || c == '\t' || c == '\r') {
+				p++;
+				continue;
+			}
+			bool negative = c == '-';
+			if (negative) p++;
+
+			long num = 0;
+			int numDigits = 0;
+			while (p < end) {
+				int n = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+				if (dataEnd - p >= 8) {
+					// Examine eight characters at once
+					uint64_t word;
+					memcpy(&word, p, sizeof(uint64_t));
+					n = std::min((long) countLeadingDigits(word), (long) (end-p));
+					if (n > 0) num = num * POWERS_OF_10[n] + parseLeadingDigits(word, n);
+				} else
+#endif
+				{
+					while (p+n < end && p[n] >= '0' && p[n] <= '9') {
+						num = num * 10 + (p[n] - '0');
+						n++;
+					}
 				}
-				iteration++;
+				p += n;
+				numDigits += n;
+				if (n < 8 || numDigits > 10) break;
 			}
-		} else {
-			char buffer[4096] = {'\0'};
-			while (!Terminator::isTerminating() && fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-				size_t pos = 0;
-				while (buffer[pos] != '\0') {
-					int c = buffer[pos++];
-					process(c, desc);
+			if (numDigits == 0 || numDigits > 10 || num > INT32_MAX) {
+				// Not a number
+				out.valid = false;
+				return;
+			}
+
+			int lit = negative ? -num : num;
+			out.maxVar = std::max(out.maxVar, (int) num);
+			if (!assumption) out.lits.push_back(lit);
+			else if (lit != 0) out.assumptions.push_back(lit);
+		}
+		if (p < end) p++; // skip line break
+	}
+}
+
+bool SatReader::parseConcurrently(const char* data, size_t size, JobDescription& desc, bool reserveExactly) {
+
+	if (size == 0) return true;
+	const char* dataEnd = data + size;
+
+	// Split the data into chunks, each ending with a line break
+	size_t numChunks = std::max(1UL, std::min((size_t) _num_threads, size / MIN_CHUNK_SIZE));
+	std::vector<const char*> bounds {data};
+	for (size_t i = 1; i < numChunks; i++) {
+		const char* pos = std::max(bounds.back(), data + i*(size/numChunks));
+		const char* lineBreak = (const char*) memchr(pos, '\n', dataEnd-pos);
+		bounds.push_back(lineBreak == nullptr ? dataEnd : lineBreak+1);
+	}
+	bounds.push_back(dataEnd);
+
+	// Parse chunks concurrently
+	std::vector<ParsedChunk> chunks(numChunks);
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < numChunks; i++) {
+		threads.emplace_back([&, i]() {
+			parseChunk(bounds[i], bounds[i+1], dataEnd, chunks[i]);
+		});
+	}
+	parseChunk(bounds[0], bounds[1], dataEnd, chunks[0]);
+	for (auto& thread : threads) thread.join();
+
+	// Stitch the parsed chunks together
+	size_t numLits = 0, numAssumptions = 0;
+	for (auto& chunk : chunks) {
+		if (!chunk.valid) return false;
+		numLits += chunk.lits.size();
+		numAssumptions += chunk.assumptions.size();
+		if (!chunk.lits.empty()) _last_parsed_lit = chunk.lits.back();
+		_max_var = std::max(_max_var, chunk.maxVar);
+	}
+	if (reserveExactly) desc.reserveSize(sizeof(int) * (numLits + numAssumptions));
+	for (auto& chunk : chunks) {
+		desc.addLiterals(chunk.lits.data(), chunk.lits.size());
+		std::vector<int>().swap(chunk.lits);
+		// Assumptions are appended after the entire formula
+		_parsed_assumptions.insert(_parsed_assumptions.end(), chunk.assumptions.begin(), chunk.assumptions.end());
+	}
+	return true;
+}
+
+bool SatReader::finishParsing(JobDescription& desc) {
+	desc.addAssumptions(_parsed_assumptions.data(), _parsed_assumptions.size());
+	_parsed_assumptions.clear();
+	// The formula must end with a complete clause
+	return _last_parsed_lit == 0;
+}
+
+bool SatReader::parseStream(DecompressingReader& input, JobDescription& desc) {
+
+	// The next block is decompressed while the current one is parsed
+	std::vector<char> blocks[2] {std::vector<char>(STREAM_BLOCK_SIZE), std::vector<char>(STREAM_BLOCK_SIZE)};
+	long blockSizes[2];
+	int current = 0;
+	blockSizes[current] = input.read(blocks[current].data(), STREAM_BLOCK_SIZE);
+	std::string carry; // incomplete line at the end of the previous block
+
+	while (true) {
+		if (blockSizes[current] < 0) return false;
+		const char* data = blocks[current].data();
+		size_t size = blockSizes[current];
+		bool lastBlock = size < STREAM_BLOCK_SIZE;
+
+		int next = 1-current;
+		std::thread decompressor;
+		if (!lastBlock) decompressor = std::thread([&]() {
+			blockSizes[next] = input.read(blocks[next].data(), STREAM_BLOCK_SIZE);
+		});
+
+		// Complete the line carried over from the previous block
+		size_t begin = 0;
+		if (!carry.empty()) {
+			const char* lineBreak = (const char*) memchr(data, '\n', size);
+			begin = lineBreak == nullptr ? size : lineBreak+1 - data;
+			carry.append(data, begin);
+			if (lineBreak != nullptr || lastBlock) {
+				if (!parseConcurrently(carry.data(), carry.size(), desc, false)) {
+					if (decompressor.joinable()) decompressor.join();
+					return false;
 				}
+				carry.clear();
 			}
-			process(EOF, desc);
 		}
+		// Parse all complete lines, keep the rest for the next block
+		size_t end = size;
+		if (!lastBlock) {
+			const char* lastLineBreak = (const char*) memrchr(data+begin, '\n', size-begin);
+			end = lastLineBreak == nullptr ? begin : lastLineBreak+1 - data;
+		}
+		bool valid = parseConcurrently(data+begin, end-begin, desc, false);
+		carry.append(data+end, size-end);
+
+		if (decompressor.joinable()) decompressor.join();
+		if (!valid || Terminator::isTerminating()) return false;
+		if (lastBlock) break;
+		current = next;
 	}
+	if (!carry.empty() && !parseConcurrently(carry.data(), carry.size(), desc, false)) return false;
+	return finishParsing(desc);
+}
 
-	desc.endInitialization();
+bool SatReader::readRaw(const int* data, size_t size, JobDescription& desc) {
 
-	if (pipe != nullptr) pclose(pipe);
-	if (namedpipe != -1) close(namedpipe);
+	// Find the "empty clause" which separates clauses from assumptions
+	size_t sep = 0;
+	while (sep < size && !(data[sep] == 0 && (sep == 0 || data[sep-1] == 0))) sep++;
+	if (sep == size) return false;
+	// Assumptions are terminated by a single zero at the very end
+	if (sep+2 > size || data[size-1] != 0) return false;
+	const int* assumptions = data+sep+1;
+	size_t numAssumptions = size-sep-2;
+	for (size_t i = 0; i < numAssumptions; i++) if (assumptions[i] == 0) return false;
+
+	for (size_t i = 0; i < size; i++) _max_var = std::max(_max_var, std::abs(data[i]));
+	desc.addLiterals(data, sep);
+	desc.addAssumptions(assumptions, numAssumptions);
+	return true;
+}
 
+bool SatReader::readRawStream(DecompressingReader& input, JobDescription& desc) {
+	std::vector<int> buffer(1<<20);
+	while (true) {
+		long numBytes = input.read((char*) buffer.data(), buffer.size()*sizeof(int));
+		if (numBytes < 0 || numBytes % sizeof(int) != 0) return false;
+		for (size_t i = 0; i < numBytes/sizeof(int); i++) processInt(buffer[i], desc);
+		if (numBytes < buffer.size()*sizeof(int) || Terminator::isTerminating()) break;
+	}
 	return isValidInput();
 }
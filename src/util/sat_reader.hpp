@@ -9,6 +9,7 @@
 #include "util/assert.hpp"
 
 #include "data/job_description.hpp"
+#include "util/decompressing_reader.hpp"
 
 #include <iostream>
 
@@ -20,6 +21,7 @@ public:
 private:
     std::string _filename;
     ContentMode _content_mode;
+    int _num_threads;
 
     // Content mode: ASCII
     int _sign = 1;
@@ -37,10 +39,13 @@ private:
     bool _valid_input = false;
 
 public:
-    SatReader(const std::string& filename, ContentMode contentMode) : _filename(filename), _content_mode(contentMode) {
+    SatReader(const std::string& filename, ContentMode contentMode, int numThreads = 1) : 
+            _filename(filename), _content_mode(contentMode), _num_threads(std::max(1, numThreads)) {
         _valid_input = _content_mode == ASCII;
     }
     bool read(JobDescription& desc);
+    // Reads a formula in RAW format which already resides in memory
+    bool read(const int* data, size_t size, JobDescription& desc);
 
     inline void processInt(int x, JobDescription& desc) {
         
@@ -126,6 +131,24 @@ public:
     bool isValidInput() const {
         return _valid_input;
     }
+
+private:
+    // Parsing of an entire (mmapped) ASCII file in chunks which are split at line 
+    // boundaries and parsed concurrently, then appended to the description as blocks
+    struct ParsedChunk {
+        std::vector<int> lits;
+        std::vector<int> assumptions;
+        int maxVar = 0;
+        bool valid = true;
+    };
+    std::vector<int> _parsed_assumptions;
+    int _last_parsed_lit = 0;
+    bool parseConcurrently(const char* data, size_t size, JobDescription& desc, bool reserveExactly);
+    bool finishParsing(JobDescription& desc);
+    bool parseStream(DecompressingReader& input, JobDescription& desc);
+    bool readRaw(const int* data, size_t size, JobDescription& desc);
+    bool readRawStream(DecompressingReader& input, JobDescription& desc);
+    static void parseChunk(const char* begin, const char* end, const char* dataEnd, ParsedChunk& out);
 };
 
 #endif
\ No newline at end of file
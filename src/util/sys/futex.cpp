@@ -0,0 +1,29 @@
+
+#include "futex.hpp"
+
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// The futex word is accessed by the kernel as a plain 32-bit integer
+static_assert(sizeof(std::atomic_uint32_t) == sizeof(uint32_t));
+static_assert(std::atomic_uint32_t::is_always_lock_free);
+
+void Futex::wait(uint32_t epoch, int timeoutMicros) {
+    if (getEpoch() != epoch) return;
+    timespec timeout;
+    timeout.tv_sec = timeoutMicros / 1'000'000;
+    timeout.tv_nsec = (timeoutMicros % 1'000'000) * 1000;
+    _nb_waiters.fetch_add(1, std::memory_order_seq_cst);
+    // No FUTEX_PRIVATE_FLAG: the word may be shared with other processes
+    syscall(SYS_futex, (uint32_t*) &_epoch, FUTEX_WAIT, epoch, &timeout, nullptr, 0);
+    _nb_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Futex::notify() {
+    _epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (_nb_waiters.load(std::memory_order_seq_cst) == 0) return;
+    syscall(SYS_futex, (uint32_t*) &_epoch, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Wake-up signal based on a futex word, usable across processes if the
+// instance resides in shared memory. A waiting party first reads the current
+// epoch, then checks its wake-up condition, and finally waits for the epoch
+// to change. A notifying party first changes the condition and then calls
+// notify(), which increments the epoch. Hence no notification can get lost.
+class Futex {
+
+private:
+    std::atomic_uint32_t _epoch {0};
+    std::atomic_uint32_t _nb_waiters {0};
+
+public:
+    uint32_t getEpoch() const {
+        return _epoch.load(std::memory_order_acquire);
+    }
+
+    // Blocks until the epoch differs from the provided one, until the timeout 
+    // (in microseconds) has passed, or until the thread received a signal.
+    void wait(uint32_t epoch, int timeoutMicros);
+
+    // Increments the epoch and wakes up all waiting parties.
+    void notify();
+};
@@ -3,9 +3,16 @@
 
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/file.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
 #include "util/assert.hpp"
+#include "util/sys/timer.hpp"
 
 namespace SharedMemory {
 
@@ -57,4 +64,140 @@ namespace SharedMemory {
         munmap(addr, size);
         shm_unlink(specifier.c_str());
     }
+
+    struct SharedSegmentHeader {
+        // Number of processes holding the segment. Once it dropped to zero,
+        // the segment is dead and will never be handed out again.
+        std::atomic_int nbReferences;
+        std::atomic_bool ready;
+        // Process which fills the segment, zero until it is known
+        std::atomic_int creatorPid;
+        ino_t inode;
+    };
+    // Keeps the payload aligned
+    constexpr size_t SHARED_SEGMENT_HEADER_SIZE = 64;
+    static_assert(sizeof(SharedSegmentHeader) <= SHARED_SEGMENT_HEADER_SIZE);
+
+    // Removes the name of a dead segment unless the name already refers to
+    // another segment. Names are only removed while holding an exclusive lock
+    // on the segment they refer to, so the name cannot change during the check.
+    static void unlinkDeadSegment(const std::string& specifier, ino_t inode) {
+        int memFd = shm_open(specifier.c_str(), O_RDONLY, 0);
+        if (memFd == -1) return; // already removed
+        flock(memFd, LOCK_EX);
+        struct stat st;
+        std::string shmemFile = "/dev/shm/" + specifier;
+        if (stat(shmemFile.c_str(), &st) == 0 && st.st_ino == inode) {
+            shm_unlink(specifier.c_str());
+        }
+        flock(memFd, LOCK_UN);
+        close(memFd);
+    }
+
+    // Maximum time to wait for another process to fill a segment
+    // before falling back to no shared segment at all
+    constexpr float MAX_SEGMENT_WAIT_SECONDS = 10;
+
+    static bool hasProcessDied(pid_t pid) {
+        return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+    }
+
+    void* acquireShared(const std::string& specifier, size_t size, const void* data) {
+
+        const size_t totalSize = SHARED_SEGMENT_HEADER_SIZE + size;
+        const float startTime = Timer::elapsedSeconds();
+        for (int attempt = 0; attempt < 10000; attempt++) {
+
+            int memFd = shm_open(specifier.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRWXU);
+            if (memFd != -1) {
+                // Segment did not exist: create and fill it
+                struct stat st;
+                int res = fstat(memFd, &st);
+                if (res != -1) res = ftruncate(memFd, totalSize);
+                void* buffer = res == -1 ? MAP_FAILED : 
+                    mmap(NULL, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+                close(memFd);
+                if (buffer == MAP_FAILED) {
+                    shm_unlink(specifier.c_str());
+                    return nullptr;
+                }
+                auto header = new (buffer) SharedSegmentHeader();
+                header->inode = st.st_ino;
+                header->nbReferences.store(1, std::memory_order_relaxed);
+                header->creatorPid.store(getpid(), std::memory_order_release);
+                char* payload = ((char*) buffer) + SHARED_SEGMENT_HEADER_SIZE;
+                if (size > 0) memcpy(payload, data, size);
+                header->ready.store(true, std::memory_order_release);
+                return payload;
+            }
+            if (errno != EEXIST) return nullptr;
+
+            // Segment exists: map it as soon as its creator resized it
+            memFd = shm_open(specifier.c_str(), O_RDWR, 0);
+            if (memFd == -1) continue; // removed in the meantime
+            struct stat st;
+            if (fstat(memFd, &st) == -1 || st.st_size < (off_t) totalSize) {
+                close(memFd);
+                usleep(100);
+                continue;
+            }
+            void* buffer = mmap(NULL, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+            close(memFd);
+            if (buffer == MAP_FAILED) return nullptr;
+
+            // Wait until the payload is complete, then register as a user
+            // unless the segment is already dead
+            auto header = (SharedSegmentHeader*) buffer;
+            bool creatorDied = false;
+            while (!header->ready.load(std::memory_order_acquire)) {
+                if (hasProcessDied(header->creatorPid.load(std::memory_order_acquire))) {
+                    // The segment will never be completed: release the creator's
+                    // reference on its behalf such that the segment is dead
+                    int nbRefs = 1;
+                    header->nbReferences.compare_exchange_strong(nbRefs, 0, std::memory_order_acq_rel);
+                    creatorDied = true;
+                    break;
+                }
+                if (Timer::elapsedSeconds() - startTime > MAX_SEGMENT_WAIT_SECONDS) {
+                    munmap(buffer, totalSize);
+                    return nullptr;
+                }
+                usleep(100);
+            }
+            int nbRefs = creatorDied ? 0 : header->nbReferences.load(std::memory_order_acquire);
+            while (nbRefs > 0 && !header->nbReferences.compare_exchange_weak(nbRefs, nbRefs+1, 
+                std::memory_order_acq_rel, std::memory_order_acquire)) {}
+            if (nbRefs == 0) {
+                // Dead segment: make sure its name is removed, then try again
+                unlinkDeadSegment(specifier, header->inode);
+                munmap(buffer, totalSize);
+                continue;
+            }
+            return ((char*) buffer) + SHARED_SEGMENT_HEADER_SIZE;
+        }
+        return nullptr;
+    }
+
+    void releaseShared(const std::string& specifier, void* payload, size_t size) {
+        char* buffer = ((char*) payload) - SHARED_SEGMENT_HEADER_SIZE;
+        auto header = (SharedSegmentHeader*) buffer;
+        if (header->nbReferences.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            unlinkDeadSegment(specifier, header->inode);
+        }
+        munmap(buffer, SHARED_SEGMENT_HEADER_SIZE + size);
+    }
+
+    const void* accessShared(const std::string& specifier, size_t size) {
+        int memFd = shm_open(specifier.c_str(), O_RDONLY, 0);
+        if (memFd == -1) return nullptr;
+        void* buffer = mmap(NULL, SHARED_SEGMENT_HEADER_SIZE + size, PROT_READ, MAP_SHARED, memFd, 0);
+        close(memFd);
+        if (buffer == MAP_FAILED) return nullptr;
+        // Incomplete segments are not handed out
+        if (!((SharedSegmentHeader*) buffer)->ready.load(std::memory_order_acquire)) {
+            munmap(buffer, SHARED_SEGMENT_HEADER_SIZE + size);
+            return nullptr;
+        }
+        return ((char*) buffer) + SHARED_SEGMENT_HEADER_SIZE;
+    }
 }
\ No newline at end of file
@@ -14,6 +14,16 @@ namespace SharedMemory {
     bool canAccess(const std::string& specifier);
     void* access(const std::string& specifier, size_t size);
     void free(const std::string& specifier, char* addr, size_t size);
+
+    // Read-only payloads shared by several processes of a host: The first process
+    // to acquire a segment creates it and copies the data, all later ones map the
+    // existing segment. The segment is removed when the last process releases it.
+    // If the creator dies before the segment is complete, the segment is replaced.
+    // Returns a pointer to the payload or nullptr if the segment is unavailable.
+    void* acquireShared(const std::string& specifier, size_t size, const void* data);
+    void releaseShared(const std::string& specifier, void* payload, size_t size);
+    // Maps an existing, complete shared segment read-only without holding a reference.
+    const void* accessShared(const std::string& specifier, size_t size);
 }
 
 #endif
\ No newline at end of file
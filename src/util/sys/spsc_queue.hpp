@@ -0,0 +1,56 @@
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Unbounded lock-free queue for exactly one producing and one consuming thread.
+// The elements reside in a linked list of nodes. The first node belongs to the
+// consumer and holds no (more) element; popping an element turns its node into
+// the new first node.
+template <typename T>
+class SPSCQueue {
+
+private:
+    struct Node {
+        T element;
+        std::atomic<Node*> next {nullptr};
+    };
+    Node* _head; // consumer side
+    Node* _tail; // producer side
+
+public:
+    SPSCQueue() {
+        _head = _tail = new Node();
+    }
+    ~SPSCQueue() {
+        while (_head != nullptr) {
+            Node* next = _head->next.load(std::memory_order_relaxed);
+            delete _head;
+            _head = next;
+        }
+    }
+
+    // Producer only.
+    void push(T&& element) {
+        Node* node = new Node();
+        node->element = std::move(element);
+        _tail->next.store(node, std::memory_order_release);
+        _tail = node;
+    }
+
+    // Consumer only.
+    bool empty() const {
+        return _head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool pop(T& element) {
+        Node* next = _head->next.load(std::memory_order_acquire);
+        if (next == nullptr) return false;
+        element = std::move(next->element);
+        delete _head;
+        _head = next;
+        return true;
+    }
+};
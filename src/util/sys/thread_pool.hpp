@@ -50,6 +50,8 @@ public:
         return future;
     }
 
+    size_t getNumThreads() const {return _threads.size();}
+
 private:
     void runThread(int id) {
         std::string threadName = "ThreadPool#" + std::to_string(id);
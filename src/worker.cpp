@@ -111,6 +111,8 @@ void Worker::init() {
         [&](auto& h) {handleSendApplicationMessage(h);});
     q.registerCallback(MSG_SEND_JOB_DESCRIPTION, 
         [&](auto& h) {handleSendJobDescription(h);});
+    if (_params.streamJobDescriptions()) q.registerFragmentCallback(MSG_SEND_JOB_DESCRIPTION,
+        [&](auto& frag) {return handleSendJobDescriptionFragment(frag);});
     q.registerCallback(MSG_NOTIFY_ASSIGNMENT_UPDATE, 
         [&](auto& h) {_coll_assign.handle(h);});
     q.registerCallback(MSG_SCHED_RELEASE_FROM_WAITING, 
@@ -548,9 +550,16 @@ void Worker::sendRevisionDescription(int jobId, int revision, int dest) {
     // Retrieve and send concerned job description
     auto& job = _job_db.get(jobId);
     const auto& descPtr = job.getSerializedDescription(revision);
-    assert(descPtr->size() == job.getDescription().getTransferSize(revision) 
-        || LOG_RETURN_FALSE("%i != %i\n", descPtr->size(), job.getDescription().getTransferSize(revision)));
-    int sendId = MyMpi::isend(dest, MSG_SEND_JOB_DESCRIPTION, descPtr);
+    int sendId;
+    if (job.isReceivingDescription()) {
+        // Pipelined broadcast: forward each fragment as soon as it arrived here
+        sendId = MyMpi::getMessageQueue().sendGrowing(descPtr, 
+            job.getDescription().getFullTransferSize(revision), dest, MSG_SEND_JOB_DESCRIPTION);
+    } else {
+        assert(descPtr->size() == job.getDescription().getFullTransferSize(revision) 
+            || LOG_RETURN_FALSE("%i != %i\n", descPtr->size(), job.getDescription().getFullTransferSize(revision)));
+        sendId = MyMpi::isend(dest, MSG_SEND_JOB_DESCRIPTION, descPtr);
+    }
     LOG_ADD_DEST(V4_VVER, "Sent job desc. of %s rev. %i, size %lu, id=%i", dest, 
             job.toStr(), revision, descPtr->size(), sendId);
     job.getJobTree().addSendHandle(dest, sendId);
@@ -902,6 +911,85 @@ void Worker::handleSendJobDescription(MessageHandle& handle) {
     }
 }
 
+bool Worker::handleSendJobDescriptionFragment(const MessageQueue::Fragment& frag) {
+    auto key = std::pair<int, int>(frag.source, frag.id);
+    auto it = _description_streams.find(key);
+
+    if (it == _description_streams.end()) {
+        // First fragment of a large description: Only take it over if it 
+        // is the initial revision of a committed one-shot SAT job which 
+        // can be started right away, with no checksums or assumptions
+        if (frag.cancelled || frag.index != 0) return false;
+        if (_params.applicationSpawnMode() != "fork" || _params.useChecksums()) return false;
+        size_t metadataSize = JobDescription::readMetadataSize(frag.data, frag.size);
+        if (metadataSize == 0) return false;
+        int jobId = JobDescription::readJobId(frag.data);
+        size_t fSize = JobDescription::readFormulaSize(frag.data);
+        if (JobDescription::readRevisionIndex(frag.data) != 0 
+            || JobDescription::readAssumptionsSize(frag.data) != 0) return false;
+        if (!_job_db.has(jobId) || !_job_db.hasCommitment(jobId)) return false;
+        auto& job = _job_db.get(jobId);
+        if (job.hasDescription() || job.getApplication() != JobDescription::ONESHOT_SAT) return false;
+
+        // Reserve the full description such that its payload never moves
+        auto dataPtr = std::shared_ptr<std::vector<uint8_t>>(new std::vector<uint8_t>());
+        dataPtr->reserve(metadataSize + sizeof(int)*fSize);
+        if (frag.size > dataPtr->capacity()) return false;
+        dataPtr->insert(dataPtr->end(), frag.data, frag.data+frag.size);
+        if (!_job_db.appendRevision(jobId, dataPtr, frag.source)) return false;
+
+        auto numReceivedLits = std::shared_ptr<FormulaProgress>(new FormulaProgress(
+            std::min(fSize, (dataPtr->size()-metadataSize) / sizeof(int))
+        ));
+        job.setIncomingFormula(numReceivedLits);
+        _description_streams[key] = DescriptionStream{jobId, metadataSize, fSize, dataPtr, numReceivedLits};
+        LOG_ADD_SRC(V4_VVER, "Stream desc. of size %lu for #%i (%i fragments)", frag.source, 
+            metadataSize + sizeof(int)*fSize, jobId, frag.total);
+
+        // Execute the job right away
+        {
+            const auto& req = _job_db.getCommitment(jobId);
+            job.setDesiredRevision(req.revision);
+            _job_db.uncommit(jobId);
+        }
+        _job_db.execute(jobId, frag.source);
+        initiateVolumeUpdate(jobId);
+        return true;
+    }
+
+    auto& stream = it->second;
+    bool jobPresent = _job_db.has(stream.jobId) 
+        && _job_db.get(stream.jobId).getIncomingFormula() == stream.numReceivedLits;
+
+    if (frag.cancelled) {
+        // The job cannot be completed locally
+        LOG_ADD_SRC(V1_WARN, "[WARN] Streamed desc. of #%i cancelled", frag.source, stream.jobId);
+        // Cancel forwarding the description to children
+        for (auto& [sendId, jobId] : _send_id_to_job_id) 
+            if (jobId == stream.jobId) MyMpi::getMessageQueue().cancelSend(sendId);
+        if (jobPresent) {
+            _job_db.get(stream.jobId).setIncomingFormula({});
+            interruptJob(stream.jobId, /*terminate=*/true, /*reckless=*/false);
+        }
+        _description_streams.erase(it);
+        return true;
+    }
+
+    assert(stream.data->size() + frag.size <= stream.data->capacity());
+    stream.data->insert(stream.data->end(), frag.data, frag.data+frag.size);
+    stream.numReceivedLits->set(std::min(stream.numLits, 
+        (stream.data->size()-stream.metadataSize) / sizeof(int)));
+
+    if (frag.index+1 == frag.total) {
+        // Description complete
+        LOG_ADD_SRC(V4_VVER, "Streamed desc. of size %lu for #%i complete", frag.source, 
+            stream.data->size(), stream.jobId);
+        if (jobPresent) _job_db.get(stream.jobId).setIncomingFormula({});
+        _description_streams.erase(it);
+    }
+    return true;
+}
+
 void Worker::handleNotifyJobTerminating(MessageHandle& handle) {
     interruptJob(Serializable::get<int>(handle.getRecvData()), /*terminate=*/true, /*reckless=*/false);
 }
@@ -1374,7 +1462,7 @@ Worker::~Worker() {
 
     if (_params.monoFilename.isSet() && _params.applicationSpawnMode() != "fork") {
         // Terminate directly without destructing resident job
-        MPI_Finalize();
+        MyMpi::finalize();
         Process::doExit(0);
     }
 }
\ No newline at end of file
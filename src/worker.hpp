@@ -58,6 +58,17 @@ private:
 
     robin_hood::unordered_map<int, int> _send_id_to_job_id;
 
+    // Job descriptions which are being received fragment by fragment
+    // while the job is already running, by (source rank, message ID)
+    struct DescriptionStream {
+        int jobId;
+        size_t metadataSize;
+        size_t numLits;
+        std::shared_ptr<std::vector<uint8_t>> data;
+        std::shared_ptr<FormulaProgress> numReceivedLits;
+    };
+    robin_hood::unordered_map<std::pair<int, int>, DescriptionStream, IntPairHasher> _description_streams;
+
     HostComm* _host_comm;
 
 public:
@@ -73,6 +84,7 @@ private:
     void handleAnswerAdoptionOffer(MessageHandle& handle);
     void handleQueryJobDescription(MessageHandle& handle);
     void handleSendJobDescription(MessageHandle& handle);
+    bool handleSendJobDescriptionFragment(const MessageQueue::Fragment& frag);
 
     void handleNotifyJobAborting(MessageHandle& handle);
     void handleDoExit(MessageHandle& handle);